@@ -1,23 +1,652 @@
 #include "BacktestingEngine.h"
+#include "BarSource.h"
+#include "Profiler.h"
+#include "RingBuffer.h"
+#include "TimeUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
 
 // ---------------------  Backtesting Engine Methods  -------------------------------------------
 
+void BacktestingEngine::setCheckpointing(const std::string& path, size_t intervalBars) {
+    if (intervalBars > 0 && path.empty()) throw std::invalid_argument("Checkpoint path cannot be empty.");
+    checkpointPath = path;
+    checkpointInterval = intervalBars;
+}
+
+void BacktestingEngine::resume(const Checkpoint& checkpoint, Strategy& strategy, Portfolio& portfolio) {
+    checkpoint.restore(strategy, portfolio);
+    resumeBars = checkpoint.getBarsProcessed();
+    resumeTimestamp = checkpoint.getLastTimestamp();
+}
+
+void BacktestingEngine::resume(const std::string& checkpointPath, Strategy& strategy, Portfolio& portfolio) {
+    resume(Checkpoint::load(checkpointPath), strategy, portfolio);
+}
+
+void BacktestingEngine::beginRun() {
+    barsProcessed = 0;
+    skipRemaining = resumeBars;
+    resumeBars = 0;
+}
+
+size_t BacktestingEngine::skipResumed(const int64_t* timestamps, size_t count) {
+    if (skipRemaining == 0 || count == 0) return 0;
+    const size_t skip = static_cast<size_t>(std::min<uint64_t>(skipRemaining, count));
+    skipRemaining -= skip;
+    barsProcessed += skip;
+    if (skipRemaining == 0 && timestamps[skip - 1] != resumeTimestamp) {
+        throw std::runtime_error("Checkpoint does not match the data: bar " + std::to_string(barsProcessed)
+            + " is at " + std::to_string(timestamps[skip - 1]) + ", expected " + std::to_string(resumeTimestamp));
+    }
+    return skip;
+}
+
+void BacktestingEngine::endRun() {
+    if (skipRemaining > 0) {
+        skipRemaining = 0;
+        throw std::runtime_error("Checkpoint is beyond the end of the data.");
+    }
+}
+
 void BacktestingEngine::runBacktest(DataModule& dataModule, Strategy& strategy, Portfolio& portfolio) {
+    runBacktest(dataModule.adjusted(), strategy, portfolio);
+}
+
+void BacktestingEngine::runBacktest(const BarView& bars, Strategy& strategy, Portfolio& portfolio) {
+    runBacktest(std::vector<BarView>{ bars }, strategy, portfolio);
+}
+
+void BacktestingEngine::runBacktest(const std::vector<BarView>& segments, Strategy& strategy, Portfolio& portfolio) {
     // Notify the strategy of the start of the backtest
-    std::cout << "Backtesting started..." << std::endl;
+    if (log) *log << "Backtesting started..." << std::endl;
     strategy.onStart();
 
+    reserveHistory(segments, portfolio);
+
+    // Reused text buffer for the timestamp handed to the strategy
+    std::string timestamp(19, ' ');
+
     // Iterate over each data point in the time series
-    for (const auto& [timestamp, timeSeriesData] : dataModule.getTimeSeriesData()) {
-        // Pass the TimeSeriesData object directly to the strategy
-        strategy.onData(timestamp, timeSeriesData);
+    beginRun();
+    for (size_t s = 0; s < segments.size(); ++s) {
+        const BarView& bars = segments[s];
+        const size_t count = bars.size();
+        if (count == 0) continue;
+
+        // The session of a segment's last bar closes unless the next segment continues the same day
+        size_t next = s + 1;
+        while (next < segments.size() && segments[next].empty()) ++next;
+        const bool continues = next < segments.size() && isSameSession(bars.timestamps[count - 1], segments[next].timestamps[0]);
+
+        for (size_t i = skipResumed(bars.timestamps, count); i < count; ++i) {
+            bool sessionClose = i + 1 == count ? !continues : !isSameSession(bars.timestamps[i], bars.timestamps[i + 1]);
+            processBar(strategy, portfolio, timestamp, bars.timestamps[i], bars.at(i), sessionClose);
+            afterBar(strategy, portfolio, bars.timestamps[i]);
+        }
+    }
+    endRun();
+    portfolio.closeHistory();
+
+    // Notify the strategy of the end of the backtest
+    strategy.onEnd();
+    if (log) *log << "Backtesting completed successfully." << std::endl;
+}
+
+void BacktestingEngine::runBacktest(BarSource& source, Strategy& strategy, Portfolio& portfolio) {
+    // Notify the strategy of the start of the backtest
+    if (log) *log << "Backtesting started..." << std::endl;
+    strategy.onStart();
+
+    // Session counts are unknown while streaming; size for the bar count when the source knows it
+    if (source.sizeHint() > 0 && portfolio.getEquitySampling() != EquitySampling::SessionClose) {
+        portfolio.reserveHistory(source.sizeHint(), 0);
+    }
 
-        // Convert TimeSeriesData to market data and update the portfolio's net worth
-        portfolio.updateNetWorth(timeSeriesData.toMarketData());
+    // The next chunk is requested before the current one is processed, so the
+    // session close of a chunk's last bar can look at the following bar and a
+    // read-ahead source can start on the chunk after that in the meantime.
+    std::string timestamp(19, ' ');
+    BarColumns current, upcoming;
+    beginRun();
+    bool hasCurrent = source.nextChunk(current);
+    while (hasCurrent) {
+        const bool hasUpcoming = source.nextChunk(upcoming);
+        const size_t barCount = current.size();
+        for (size_t i = skipResumed(current.timestamps.data(), barCount); i < barCount; ++i) {
+            bool sessionClose;
+            if (i + 1 < barCount) sessionClose = !isSameSession(current.timestamps[i], current.timestamps[i + 1]);
+            else sessionClose = !hasUpcoming || !isSameSession(current.timestamps[i], upcoming.timestamps.front());
+            processBar(strategy, portfolio, timestamp, current.timestamps[i], current.at(i), sessionClose);
+            afterBar(strategy, portfolio, current.timestamps[i]);
+        }
+        std::swap(current, upcoming);
+        hasCurrent = hasUpcoming;
     }
+    endRun();
+    portfolio.closeHistory();
 
     // Notify the strategy of the end of the backtest
     strategy.onEnd();
-    std::cout << "Backtesting completed successfully." << std::endl;
+    if (log) *log << "Backtesting completed successfully." << std::endl;
+}
+
+void BacktestingEngine::runBacktest(const TickBars& bars, Strategy& strategy, Portfolio& portfolio) {
+    TickBarSource source(bars);
+    runBacktest(source, strategy, portfolio);
+}
+
+void BacktestingEngine::reserveHistory(const std::vector<BarView>& segments, Portfolio& portfolio) {
+    size_t barCount = 0;
+    size_t sessions = 0;
+    int64_t previous = 0;
+    for (const BarView& bars : segments) {
+        barCount += bars.size();
+        if (portfolio.getEquitySampling() != EquitySampling::SessionClose) continue;
+        for (size_t i = 0; i < bars.size(); ++i) {
+            if (sessions == 0 || !isSameSession(previous, bars.timestamps[i])) ++sessions;
+            previous = bars.timestamps[i];
+        }
+    }
+    portfolio.reserveHistory(barCount, sessions);
+}
+
+// Run the strategy and portfolio update for one bar
+void BacktestingEngine::processBar(Strategy& strategy, Portfolio& portfolio, std::string& timestamp,
+                                   int64_t epochSeconds, const TimeSeriesData& timeSeriesData, bool sessionClose) const {
+    BT_COUNT(BarsProcessed, 1);
+    TimeUtils::formatTimestamp(epochSeconds, timestamp.data());
+    portfolio.setTime(epochSeconds);
+
+    // Pass the TimeSeriesData object directly to the strategy
+    {
+        BT_PROFILE_SCOPE(OnData);
+        strategy.onData(timestamp, timeSeriesData);
+    }
+
+    // Mark the position in this bar's symbol at the close and update the portfolio's net worth
+    {
+        BT_PROFILE_SCOPE(UpdateNetWorth);
+        portfolio.updateNetWorth(symbol, timeSeriesData.close, sessionClose);
+    }
+}
+
+// Bars on the same calendar date belong to the same session
+bool BacktestingEngine::isSameSession(int64_t a, int64_t b) {
+    return TimeUtils::dayOf(a) == TimeUtils::dayOf(b);
+}
+
+// ---------------------  Prefix-Sharing Sweeps  -------------------------------------------
+
+namespace {
+
+// A portfolio and the variants currently trading it
+constexpr size_t NoParent = static_cast<size_t>(-1);
+
+struct SweepNode {
+    std::unique_ptr<RiskEngine> risk;
+    std::unique_ptr<Portfolio> portfolio;
+    std::vector<size_t> members;
+    OrderIntent order;                  // The members' order for the current bar
+    size_t parent = NoParent;           // Node this one was forked off, whose history it continues
+    Portfolio::HistoryMark forkedAt;    // Length of the parent's history at the fork
+};
+
+// New node in the state of a Portfolio::saveState snapshot (or a saveBook
+// one, without `history`), with its own copy of `risk`, logging to `log`
+SweepNode restoreNode(const std::vector<char>& state, bool history, const RiskEngine* risk, std::ostream* log) {
+    SweepNode node;
+    node.portfolio = std::make_unique<Portfolio>();
+    node.portfolio->setLog(log);
+    if (risk) {
+        node.risk = std::make_unique<RiskEngine>(*risk);
+        node.portfolio->setRiskEngine(node.risk.get());
+    }
+    SnapshotReader in(state);
+    if (history) node.portfolio->loadState(in);
+    else node.portfolio->loadBook(in);
+    return node;
+}
+
+// Rebuild `strategy` from `factory` trading `portfolio`, keeping its state
+std::unique_ptr<Strategy> moveStrategy(const Strategy& strategy, const StrategyFactory& factory, Portfolio& portfolio) {
+    SnapshotWriter out;
+    strategy.saveState(out);
+    std::unique_ptr<Strategy> moved = factory(portfolio);
+    moved->setLog(strategy.getLog());
+    SnapshotReader in(out.bytes());
+    moved->loadState(in);
+    return moved;
+}
+
+} // namespace
+
+std::vector<SweepRun> BacktestingEngine::runSweep(DataModule& dataModule, const Portfolio& prototype,
+                                                  const std::vector<StrategyFactory>& variants) {
+    return runSweep(dataModule.adjusted(), prototype, variants);
+}
+
+std::vector<SweepRun> BacktestingEngine::runSweep(const BarView& bars, const Portfolio& prototype,
+                                                  const std::vector<StrategyFactory>& variants) {
+    return runSweep(std::vector<BarView>{ bars }, prototype, variants);
+}
+
+std::vector<SweepRun> BacktestingEngine::runSweep(const std::vector<BarView>& segments, const Portfolio& prototype,
+                                                  const std::vector<StrategyFactory>& variants) {
+    std::vector<SweepRun> runs(variants.size());
+    if (variants.empty()) return runs;
+
+    size_t barCount = 0;
+    size_t sessions = 0;
+    int64_t previous = 0;
+    for (const BarView& bars : segments) {
+        barCount += bars.size();
+        for (size_t i = 0; i < bars.size(); ++i) {
+            if (sessions == 0 || !isSameSession(previous, bars.timestamps[i])) ++sessions;
+            previous = bars.timestamps[i];
+        }
+    }
+
+    SnapshotWriter initial;
+    prototype.saveState(initial);
+    std::vector<SweepNode> nodes;
+    nodes.push_back(restoreNode(initial.bytes(), true, prototype.getRiskEngine(), prototype.getLog()));
+    nodes.front().portfolio->reserveHistory(barCount, sessions);
+
+    if (log) *log << "Backtesting started..." << std::endl;
+    std::vector<std::unique_ptr<Strategy>> strategies(variants.size());
+    for (size_t v = 0; v < variants.size(); ++v) {
+        strategies[v] = variants[v](*nodes.front().portfolio);
+        nodes.front().members.push_back(v);
+        strategies[v]->onStart();
+    }
+
+    std::string timestamp(19, ' ');
+    std::vector<OrderIntent> orders;
+    std::vector<SweepNode> forks;
+    barsProcessed = 0;
+    for (size_t s = 0; s < segments.size(); ++s) {
+        const BarView& bars = segments[s];
+        const size_t count = bars.size();
+        if (count == 0) continue;
+
+        size_t next = s + 1;
+        while (next < segments.size() && segments[next].empty()) ++next;
+        const bool continues = next < segments.size() && isSameSession(bars.timestamps[count - 1], segments[next].timestamps[0]);
+
+        for (size_t i = 0; i < count; ++i) {
+            BT_COUNT(BarsProcessed, 1);
+            const int64_t epochSeconds = bars.timestamps[i];
+            const TimeSeriesData bar = bars.at(i);
+            const bool sessionClose = i + 1 == count ? !continues : !isSameSession(epochSeconds, bars.timestamps[i + 1]);
+            TimeUtils::formatTimestamp(epochSeconds, timestamp.data());
+
+            for (size_t n = 0; n < nodes.size(); ++n) {
+                SweepNode& node = nodes[n];
+                node.portfolio->setTime(epochSeconds);
+                BT_PROFILE_SCOPE(OnData);
+                if (node.members.size() == 1) {
+                    strategies[node.members.front()]->onData(timestamp, bar);
+                    continue;
+                }
+
+                orders.clear();
+                for (size_t member : node.members) orders.push_back(strategies[member]->decide(timestamp, bar));
+                node.order = orders.front();
+
+                // Members placing another order than the first continue on copies
+                // of the portfolio as it was before this bar's order, one per
+                // order. The copies leave the history so far with this node and
+                // only take it back once the sweep is over.
+                const size_t firstFork = forks.size();
+                if (std::find_if(orders.begin(), orders.end(), [&](const OrderIntent& order) { return order != node.order; }) != orders.end()) {
+                    SnapshotWriter state;
+                    node.portfolio->saveBook(state);
+                    size_t kept = 0;
+                    for (size_t k = 0; k < node.members.size(); ++k) {
+                        const size_t member = node.members[k];
+                        if (orders[k] == node.order) {
+                            node.members[kept++] = member;
+                            continue;
+                        }
+                        auto fork = std::find_if(forks.begin() + firstFork, forks.end(),
+                            [&](const SweepNode& candidate) { return candidate.order == orders[k]; });
+                        if (fork == forks.end()) {
+                            forks.push_back(restoreNode(state.bytes(), false, node.risk.get(), node.portfolio->getLog()));
+                            forks.back().portfolio->reserveHistory(barCount - barsProcessed, sessions);
+                            forks.back().order = orders[k];
+                            forks.back().parent = n;
+                            forks.back().forkedAt = node.portfolio->getHistoryMark();
+                            fork = forks.end() - 1;
+                        }
+                        strategies[member] = moveStrategy(*strategies[member], variants[member], *fork->portfolio);
+                        fork->members.push_back(member);
+                    }
+                    node.members.resize(kept);
+                }
+
+                if (node.order.quantity != 0) strategies[node.members.front()]->execute(timestamp, node.order);
+                for (size_t f = firstFork; f < forks.size(); ++f) {
+                    strategies[forks[f].members.front()]->execute(timestamp, forks[f].order);
+                }
+            }
+
+            // Forks have placed this bar's orders already and are marked with the rest
+            for (SweepNode& fork : forks) nodes.push_back(std::move(fork));
+            forks.clear();
+
+            {
+                BT_PROFILE_SCOPE(UpdateNetWorth);
+                for (SweepNode& node : nodes) node.portfolio->updateNetWorth(symbol, bar.close, sessionClose);
+            }
+            for (const SweepNode& node : nodes) {
+                if (node.members.size() > 1) {
+                    for (size_t member : node.members) ++runs[member].sharedBars;
+                }
+            }
+            ++barsProcessed;
+        }
+    }
+
+    for (SweepNode& node : nodes) node.portfolio->closeHistory();
+
+    // Forks take back the history they continue, newest first, so each
+    // parent's own history is still unchanged when its forks read it
+    for (size_t n = nodes.size(); n-- > 0;) {
+        std::vector<std::pair<const Portfolio*, Portfolio::HistoryMark>> prefixes;
+        for (size_t child = n; nodes[child].parent != NoParent; child = nodes[child].parent) {
+            prefixes.emplace_back(nodes[nodes[child].parent].portfolio.get(), nodes[child].forkedAt);
+        }
+        std::reverse(prefixes.begin(), prefixes.end());
+        if (!prefixes.empty()) nodes[n].portfolio->prependHistory(prefixes);
+    }
+
+    // Variants still sharing a portfolio each get their own copy
+    for (SweepNode& node : nodes) {
+        if (node.members.size() == 1) continue;
+        SnapshotWriter state;
+        node.portfolio->saveState(state);
+        for (size_t k = 1; k < node.members.size(); ++k) {
+            const size_t member = node.members[k];
+            SweepNode copy = restoreNode(state.bytes(), true, node.risk.get(), node.portfolio->getLog());
+            strategies[member] = moveStrategy(*strategies[member], variants[member], *copy.portfolio);
+            runs[member].risk = std::move(copy.risk);
+            runs[member].portfolio = std::move(copy.portfolio);
+        }
+        node.members.resize(1);
+    }
+    for (SweepNode& node : nodes) {
+        SweepRun& run = runs[node.members.front()];
+        run.risk = std::move(node.risk);
+        run.portfolio = std::move(node.portfolio);
+    }
+
+    for (size_t v = 0; v < variants.size(); ++v) {
+        runs[v].strategy = std::move(strategies[v]);
+        runs[v].strategy->onEnd();
+    }
+    if (log) *log << "Backtesting completed successfully." << std::endl;
+    return runs;
+}
+
+// ---------------------  Pipelined Runs  -------------------------------------------
+
+namespace {
+
+using PipelineClock = std::chrono::steady_clock;
+
+// One bar as the strategy stage consumes it
+struct DecodedBar {
+    int64_t epochSeconds;
+    TimeSeriesData data;
+    bool sessionClose;
+    char timestamp[19];        // "YYYY-MM-DD HH:MM:SS"
+};
+
+// Bars from the decode stage, shared by every run's strategy stage
+struct BarBatch {
+    std::vector<DecodedBar> bars;
+    size_t count = 0;
+    bool last = false;                       // No bars follow (the batch may be empty)
+    PipelineClock::time_point decoded;
+    std::atomic<size_t> readers{ 0 };        // Strategy stages yet to finish with the batch
+};
+
+// One run's equity after each bar of a batch, for the metrics stage
+struct MarkBatch {
+    size_t run = 0;
+    std::vector<double> equity;
+    size_t count = 0;
+    bool last = false;
+    PipelineClock::time_point decoded;
+};
+
+// Lets the first stage to fail stop the others. Only the stage that sets
+// `failed` writes `error`, and it is read after every thread is joined.
+struct PipelineControl {
+    std::atomic<bool> failed{ false };
+    std::exception_ptr error;
+
+    void fail() {
+        if (!failed.exchange(true)) error = std::current_exception();
+    }
+};
+
+// Wait for room or for a value; false once another stage has failed
+template <typename Ring, typename T>
+bool pushWait(Ring& ring, T value, const PipelineControl& control) {
+    Backoff backoff;
+    while (!ring.tryPush(std::move(value))) {
+        if (control.failed.load(std::memory_order_relaxed)) return false;
+        backoff.pause();
+    }
+    return true;
+}
+
+template <typename Ring, typename T>
+bool popWait(Ring& ring, T& value, const PipelineControl& control) {
+    Backoff backoff;
+    while (!ring.tryPop(value)) {
+        if (control.failed.load(std::memory_order_relaxed)) return false;
+        backoff.pause();
+    }
+    return true;
+}
+
+} // namespace
+
+void BacktestingEngine::setPipelining(size_t batchBars, size_t queueBatches) {
+    if (batchBars == 0 || queueBatches == 0) throw std::invalid_argument("Pipeline batch size and queue depth must be positive.");
+    pipelineBatch = batchBars;
+    pipelineQueue = queueBatches;
+}
+
+PipelineStats BacktestingEngine::runPipelined(DataModule& dataModule, Strategy& strategy, Portfolio& portfolio) {
+    return runPipelined(dataModule.adjusted(), strategy, portfolio);
+}
+
+PipelineStats BacktestingEngine::runPipelined(const std::vector<BarView>& segments, Strategy& strategy,
+                                              Portfolio& portfolio) {
+    return runPipelined(segments, { { &strategy, &portfolio } });
+}
+
+PipelineStats BacktestingEngine::runPipelined(const std::vector<BarView>& segments,
+                                              const std::vector<std::pair<Strategy*, Portfolio*>>& runs) {
+    if (checkpointInterval > 0 || resumeBars > 0) {
+        throw std::logic_error("Pipelined runs do not support checkpointing or resume.");
+    }
+    if (runs.empty()) throw std::invalid_argument("A pipelined run needs at least one strategy.");
+
+    if (log) *log << "Backtesting started..." << std::endl;
+    for (const auto& [strategy, portfolio] : runs) {
+        strategy->onStart();
+        reserveHistory(segments, *portfolio);
+    }
+
+    // Batches circulate decode -> strategy stages -> back to the free list;
+    // there are never more in flight than the queues can hold, so a push to
+    // a run's queue always finds room
+    const size_t runCount = runs.size();
+    std::vector<std::unique_ptr<BarBatch>> barBatches;
+    MpscRing<BarBatch*> freeBars(pipelineQueue);
+    for (size_t i = 0; i < pipelineQueue; ++i) {
+        barBatches.push_back(std::make_unique<BarBatch>());
+        barBatches.back()->bars.resize(pipelineBatch);
+        freeBars.tryPush(barBatches.back().get());
+    }
+    std::vector<std::unique_ptr<SpscRing<BarBatch*>>> decoded;
+    std::vector<std::unique_ptr<SpscRing<MarkBatch*>>> freeMarks;
+    std::vector<std::unique_ptr<MarkBatch>> markBatches;
+    MpscRing<MarkBatch*> marked(runCount * pipelineQueue);
+    for (size_t r = 0; r < runCount; ++r) {
+        decoded.push_back(std::make_unique<SpscRing<BarBatch*>>(pipelineQueue));
+        freeMarks.push_back(std::make_unique<SpscRing<MarkBatch*>>(pipelineQueue));
+        for (size_t i = 0; i < pipelineQueue; ++i) {
+            markBatches.push_back(std::make_unique<MarkBatch>());
+            markBatches.back()->run = r;
+            markBatches.back()->equity.resize(pipelineBatch);
+            freeMarks.back()->tryPush(markBatches.back().get());
+        }
+    }
+
+    PipelineControl control;
+    PipelineStats stats;
+    stats.metrics.resize(runCount);
+    const std::string& marketSymbol = symbol;
+
+    // Decode: resolve each bar once for every run and hand out full batches
+    auto decodeStage = [&]() {
+        try {
+            BarBatch* batch = nullptr;
+            auto publish = [&](bool last) {
+                batch->last = last;
+                batch->decoded = PipelineClock::now();
+                batch->readers.store(runCount, std::memory_order_relaxed);
+                stats.bars += batch->count;
+                ++stats.batches;
+                for (auto& queue : decoded) {
+                    if (!pushWait(*queue, batch, control)) return false;
+                }
+                batch = nullptr;
+                return true;
+            };
+            auto acquire = [&]() {
+                if (!popWait(freeBars, batch, control)) return false;
+                batch->count = 0;
+                return true;
+            };
+
+            if (!acquire()) return;
+            for (size_t s = 0; s < segments.size(); ++s) {
+                const BarView& bars = segments[s];
+                const size_t count = bars.size();
+                if (count == 0) continue;
+                size_t next = s + 1;
+                while (next < segments.size() && segments[next].empty()) ++next;
+                const bool continues = next < segments.size() && isSameSession(bars.timestamps[count - 1], segments[next].timestamps[0]);
+
+                for (size_t i = 0; i < count; ++i) {
+                    DecodedBar& bar = batch->bars[batch->count++];
+                    bar.epochSeconds = bars.timestamps[i];
+                    bar.data = bars.at(i);
+                    bar.sessionClose = i + 1 == count ? !continues : !isSameSession(bars.timestamps[i], bars.timestamps[i + 1]);
+                    TimeUtils::formatTimestamp(bar.epochSeconds, bar.timestamp);
+                    if (batch->count == pipelineBatch && (!publish(false) || !acquire())) return;
+                }
+            }
+            publish(true);
+        }
+        catch (...) {
+            control.fail();
+        }
+    };
+
+    // Strategy: the run's own thread, so the strategy sees fills and marks in bar order
+    auto strategyStage = [&](size_t r) {
+        Strategy& strategy = *runs[r].first;
+        Portfolio& portfolio = *runs[r].second;
+        std::string timestamp(19, ' ');
+        try {
+            for (;;) {
+                BarBatch* batch = nullptr;
+                MarkBatch* marks = nullptr;
+                if (!popWait(*decoded[r], batch, control) || !popWait(*freeMarks[r], marks, control)) return;
+                for (size_t i = 0; i < batch->count; ++i) {
+                    const DecodedBar& bar = batch->bars[i];
+                    BT_COUNT(BarsProcessed, 1);
+                    std::copy(bar.timestamp, bar.timestamp + sizeof(bar.timestamp), timestamp.begin());
+                    portfolio.setTime(bar.epochSeconds);
+                    {
+                        BT_PROFILE_SCOPE(OnData);
+                        strategy.onData(timestamp, bar.data);
+                    }
+                    {
+                        BT_PROFILE_SCOPE(UpdateNetWorth);
+                        portfolio.updateNetWorth(marketSymbol, bar.data.close, bar.sessionClose);
+                    }
+                    marks->equity[i] = portfolio.getEquity();
+                }
+                marks->count = batch->count;
+                marks->last = batch->last;
+                marks->decoded = batch->decoded;
+                const bool last = batch->last;
+                if (batch->readers.fetch_sub(1, std::memory_order_acq_rel) == 1 && !pushWait(freeBars, batch, control)) return;
+                if (!pushWait(marked, marks, control) || last) return;
+            }
+        }
+        catch (...) {
+            control.fail();
+        }
+    };
+
+    // Metrics: fold every run's equity into its running metrics
+    auto metricsStage = [&]() {
+        try {
+            double latencySum = 0.0;
+            size_t latencyBars = 0;
+            for (size_t finished = 0; finished < runCount;) {
+                MarkBatch* marks = nullptr;
+                if (!popWait(marked, marks, control)) return;
+                RunningMetrics& metrics = stats.metrics[marks->run];
+                for (size_t i = 0; i < marks->count; ++i) metrics.add(marks->equity[i]);
+                const double latency = std::chrono::duration<double>(PipelineClock::now() - marks->decoded).count();
+                latencySum += latency * marks->count;
+                latencyBars += marks->count;
+                stats.maxLatencySeconds = std::max(stats.maxLatencySeconds, latency);
+                if (marks->last) ++finished;
+                if (!pushWait(*freeMarks[marks->run], marks, control)) return;
+            }
+            stats.meanLatencySeconds = latencyBars > 0 ? latencySum / latencyBars : 0.0;
+        }
+        catch (...) {
+            control.fail();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    try {
+        threads.emplace_back(decodeStage);
+        for (size_t r = 0; r < runCount; ++r) threads.emplace_back(strategyStage, r);
+        threads.emplace_back(metricsStage);
+    }
+    catch (...) {
+        control.fail();
+    }
+    for (std::thread& thread : threads) thread.join();
+    if (control.error) std::rethrow_exception(control.error);
+
+    barsProcessed = stats.bars;
+    for (const auto& [strategy, portfolio] : runs) {
+        portfolio->closeHistory();
+        strategy->onEnd();
+    }
+    if (log) *log << "Backtesting completed successfully." << std::endl;
+    return stats;
 }
+
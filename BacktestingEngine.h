@@ -1,11 +1,177 @@
 #pragma once
-#include "Strategies.h"
+#include "Checkpoint.h"
+#include "metrics.h"
+#include "strategies.h"
+#include <functional>
+#include <memory>
 #include <queue>
+#include <string>
+#include <utility>
 #include <numeric>
+#include <vector>
+
+class BarSource;
+class TickBars;
+
+// Builds one variant of a sweep, trading `portfolio`
+using StrategyFactory = std::function<std::unique_ptr<Strategy>(Portfolio& portfolio)>;
+
+// Outcome of one sweep variant (see BacktestingEngine::runSweep)
+struct SweepRun {
+    std::unique_ptr<RiskEngine> risk;  // The run's copy of the prototype's risk engine, if it had one
+    std::unique_ptr<Portfolio> portfolio;
+    std::unique_ptr<Strategy> strategy;
+    size_t sharedBars = 0;             // Bars run on a portfolio shared with other variants
+};
+
+// Outcome of a pipelined run (see BacktestingEngine::runPipelined)
+struct PipelineStats {
+    size_t bars = 0;
+    size_t batches = 0;
+    std::vector<RunningMetrics> metrics;   // Per run, from the equity after every bar
+    double meanLatencySeconds = 0.0;       // Per bar, from its batch being decoded to its equity
+    double maxLatencySeconds = 0.0;        // reaching the metrics stage
+};
 
 // ---------------------  Backtesting Engine  -------------------------------------------
 class BacktestingEngine {
 public:
-    // Run the backtest with the data module, strategy, and portfolio
+    // `symbol` is the instrument the bars belong to; the portfolio's position
+    // in it is marked at each bar's close
+    explicit BacktestingEngine(std::string symbol = "SPY") : symbol(std::move(symbol)) {}
+
+    const std::string& getSymbol() const { return symbol; }
+
+    // Version of the results a run produces (see ResultCache). Bump it with
+    // every change that alters a run's fills, equity curve or metrics.
+    static constexpr uint32_t ResultVersion = 1;
+
+    // Write a checkpoint to `path` every `intervalBars` bars of each run
+    // (0 turns checkpointing off). Each one replaces the previous, so `path`
+    // always holds the latest.
+    void setCheckpointing(const std::string& path, size_t intervalBars);
+
+    // Restore the strategy and portfolio from a checkpoint. The next run over
+    // the same data skips the bars the checkpoint covers and continues from
+    // there; it throws std::runtime_error if the data does not match.
+    void resume(const Checkpoint& checkpoint, Strategy& strategy, Portfolio& portfolio);
+    void resume(const std::string& checkpointPath, Strategy& strategy, Portfolio& portfolio);
+
+    // Stream for the start and end of run messages (std::cout by default);
+    // null turns them off. Portfolios and strategies have their own.
+    void setLog(std::ostream* stream) { log = stream; }
+
+    // Bars handled so far by the current or last run (including resumed ones)
+    uint64_t getBarsProcessed() const { return barsProcessed; }
+
+    // Run the backtest with the data module, strategy, and portfolio (over the
+    // back-adjusted bars if the data module has corporate actions)
     void runBacktest(DataModule& dataModule, Strategy& strategy, Portfolio& portfolio);
+
+    // Run the backtest over a view of the data, such as DataModule::range() or one
+    // side of a walk-forward split. Only the bars inside the view are read.
+    void runBacktest(const BarView& bars, Strategy& strategy, Portfolio& portfolio);
+
+    // Run one backtest over several views in order, such as the per-day views
+    // from DataModule::sessions(). Sessions are tracked across segment boundaries.
+    void runBacktest(const std::vector<BarView>& segments, Strategy& strategy, Portfolio& portfolio);
+
+    // Run the backtest pulling bars chunk by chunk from a streaming source.
+    // Memory stays bounded by the chunk size as long as the portfolio's equity
+    // sampling is bounded too (EveryNth or SessionClose for very long runs).
+    void runBacktest(BarSource& source, Strategy& strategy, Portfolio& portfolio);
+
+    // Run the backtest over bars held in ticks (FixedPoint.h), expanded to
+    // prices one chunk at a time (see TickBarSource)
+    void runBacktest(const TickBars& bars, Strategy& strategy, Portfolio& portfolio);
+
+    // Run every variant over the same bars (as runBacktest does), each from a copy of `prototype`,
+    // sharing work between variants whose runs have not diverged. Variants
+    // start on one shared portfolio: each bar, every variant's strategy
+    // decides (see Strategy::decide) and those placing the same order keep
+    // sharing, so the warm-up and the prefix up to the first differing order
+    // are marked and recorded once. Where orders differ, the portfolio's book
+    // (Portfolio::saveBook) is snapshotted and each group continues on its own
+    // copy, its strategies restored from their state into new instances from
+    // the factories. The history recorded so far stays with the portfolio it
+    // was forked off; each copy takes it back once, at the end of the sweep.
+    // Results, in variant order, match separate runBacktest calls. Variants
+    // alone on a portfolio run through plain onData. Shared bars log once,
+    // and the runs' portfolios have no journal attached.
+    //
+    // Sharing only saves the per-bar work of the shared prefix. A sweep pays
+    // off when variants agree for a long stretch, such as a long common
+    // warm-up, and mostly through the logging it saves. A typical crossover
+    // grid diverges within a few hundred bars; it runs at about the speed of
+    // separate runs with logging on, and slightly slower with logging off
+    // (see the benchmark's runSweep rows), so BatchConfig::sharePrefix is off
+    // by default.
+    std::vector<SweepRun> runSweep(DataModule& dataModule, const Portfolio& prototype,
+                                   const std::vector<StrategyFactory>& variants);
+    std::vector<SweepRun> runSweep(const BarView& bars, const Portfolio& prototype,
+                                   const std::vector<StrategyFactory>& variants);
+    std::vector<SweepRun> runSweep(const std::vector<BarView>& segments, const Portfolio& prototype,
+                                   const std::vector<StrategyFactory>& variants);
+
+    // Batch size and queue depth (in batches) of pipelined runs
+    void setPipelining(size_t batchBars, size_t queueBatches = DefaultPipelineQueue);
+
+    // Run the backtest as runBacktest does, split into stages on their own
+    // threads, connected by lock-free ring buffers (RingBuffer.h) that carry
+    // batches of bars: a decode stage (adjusted bar values, session closes
+    // and timestamp text), a strategy stage per run (onData, fills and
+    // marking, which the strategy's next decision depends on), and a metrics
+    // stage folding each run's per-bar equity into RunningMetrics. A run's
+    // portfolio, strategy calls and logging are the same as with runBacktest.
+    // With several runs, each gets its own strategy stage over one shared
+    // decode, and their per-bar logging interleaves. The first exception of
+    // any stage stops the others and is rethrown. Checkpointing and resume
+    // are not supported (std::logic_error).
+    PipelineStats runPipelined(DataModule& dataModule, Strategy& strategy, Portfolio& portfolio);
+    PipelineStats runPipelined(const std::vector<BarView>& segments, Strategy& strategy, Portfolio& portfolio);
+    PipelineStats runPipelined(const std::vector<BarView>& segments,
+                               const std::vector<std::pair<Strategy*, Portfolio*>>& runs);
+
+    static constexpr size_t DefaultPipelineBatch = 256;
+    static constexpr size_t DefaultPipelineQueue = 8;
+
+private:
+    std::string symbol;
+    std::string checkpointPath;
+    size_t checkpointInterval = 0;
+    uint64_t barsProcessed = 0;
+    uint64_t resumeBars = 0;      // Bars the next run skips (from resume())
+    int64_t resumeTimestamp = 0;  // Expected time of the last skipped bar
+    uint64_t skipRemaining = 0;   // Bars the current run has yet to skip
+    size_t pipelineBatch = DefaultPipelineBatch;
+    size_t pipelineQueue = DefaultPipelineQueue;
+    std::ostream* log = &std::cout;
+
+    // Bars at the start of a block of `count` that a resumed run skips; checks
+    // the last skipped bar against the checkpoint
+    size_t skipResumed(const int64_t* timestamps, size_t count);
+
+    // Start a run: continue from a pending resume or from the first bar
+    void beginRun();
+
+    // Throw if a resumed run ended before reaching its checkpoint
+    void endRun();
+
+    // Count a processed bar and write a checkpoint when one is due
+    void afterBar(const Strategy& strategy, const Portfolio& portfolio, int64_t epochSeconds) {
+        ++barsProcessed;
+        if (checkpointInterval > 0 && barsProcessed % checkpointInterval == 0) {
+            Checkpoint::capture(barsProcessed, epochSeconds, strategy, portfolio).save(checkpointPath);
+        }
+    }
+
+    // Run the strategy and portfolio update for one bar
+    void processBar(Strategy& strategy, Portfolio& portfolio, std::string& timestamp,
+                    int64_t epochSeconds, const TimeSeriesData& timeSeriesData, bool sessionClose) const;
+
+    // Whether two timestamps fall on the same trading session (same calendar date)
+    static bool isSameSession(int64_t a, int64_t b);
+
+    // Size the portfolio's history for a run over `segments` so it never reallocates mid-run
+    static void reserveHistory(const std::vector<BarView>& segments, Portfolio& portfolio);
 };
@@ -0,0 +1,303 @@
+#include "BarFile.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char BarFileMagic[8] = { 'B', 'T', 'B', 'A', 'R', 'S', 0, 0 };
+constexpr uint32_t BarFileVersion = 1;
+constexpr size_t BytesPerBar = 6 * sizeof(int64_t);
+constexpr size_t MaxEncodedBytesPerBar = 10 + 4 * 9 + 10; // Two varints plus four prices, worst case
+
+template <typename T>
+void writeColumn(std::ofstream& file, const std::vector<T>& column, size_t begin, size_t count) {
+    file.write(reinterpret_cast<const char*>(column.data() + begin), count * sizeof(T));
+}
+
+template <typename T>
+void readColumn(std::ifstream& file, std::vector<T>& column, size_t count) {
+    column.resize(count);
+    file.read(reinterpret_cast<char*>(column.data()), count * sizeof(T));
+}
+
+// ---------------------  Delta Block Codec  -------------------------------------------
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Wrapping subtraction, so arbitrary int64 columns round-trip without overflow
+int64_t difference(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+}
+
+int64_t sum(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+
+void putVarint(std::vector<char>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// Bounds-checked reader over an encoded payload
+class Cursor {
+public:
+    Cursor(const char* data, size_t size)
+        : p(reinterpret_cast<const uint8_t*>(data)), end(p + size) {}
+
+    uint8_t byte() {
+        if (p == end) throw std::runtime_error("Corrupt compressed bar block.");
+        return *p++;
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const uint8_t b = byte();
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return value;
+        }
+        throw std::runtime_error("Corrupt compressed bar block.");
+    }
+
+    bool atEnd() const { return p == end; }
+
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+};
+
+void encodeTimestamps(const std::vector<int64_t>& column, size_t begin, size_t count, std::vector<char>& out) {
+    int64_t previous = 0;
+    int64_t previousDelta = 0;
+    for (size_t i = begin; i < begin + count; ++i) {
+        const int64_t delta = difference(column[i], previous);
+        putVarint(out, zigzag(difference(delta, previousDelta)));
+        previous = column[i];
+        previousDelta = delta;
+    }
+}
+
+void decodeTimestamps(Cursor& in, std::vector<int64_t>& column, size_t count) {
+    column.resize(count);
+    int64_t previous = 0;
+    int64_t previousDelta = 0;
+    for (size_t i = 0; i < count; ++i) {
+        previousDelta = sum(previousDelta, unzigzag(in.varint()));
+        previous = sum(previous, previousDelta);
+        column[i] = previous;
+    }
+}
+
+void encodeVolumes(const std::vector<int64_t>& column, size_t begin, size_t count, std::vector<char>& out) {
+    int64_t previous = 0;
+    for (size_t i = begin; i < begin + count; ++i) {
+        putVarint(out, zigzag(difference(column[i], previous)));
+        previous = column[i];
+    }
+}
+
+void decodeVolumes(Cursor& in, std::vector<int64_t>& column, size_t count) {
+    column.resize(count);
+    int64_t previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        previous = sum(previous, unzigzag(in.varint()));
+        column[i] = previous;
+    }
+}
+
+// XOR with the previous value; a control byte (trailing zero bytes << 4 |
+// significant bytes) precedes the significant bytes, least significant first
+void encodePrices(const std::vector<double>& column, size_t begin, size_t count, std::vector<char>& out) {
+    uint64_t previous = 0;
+    for (size_t i = begin; i < begin + count; ++i) {
+        uint64_t bits;
+        std::memcpy(&bits, &column[i], sizeof(bits));
+        uint64_t x = bits ^ previous;
+        previous = bits;
+
+        int trailing = 0;
+        int significant = 0;
+        if (x != 0) {
+            while ((x & 0xFF) == 0) {
+                x >>= 8;
+                ++trailing;
+            }
+            for (uint64_t rest = x; rest != 0; rest >>= 8) ++significant;
+        }
+        out.push_back(static_cast<char>((trailing << 4) | significant));
+        for (int k = 0; k < significant; ++k) out.push_back(static_cast<char>(x >> (8 * k)));
+    }
+}
+
+void decodePrices(Cursor& in, std::vector<double>& column, size_t count) {
+    column.resize(count);
+    uint64_t previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t control = in.byte();
+        const int trailing = control >> 4;
+        const int significant = control & 0x0F;
+        if (trailing + significant > 8) throw std::runtime_error("Corrupt compressed bar block.");
+        uint64_t x = 0;
+        for (int k = 0; k < significant; ++k) x |= static_cast<uint64_t>(in.byte()) << (8 * k);
+        previous ^= x << (8 * trailing);
+        std::memcpy(&column[i], &previous, sizeof(previous));
+    }
+}
+
+} // namespace
+
+// ---------------------  BarFileWriter  -------------------------------------------
+
+BarFileWriter::BarFileWriter(const std::string& path, const std::string& symbol, uint32_t blockBars,
+                             BarCompression compression) {
+    open(path, symbol, blockBars, compression);
+}
+
+BarFileWriter::~BarFileWriter() {
+    try {
+        close();
+    }
+    catch (...) {
+        // Destructors must not throw; call close() explicitly to observe errors
+    }
+}
+
+// Create the file and write a provisional header
+void BarFileWriter::open(const std::string& path, const std::string& symbol, uint32_t blockBars,
+                         BarCompression compression) {
+    if (blockBars == 0) throw std::invalid_argument("Block size must be positive.");
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) throw std::runtime_error("Failed to create bar file: " + path);
+
+    header = BarFileHeader{};
+    std::memcpy(header.magic, BarFileMagic, sizeof(header.magic));
+    header.version = BarFileVersion;
+    header.blockBars = blockBars;
+    header.flags = compression == BarCompression::Delta ? BarFileFlagCompressed : 0;
+    std::strncpy(header.symbol, symbol.c_str(), sizeof(header.symbol) - 1);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+// Append bars, split into blocks of at most blockBars
+void BarFileWriter::write(const BarColumns& bars) {
+    if (!file.is_open()) throw std::runtime_error("Bar file is not open.");
+
+    for (size_t begin = 0; begin < bars.size(); begin += header.blockBars) {
+        size_t count = std::min<size_t>(header.blockBars, bars.size() - begin);
+        if (header.flags & BarFileFlagCompressed) {
+            encoded.clear();
+            encodeTimestamps(bars.timestamps, begin, count, encoded);
+            encodePrices(bars.open, begin, count, encoded);
+            encodePrices(bars.high, begin, count, encoded);
+            encodePrices(bars.low, begin, count, encoded);
+            encodePrices(bars.close, begin, count, encoded);
+            encodeVolumes(bars.volume, begin, count, encoded);
+
+            BarBlockHeader block{ static_cast<uint32_t>(count), static_cast<uint32_t>(encoded.size()) };
+            file.write(reinterpret_cast<const char*>(&block), sizeof(block));
+            file.write(encoded.data(), encoded.size());
+            header.barCount += count;
+            continue;
+        }
+
+        BarBlockHeader block{ static_cast<uint32_t>(count), static_cast<uint32_t>(count * BytesPerBar) };
+        file.write(reinterpret_cast<const char*>(&block), sizeof(block));
+        writeColumn(file, bars.timestamps, begin, count);
+        writeColumn(file, bars.open, begin, count);
+        writeColumn(file, bars.high, begin, count);
+        writeColumn(file, bars.low, begin, count);
+        writeColumn(file, bars.close, begin, count);
+        writeColumn(file, bars.volume, begin, count);
+        header.barCount += count;
+    }
+    if (!file) throw std::runtime_error("Failed to write bar file.");
+}
+
+// Finalize the header with the bar count and close the file
+void BarFileWriter::close() {
+    if (!file.is_open()) return;
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    if (!file) throw std::runtime_error("Failed to finalize bar file.");
+}
+
+// ---------------------  BarFileReader  -------------------------------------------
+
+BarFileReader::BarFileReader(const std::string& path) {
+    open(path);
+}
+
+// Open the file and validate its header
+void BarFileReader::open(const std::string& path) {
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) throw std::runtime_error("Failed to open bar file: " + path);
+
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, BarFileMagic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a bar file: " + path);
+    }
+    if (header.version != BarFileVersion || (header.flags & ~BarFileFlagCompressed) != 0) {
+        throw std::runtime_error("Unsupported bar file version: " + path);
+    }
+    barsRead = 0;
+}
+
+std::string BarFileReader::getSymbol() const {
+    return std::string(header.symbol, strnlen(header.symbol, sizeof(header.symbol)));
+}
+
+// Replace the contents of `bars` with the next block
+bool BarFileReader::readBlock(BarColumns& bars) {
+    bars.clear();
+    if (barsRead >= header.barCount) return false;
+
+    BarBlockHeader block;
+    file.read(reinterpret_cast<char*>(&block), sizeof(block));
+    if (!file || block.count == 0 || block.count > header.blockBars) {
+        throw std::runtime_error("Corrupt bar file block.");
+    }
+
+    if (isCompressed()) {
+        if (block.payloadBytes > block.count * MaxEncodedBytesPerBar) throw std::runtime_error("Corrupt bar file block.");
+        encoded.resize(block.payloadBytes);
+        file.read(encoded.data(), encoded.size());
+        if (!file) throw std::runtime_error("Truncated bar file block.");
+
+        Cursor in(encoded.data(), encoded.size());
+        decodeTimestamps(in, bars.timestamps, block.count);
+        decodePrices(in, bars.open, block.count);
+        decodePrices(in, bars.high, block.count);
+        decodePrices(in, bars.low, block.count);
+        decodePrices(in, bars.close, block.count);
+        decodeVolumes(in, bars.volume, block.count);
+        if (!in.atEnd()) throw std::runtime_error("Corrupt compressed bar block.");
+
+        barsRead += block.count;
+        return true;
+    }
+
+    if (block.payloadBytes != block.count * BytesPerBar) throw std::runtime_error("Corrupt bar file block.");
+
+    readColumn(file, bars.timestamps, block.count);
+    readColumn(file, bars.open, block.count);
+    readColumn(file, bars.high, block.count);
+    readColumn(file, bars.low, block.count);
+    readColumn(file, bars.close, block.count);
+    readColumn(file, bars.volume, block.count);
+    if (!file) throw std::runtime_error("Truncated bar file block.");
+
+    barsRead += block.count;
+    return true;
+}
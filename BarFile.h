@@ -0,0 +1,96 @@
+#pragma once
+#include "TimeSeries.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// ---------------------  Binary Bar File  -------------------------------------------
+//
+// Compact binary cache of a single symbol's bars. Layout (little-endian):
+//
+//   BarFileHeader
+//   repeated: BarBlockHeader, then `count` values of each column in order
+//             timestamps (int64), open, high, low, close (double), volume (int64)
+//
+// Blocks hold at most `blockBars` bars, so readers can stream the file in
+// bounded memory.
+//
+// With BarFileFlagCompressed set, each block's payload is instead the
+// columns delta-encoded (BarCompression::Delta): timestamps as zigzag varint
+// delta-of-deltas, prices XOR-ed with the previous value of the column with
+// zero bytes trimmed, volumes as zigzag varint deltas. Every block decodes on
+// its own, and the encoding is lossless.
+
+enum class BarCompression {
+    None,  // Raw columns
+    Delta  // Block-compressed columns
+};
+
+constexpr uint32_t BarFileFlagCompressed = 1;
+
+struct BarFileHeader {
+    char magic[8];          // "BTBARS" followed by two zero bytes
+    uint32_t version;       // Format version (currently 1)
+    uint32_t flags;         // BarFileFlag* bits; all others must be zero
+    uint64_t barCount;      // Total number of bars in the file
+    uint32_t blockBars;     // Maximum bars per block
+    uint32_t reserved;
+    char symbol[16];        // Null-padded symbol name
+};
+static_assert(sizeof(BarFileHeader) == 48, "BarFileHeader must be 48 bytes");
+
+struct BarBlockHeader {
+    uint32_t count;         // Bars in this block
+    uint32_t payloadBytes;  // Size of the column data that follows
+};
+static_assert(sizeof(BarBlockHeader) == 8, "BarBlockHeader must be 8 bytes");
+
+class BarFileWriter {
+public:
+    static constexpr uint32_t DefaultBlockBars = 65536;
+
+    BarFileWriter() = default;
+    BarFileWriter(const std::string& path, const std::string& symbol, uint32_t blockBars = DefaultBlockBars,
+                  BarCompression compression = BarCompression::None);
+    ~BarFileWriter();
+
+    // Create the file and write a provisional header
+    void open(const std::string& path, const std::string& symbol, uint32_t blockBars = DefaultBlockBars,
+              BarCompression compression = BarCompression::None);
+
+    // Append bars, split into blocks of at most blockBars
+    void write(const BarColumns& bars);
+
+    // Finalize the header with the bar count and close the file
+    void close();
+
+    uint64_t barCount() const { return header.barCount; }
+
+private:
+    std::ofstream file;
+    BarFileHeader header{};
+    std::vector<char> encoded; // Scratch buffer for compressed blocks
+};
+
+class BarFileReader {
+public:
+    BarFileReader() = default;
+    explicit BarFileReader(const std::string& path);
+
+    // Open the file and validate its header; throws std::runtime_error on failure
+    void open(const std::string& path);
+
+    const BarFileHeader& getHeader() const { return header; }
+    std::string getSymbol() const;
+    bool isCompressed() const { return (header.flags & BarFileFlagCompressed) != 0; }
+
+    // Replace the contents of `bars` with the next block. Returns false at end of file.
+    bool readBlock(BarColumns& bars);
+
+private:
+    std::ifstream file;
+    BarFileHeader header{};
+    uint64_t barsRead = 0;
+    std::vector<char> encoded; // Scratch buffer for compressed blocks
+};
@@ -0,0 +1,108 @@
+#include "BarSource.h"
+#include <stdexcept>
+#include <utility>
+
+// ---------------------  CSVStreamSource  -------------------------------------------
+
+CSVStreamSource::CSVStreamSource(const std::string& filePath, size_t chunkBars)
+    : input(filePath), chunkBars(chunkBars) {
+    if (chunkBars == 0) throw std::invalid_argument("Chunk size must be positive.");
+}
+
+bool CSVStreamSource::nextChunk(BarColumns& chunk) {
+    chunk.clear();
+    while (!finished) {
+        parser.parse(chunk, chunkBars - chunk.size());
+        if (chunk.size() >= chunkBars) break;
+
+        // Buffered lines are used up; read more of the file
+        if (input.next(readBuffer)) {
+            parser.append(readBuffer.data(), readBuffer.size());
+        }
+        else {
+            parser.finish(chunk);
+            finished = true;
+        }
+    }
+    return !chunk.empty();
+}
+
+// ---------------------  BinaryStreamSource  -------------------------------------------
+
+BinaryStreamSource::BinaryStreamSource(const std::string& filePath) : reader(filePath) {}
+
+bool BinaryStreamSource::nextChunk(BarColumns& chunk) {
+    return reader.readBlock(chunk);
+}
+
+// ---------------------  TickBarSource  -------------------------------------------
+
+TickBarSource::TickBarSource(const TickBars& bars, size_t chunkBars) : bars(bars), chunkBars(chunkBars) {
+    if (chunkBars == 0) throw std::invalid_argument("Chunk size must be positive.");
+}
+
+bool TickBarSource::nextChunk(BarColumns& chunk) {
+    chunk.clear();
+    bars.appendColumns(position, position + chunkBars, chunk);
+    position += chunk.size();
+    return !chunk.empty();
+}
+
+// ---------------------  ReadAheadSource  -------------------------------------------
+
+ReadAheadSource::ReadAheadSource(std::unique_ptr<BarSource> wrapped)
+    : source(std::move(wrapped)), hint(source ? source->sizeHint() : 0) {
+    if (!source) throw std::invalid_argument("ReadAheadSource needs a source.");
+    producer = std::thread([this]() { produce(); });
+}
+
+ReadAheadSource::~ReadAheadSource() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    producer.join();
+}
+
+// Producer thread: fill staging, then hand it over once the consumer took the previous chunk
+void ReadAheadSource::produce() {
+    for (;;) {
+        bool more = false;
+        std::exception_ptr failure;
+        try {
+            more = source->nextChunk(staging);
+        }
+        catch (...) {
+            failure = std::current_exception();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]() { return !hasReady || stopping; });
+        if (stopping) return;
+        if (failure || !more) {
+            error = failure;
+            exhausted = true;
+            changed.notify_all();
+            return;
+        }
+        std::swap(ready, staging);
+        hasReady = true;
+        changed.notify_all();
+    }
+}
+
+bool ReadAheadSource::nextChunk(BarColumns& chunk) {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]() { return hasReady || exhausted; });
+    if (hasReady) {
+        // Hand the consumer's old storage back to the producer for reuse
+        std::swap(chunk, ready);
+        hasReady = false;
+        changed.notify_all();
+        return true;
+    }
+    if (error) std::rethrow_exception(error);
+    chunk.clear();
+    return false;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include "BarFile.h"
+#include "CSVParser.h"
+#include "FileBlockReader.h"
+#include "FixedPoint.h"
+#include "TimeSeries.h"
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ---------------------  Bar Sources  -------------------------------------------
+//
+// Streaming input for BacktestingEngine::runBacktest. The engine pulls bars in
+// chunks, so only a few chunks are in memory at any time regardless of the
+// dataset size. Bars are delivered in file order; streamed files are expected
+// to be sorted by timestamp already.
+class BarSource {
+public:
+    virtual ~BarSource() = default;
+
+    // Replace the contents of `chunk` with the next bars (at least one). Returns
+    // false once the source is exhausted.
+    virtual bool nextChunk(BarColumns& chunk) = 0;
+
+    // Total number of bars if known up front, otherwise 0
+    virtual size_t sizeHint() const { return 0; }
+};
+
+// Parses a CSV file incrementally, chunkBars bars at a time. Gzip-compressed
+// files are inflated on a separate thread (see FileBlockReader).
+class CSVStreamSource : public BarSource {
+public:
+    static constexpr size_t DefaultChunkBars = 65536;
+
+    explicit CSVStreamSource(const std::string& filePath, size_t chunkBars = DefaultChunkBars);
+
+    bool nextChunk(BarColumns& chunk) override;
+
+    size_t malformedRows() const { return parser.malformedRows(); }
+
+private:
+    FileBlockReader input;
+    CSVBarParser parser;
+    std::vector<char> readBuffer;
+    size_t chunkBars;
+    bool finished = false;
+};
+
+// Reads a binary bar file one block at a time
+class BinaryStreamSource : public BarSource {
+public:
+    explicit BinaryStreamSource(const std::string& filePath);
+
+    bool nextChunk(BarColumns& chunk) override;
+    size_t sizeHint() const override { return static_cast<size_t>(reader.getHeader().barCount); }
+
+private:
+    BarFileReader reader;
+};
+
+// Expands an in-memory TickBars series chunkBars bars at a time, so a run over
+// tick-stored bars holds only one chunk of double columns beside the ticks.
+// The series must outlive the source.
+class TickBarSource : public BarSource {
+public:
+    static constexpr size_t DefaultChunkBars = 65536;
+
+    explicit TickBarSource(const TickBars& bars, size_t chunkBars = DefaultChunkBars);
+
+    bool nextChunk(BarColumns& chunk) override;
+    size_t sizeHint() const override { return bars.size(); }
+
+private:
+    const TickBars& bars;
+    size_t chunkBars;
+    size_t position = 0;
+};
+
+// Read-ahead decorator: a background thread pulls the next chunk from the
+// wrapped source while the consumer works on the current one. The producer
+// fills a staging chunk while a second, completed chunk waits for the
+// consumer (double buffering); chunk storage is recycled between the two.
+// Exceptions thrown by the wrapped source are rethrown from nextChunk().
+class ReadAheadSource : public BarSource {
+public:
+    explicit ReadAheadSource(std::unique_ptr<BarSource> source);
+    ~ReadAheadSource() override;
+
+    ReadAheadSource(const ReadAheadSource&) = delete;
+    ReadAheadSource& operator=(const ReadAheadSource&) = delete;
+
+    bool nextChunk(BarColumns& chunk) override;
+    size_t sizeHint() const override { return hint; }
+
+private:
+    void produce();
+
+    std::unique_ptr<BarSource> source;
+    size_t hint;
+    BarColumns staging;   // Being filled by the producer
+    BarColumns ready;     // Completed, waiting for the consumer
+    bool hasReady = false;
+    bool exhausted = false;
+    bool stopping = false;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread producer;
+};
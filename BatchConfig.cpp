@@ -0,0 +1,202 @@
+#include "BatchConfig.h"
+#include "json/json.h"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+const Json::Value& requireMember(const Json::Value& object, const char* key, const std::string& where) {
+    const Json::Value& value = object[key];
+    if (value.isNull()) throw std::invalid_argument(where + ": missing \"" + key + "\"");
+    return value;
+}
+
+std::string readString(const Json::Value& object, const char* key, const std::string& where,
+                       const std::string& fallback) {
+    const Json::Value& value = object[key];
+    if (value.isNull()) return fallback;
+    if (!value.isString()) throw std::invalid_argument(where + "." + key + " must be a string");
+    return value.asString();
+}
+
+double readNumber(const Json::Value& object, const char* key, const std::string& where, double fallback) {
+    const Json::Value& value = object[key];
+    if (value.isNull()) return fallback;
+    if (!value.isNumeric()) throw std::invalid_argument(where + "." + key + " must be a number");
+    return value.asDouble();
+}
+
+const Json::Value& readArray(const Json::Value& root, const char* key) {
+    const Json::Value& value = root[key];
+    if (!value.isNull() && !value.isArray()) throw std::invalid_argument(std::string(key) + " must be an array");
+    return value;
+}
+
+// Values of one parameter: a number, a list of numbers or a from/to/step range
+std::vector<double> parameterValues(const Json::Value& value, const std::string& where) {
+    std::vector<double> values;
+    if (value.isNumeric()) {
+        values.push_back(value.asDouble());
+    }
+    else if (value.isArray() && !value.empty()) {
+        for (const Json::Value& item : value) {
+            if (!item.isNumeric()) throw std::invalid_argument(where + " must hold numbers");
+            values.push_back(item.asDouble());
+        }
+    }
+    else if (value.isObject()) {
+        const double from = readNumber(value, "from", where, NAN);
+        const double to = readNumber(value, "to", where, NAN);
+        const double step = readNumber(value, "step", where, 1.0);
+        if (std::isnan(from) || std::isnan(to) || !(step > 0) || to < from) {
+            throw std::invalid_argument(where + " must be a range with from <= to and a positive step");
+        }
+        // Index the values rather than accumulating the step, so the last one lands on `to`
+        const size_t count = static_cast<size_t>(std::floor((to - from) / step + 1e-9)) + 1;
+        for (size_t i = 0; i < count; ++i) values.push_back(from + i * step);
+    }
+    else {
+        throw std::invalid_argument(where + " must be a number, a non-empty list or a range");
+    }
+    return values;
+}
+
+StrategySpec parseStrategy(const Json::Value& object, size_t index) {
+    const std::string where = "strategies[" + std::to_string(index) + "]";
+    if (!object.isObject()) throw std::invalid_argument(where + " must be an object");
+
+    StrategySpec spec;
+    spec.type = readString(object, "type", where, "");
+    if (spec.type.empty()) throw std::invalid_argument(where + ": missing \"type\"");
+    spec.name = readString(object, "name", where, spec.type);
+
+    // Cartesian product over the parameters in name order, the first varying slowest
+    spec.grid.emplace_back();
+    const Json::Value& parameters = object["parameters"];
+    if (parameters.isNull()) return spec;
+    if (!parameters.isObject()) throw std::invalid_argument(where + ".parameters must be an object");
+    for (const std::string& name : parameters.getMemberNames()) {
+        const std::vector<double> values = parameterValues(parameters[name], where + ".parameters." + name);
+        std::vector<ParameterSet> grid;
+        grid.reserve(spec.grid.size() * values.size());
+        for (const ParameterSet& cell : spec.grid) {
+            for (double value : values) {
+                grid.push_back(cell);
+                grid.back().emplace_back(name, value);
+            }
+        }
+        spec.grid = std::move(grid);
+    }
+    return spec;
+}
+
+} // namespace
+
+size_t BatchConfig::runCount() const {
+    size_t cells = 0;
+    for (const StrategySpec& strategy : strategies) cells += strategy.grid.size();
+    return datasets.size() * costModels.size() * cells;
+}
+
+BatchConfig BatchConfig::parse(const Json::Value& root) {
+    if (!root.isObject()) throw std::invalid_argument("Batch configuration must be a JSON object");
+    BatchConfig config;
+
+    const Json::Value& portfolio = root["portfolio"];
+    if (!portfolio.isNull()) {
+        config.cash = readNumber(portfolio, "cash", "portfolio", config.cash);
+        if (config.cash < 0) throw std::invalid_argument("portfolio.cash cannot be negative");
+    }
+
+    const Json::Value& datasets = readArray(root, "datasets");
+    for (Json::ArrayIndex i = 0; i < datasets.size(); ++i) {
+        const std::string where = "datasets[" + std::to_string(i) + "]";
+        DatasetSpec dataset;
+        dataset.path = readString(datasets[i], "path", where, "");
+        if (dataset.path.empty()) throw std::invalid_argument(where + ": missing \"path\"");
+        dataset.name = readString(datasets[i], "name", where, dataset.path);
+        dataset.symbol = readString(datasets[i], "symbol", where, dataset.symbol);
+        config.datasets.push_back(std::move(dataset));
+    }
+    if (config.datasets.empty()) throw std::invalid_argument("datasets must list at least one dataset");
+
+    const Json::Value& strategies = requireMember(root, "strategies", "Batch configuration");
+    if (!strategies.isArray() || strategies.empty()) throw std::invalid_argument("strategies must be a non-empty array");
+    for (Json::ArrayIndex i = 0; i < strategies.size(); ++i) {
+        config.strategies.push_back(parseStrategy(strategies[i], i));
+    }
+
+    const Json::Value& costModels = readArray(root, "costModels");
+    for (Json::ArrayIndex i = 0; i < costModels.size(); ++i) {
+        const std::string where = "costModels[" + std::to_string(i) + "]";
+        CostModelSpec spec;
+        spec.name = readString(costModels[i], "name", where, "cost" + std::to_string(i));
+        spec.model.commissionPerShare = readNumber(costModels[i], "commissionPerShare", where, 0.0);
+        spec.model.commissionPerOrder = readNumber(costModels[i], "commissionPerOrder", where, 0.0);
+        spec.model.slippageBps = readNumber(costModels[i], "slippageBps", where, 0.0);
+        if (spec.model.commissionPerShare < 0 || spec.model.commissionPerOrder < 0 || spec.model.slippageBps < 0) {
+            throw std::invalid_argument(where + ": costs cannot be negative");
+        }
+        config.costModels.push_back(spec);
+    }
+    if (config.costModels.empty()) config.costModels.push_back(CostModelSpec{ "free", CostModel() });
+
+    const Json::Value& outputs = readArray(root, "outputs");
+    for (Json::ArrayIndex i = 0; i < outputs.size(); ++i) {
+        const std::string where = "outputs[" + std::to_string(i) + "]";
+        OutputSpec output;
+        output.type = readString(outputs[i], "type", where, "");
+        output.path = readString(outputs[i], "path", where, "");
+        output.exportPath = readString(outputs[i], "export", where, "");
+        if (output.type != "console" && output.type != "json" && output.type != "columnar") {
+            throw std::invalid_argument(where + ".type must be \"console\", \"json\" or \"columnar\"");
+        }
+        if (output.type != "console" && output.path.empty()) throw std::invalid_argument(where + ": missing \"path\"");
+        if (!output.exportPath.empty() && output.type != "columnar") {
+            throw std::invalid_argument(where + ": \"export\" only applies to columnar outputs");
+        }
+        const std::string extension = std::filesystem::path(output.exportPath).extension().string();
+        if (!output.exportPath.empty() && extension != ".csv" && extension != ".json") {
+            throw std::invalid_argument(where + ".export must end in .csv or .json");
+        }
+        config.outputs.push_back(std::move(output));
+    }
+    if (config.outputs.empty()) config.outputs.push_back(OutputSpec{ "console", "", "" });
+
+    const double threads = readNumber(root, "threads", "Batch configuration", 0.0);
+    if (threads < 0) throw std::invalid_argument("threads cannot be negative");
+    config.threads = static_cast<size_t>(threads);
+    const Json::Value& sharePrefix = root["sharePrefix"];
+    if (!sharePrefix.isNull()) {
+        if (!sharePrefix.isBool()) throw std::invalid_argument("sharePrefix must be true or false");
+        config.sharePrefix = sharePrefix.asBool();
+    }
+
+    const Json::Value& cache = root["cache"];
+    if (!cache.isNull()) {
+        if (!cache.isObject()) throw std::invalid_argument("cache must be an object");
+        config.cacheDirectory = readString(cache, "directory", "cache", "");
+        if (config.cacheDirectory.empty()) throw std::invalid_argument("cache: missing \"directory\"");
+        const Json::Value& equityCurves = cache["equityCurves"];
+        if (!equityCurves.isNull()) {
+            if (!equityCurves.isBool()) throw std::invalid_argument("cache.equityCurves must be true or false");
+            config.cacheEquityCurves = equityCurves.asBool();
+        }
+    }
+    return config;
+}
+
+BatchConfig BatchConfig::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Failed to open batch configuration: " + path);
+
+    Json::CharReaderBuilder reader;
+    Json::Value root;
+    std::string errors;
+    if (!Json::parseFromStream(reader, in, &root, &errors)) {
+        throw std::runtime_error("Invalid JSON in " + path + ": " + errors);
+    }
+    return parse(root);
+}
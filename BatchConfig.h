@@ -0,0 +1,85 @@
+#pragma once
+#include "portfolio.h"
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Json {
+class Value;
+}
+
+// ---------------------  Batch Configuration  -------------------------------------------
+//
+// A batch job read from JSON (see configs/batch_example.json): datasets,
+// strategies with parameter grids, cost models and output sinks. Every grid
+// cell runs on every dataset under every cost model, all in one process
+// with each dataset loaded once (see BatchRunner.h).
+//
+//   {
+//     "portfolio":  { "cash": 100000 },
+//     "datasets":   [ { "name": "spy", "path": "./datasets/spy_2024.csv", "symbol": "SPY" } ],
+//     "strategies": [ { "type": "moving_average", "name": "ma",
+//                       "parameters": { "shortWindow": [5, 10],
+//                                       "longWindow": { "from": 20, "to": 100, "step": 20 },
+//                                       "quantity": 10 } } ],
+//     "costModels": [ { "name": "free" },
+//                     { "name": "retail", "commissionPerShare": 0.005, "slippageBps": 1 } ],
+//     "outputs":    [ { "type": "console" }, { "type": "json", "path": "results.json" },
+//                     { "type": "columnar", "path": "results.btr", "export": "results.csv" } ],
+//     "threads": 0,
+//     "sharePrefix": false,
+//     "cache":      { "directory": ".backtest_cache", "equityCurves": false }
+//   }
+//
+// A parameter is a number, a list of numbers or a from/to/step range, and a
+// strategy's grid is the cartesian product of its parameters. Without
+// "costModels" every run is free of costs; without "outputs" results go to
+// the console; without "cache" every cell runs, cached or not.
+
+// Parameter values of one grid cell, by parameter name
+using ParameterSet = std::vector<std::pair<std::string, double>>;
+
+struct DatasetSpec {
+    std::string name;
+    std::string path;            // CSV (optionally gzip) or binary bar file (.bin)
+    std::string symbol = "SPY";  // Instrument the bars belong to
+};
+
+struct StrategySpec {
+    std::string type;            // See BatchRunner::makeStrategyFactory
+    std::string name;
+    std::vector<ParameterSet> grid;
+};
+
+struct CostModelSpec {
+    std::string name;
+    CostModel model;
+};
+
+struct OutputSpec {
+    std::string type;            // "console", "json" or "columnar" (see ResultTable.h)
+    std::string path;            // File for the file sinks
+    std::string exportPath;      // "export": CSV or JSON copy of a columnar file, written on close
+};
+
+struct BatchConfig {
+    double cash = 100000.0;      // Starting cash of every run
+    std::vector<DatasetSpec> datasets;
+    std::vector<StrategySpec> strategies;
+    std::vector<CostModelSpec> costModels;
+    std::vector<OutputSpec> outputs;
+    size_t threads = 0;          // Worker threads (0 uses one per hardware thread)
+    bool sharePrefix = false;    // Run grids as prefix-sharing sweeps (see BacktestingEngine::runSweep)
+    std::string cacheDirectory;  // Result cache (see ResultCache.h); empty runs every cell
+    bool cacheEquityCurves = false; // Also cache each run's equity curve
+
+    // Total number of runs the job describes
+    size_t runCount() const;
+
+    // Throw std::invalid_argument naming the offending field
+    static BatchConfig parse(const Json::Value& root);
+
+    // Also throws std::runtime_error if the file cannot be read or is not valid JSON
+    static BatchConfig load(const std::string& path);
+};
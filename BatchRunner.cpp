@@ -0,0 +1,291 @@
+#include "BatchRunner.h"
+#include "DataModule.h"
+#include "ResultCache.h"
+#include "ThreadPool.h"
+#include "TradeMatcher.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+
+namespace {
+
+// One grid cell of a job, on the dataset being run
+struct Cell {
+    const CostModelSpec* costModel;
+    const StrategySpec* strategy;
+    const ParameterSet* parameters;
+    StrategyFactory factory;
+    std::string cacheKey;        // Set when the job has a result cache
+};
+
+// A strategy parameter as a positive whole number
+size_t wholeParameter(const std::string& name, double value) {
+    if (!(value >= 1) || std::floor(value) != value || value > 1e9) {
+        throw std::invalid_argument("Parameter " + name + " must be a positive whole number");
+    }
+    return static_cast<size_t>(value);
+}
+
+// Value of a parameter of a resolved set (see BatchRunner::resolveParameters)
+double valueOf(const ParameterSet& parameters, const std::string& name) {
+    auto it = std::find_if(parameters.begin(), parameters.end(), [&name](const auto& entry) { return entry.first == name; });
+    return it->second;
+}
+
+void loadDataset(DataModule& dataModule, const DatasetSpec& dataset) {
+    const bool binary = std::filesystem::path(dataset.path).extension() == ".bin";
+    const bool loaded = binary ? dataModule.loadTimeSeriesBinary(dataset.path) : dataModule.loadTimeSeriesCSV(dataset.path);
+    if (!loaded || dataModule.size() == 0) throw std::runtime_error("Failed to load dataset " + dataset.name + ": " + dataset.path);
+}
+
+RunResult describe(const DatasetSpec& dataset, const Cell& cell) {
+    RunResult result;
+    result.dataset = dataset.name;
+    result.strategy = cell.strategy->name;
+    result.costModel = cell.costModel->name;
+    result.parameters = *cell.parameters;
+    return result;
+}
+
+// Metrics of a finished run (or why they could not be computed)
+void summarize(RunResult& result, const Portfolio& portfolio, const std::vector<BarView>& bars) {
+    try {
+        std::vector<RoundTrip> trips = RoundTripMatcher::match(portfolio.getTrades());
+        RoundTripMatcher::annotateExcursions(trips, bars);
+        result.metrics = Metrics::summarize(portfolio.getEquityCurve(), portfolio.getReturns(), trips);
+        result.finalEquity = portfolio.getEquity();
+        result.fills = portfolio.getTrades().size();
+    }
+    catch (const std::exception& e) {
+        result.error = e.what();
+    }
+}
+
+// Keep a successful run for later jobs; cache write failures fail the job
+void remember(const ResultCache* cache, const Cell& cell, const RunResult& result, const Portfolio& portfolio) {
+    if (cache && result.ok()) cache->store(cell.cacheKey, result, portfolio.getEquityCurve());
+}
+
+// Runs do not log: their per-bar output would only be formatted and thrown
+// away, and workers sharing std::cout would race on its format flags
+void configure(Portfolio& portfolio, double cash, const CostModel& costs) {
+    portfolio.setLog(nullptr);
+    portfolio.setCash(cash);
+    portfolio.setCostModel(costs);
+}
+
+StrategyFactory quiet(const StrategyFactory& factory) {
+    return [factory](Portfolio& portfolio) {
+        std::unique_ptr<Strategy> strategy = factory(portfolio);
+        strategy->setLog(nullptr);
+        return strategy;
+    };
+}
+
+// Run cells [begin, end), which share a strategy spec and cost model, store
+// them in the cache and write each result to the concurrent sinks as soon as
+// it is known
+std::vector<RunResult> runChunk(const DatasetSpec& dataset, const std::vector<BarView>& bars, const std::vector<Cell>& cells,
+                                size_t begin, size_t end, double cash, bool sharePrefix, const ResultCache* cache,
+                                const std::vector<ResultSink*>& concurrentSinks) {
+    std::vector<RunResult> results;
+    results.reserve(end - begin);
+    for (size_t i = begin; i < end; ++i) results.push_back(describe(dataset, cells[i]));
+    BacktestingEngine engine(dataset.symbol);
+    engine.setLog(nullptr);
+
+    if (sharePrefix) {
+        std::vector<SweepRun> runs;
+        try {
+            Portfolio prototype;
+            configure(prototype, cash, cells[begin].costModel->model);
+            std::vector<StrategyFactory> variants;
+            for (size_t i = begin; i < end; ++i) variants.push_back(quiet(cells[i].factory));
+            runs = engine.runSweep(bars, prototype, variants);
+            for (size_t i = 0; i < runs.size(); ++i) summarize(results[i], *runs[i].portfolio, bars);
+        }
+        catch (const std::exception& e) {
+            for (RunResult& result : results) result.error = e.what();
+        }
+        for (size_t i = 0; i < runs.size(); ++i) remember(cache, cells[begin + i], results[i], *runs[i].portfolio);
+        for (const RunResult& result : results) {
+            for (ResultSink* sink : concurrentSinks) sink->write(result);
+        }
+        return results;
+    }
+
+    for (size_t i = begin; i < end; ++i) {
+        RunResult& result = results[i - begin];
+        Portfolio portfolio;
+        try {
+            configure(portfolio, cash, cells[i].costModel->model);
+            std::unique_ptr<Strategy> strategy = quiet(cells[i].factory)(portfolio);
+            engine.runBacktest(bars, *strategy, portfolio);
+            summarize(result, portfolio, bars);
+        }
+        catch (const std::exception& e) {
+            result.error = e.what();
+        }
+        remember(cache, cells[i], result, portfolio);
+        for (ResultSink* sink : concurrentSinks) sink->write(result);
+    }
+    return results;
+}
+
+} // namespace
+
+// ---------------------  Batch Runner Methods  -------------------------------------------
+
+ParameterSet BatchRunner::resolveParameters(const std::string& type, const ParameterSet& parameters) {
+    if (type == "moving_average") {
+        size_t shortWindow = 0, longWindow = 0, quantity = 10;
+        for (const auto& [name, value] : parameters) {
+            if (name == "shortWindow") shortWindow = wholeParameter(name, value);
+            else if (name == "longWindow") longWindow = wholeParameter(name, value);
+            else if (name == "quantity") quantity = wholeParameter(name, value);
+            else throw std::invalid_argument("Unknown moving_average parameter: " + name);
+        }
+        if (shortWindow == 0 || longWindow == 0) {
+            throw std::invalid_argument("moving_average needs shortWindow and longWindow");
+        }
+        if (shortWindow >= longWindow) throw std::invalid_argument("moving_average needs shortWindow < longWindow");
+        return { { "longWindow", static_cast<double>(longWindow) }, { "quantity", static_cast<double>(quantity) },
+                 { "shortWindow", static_cast<double>(shortWindow) } };
+    }
+    throw std::invalid_argument("Unknown strategy type: " + type);
+}
+
+StrategyFactory BatchRunner::makeStrategyFactory(const std::string& type, const ParameterSet& parameters,
+                                                 const std::string& symbol) {
+    const ParameterSet resolved = resolveParameters(type, parameters);
+    if (type == "moving_average") {
+        const size_t shortWindow = static_cast<size_t>(valueOf(resolved, "shortWindow"));
+        const size_t longWindow = static_cast<size_t>(valueOf(resolved, "longWindow"));
+        const size_t quantity = static_cast<size_t>(valueOf(resolved, "quantity"));
+        return [=](Portfolio& portfolio) {
+            auto strategy = std::make_unique<MovingAverageStrategy>(shortWindow, longWindow, portfolio);
+            strategy->setSymbol(symbol);
+            strategy->setQuantity(static_cast<int>(quantity));
+            return std::unique_ptr<Strategy>(std::move(strategy));
+        };
+    }
+    throw std::invalid_argument("Unknown strategy type: " + type);
+}
+
+size_t BatchRunner::run(std::ostream& console) {
+    std::vector<std::unique_ptr<ResultSink>> owned;
+    std::vector<ResultSink*> sinks;
+    for (const OutputSpec& output : config.outputs) {
+        owned.push_back(makeResultSink(output, config, console));
+        sinks.push_back(owned.back().get());
+    }
+    return run(sinks);
+}
+
+size_t BatchRunner::run(const std::vector<ResultSink*>& sinks) {
+    // Every cell's strategy is checked before any data is loaded
+    for (const StrategySpec& strategy : config.strategies) {
+        for (const ParameterSet& parameters : strategy.grid) {
+            for (const DatasetSpec& dataset : config.datasets) makeStrategyFactory(strategy.type, parameters, dataset.symbol);
+        }
+    }
+
+    std::vector<ResultSink*> ordered, concurrent;
+    for (ResultSink* sink : sinks) (sink->isConcurrent() ? concurrent : ordered).push_back(sink);
+
+    std::unique_ptr<ResultCache> cache;
+    if (!config.cacheDirectory.empty()) cache = std::make_unique<ResultCache>(config.cacheDirectory, config.cacheEquityCurves);
+
+    ThreadPool pool(config.threads);
+    size_t failures = 0;
+    cachedRuns = 0;
+    for (const DatasetSpec& dataset : config.datasets) {
+        DataModule dataModule;
+        loadDataset(dataModule, dataset);
+        const std::vector<BarView> bars = dataModule.adjusted();
+        const uint64_t barsHash = cache ? ResultCache::hashBars(bars) : 0;
+
+        // Cells in job order, with the outcome of those already in the cache;
+        // only the others (`pending`, still in job order) are run
+        std::vector<std::optional<RunResult>> cached;
+        std::vector<Cell> pending;
+        for (const CostModelSpec& costModel : config.costModels) {
+            for (const StrategySpec& strategy : config.strategies) {
+                for (const ParameterSet& parameters : strategy.grid) {
+                    Cell cell{ &costModel, &strategy, &parameters,
+                        makeStrategyFactory(strategy.type, parameters, dataset.symbol), "" };
+                    cached.emplace_back();
+                    if (cache) {
+                        Portfolio prototype;
+                        configure(prototype, config.cash, costModel.model);
+                        cell.cacheKey = ResultCache::makeKey(barsHash, dataset.symbol, strategy.type,
+                                                             resolveParameters(strategy.type, parameters), prototype);
+                        RunResult result = describe(dataset, cell);
+                        if (cache->lookup(cell.cacheKey, result)) {
+                            cached.back() = std::move(result);
+                            ++cachedRuns;
+                            continue;
+                        }
+                    }
+                    pending.push_back(std::move(cell));
+                }
+            }
+        }
+
+        // Split each strategy spec's pending cells under one cost model into
+        // chunks, one per worker when sweeping, one per cell otherwise
+        std::vector<std::future<std::vector<RunResult>>> chunks;
+        for (size_t begin = 0; begin < pending.size();) {
+            size_t groupEnd = begin;
+            while (groupEnd < pending.size() && pending[groupEnd].strategy == pending[begin].strategy
+                && pending[groupEnd].costModel == pending[begin].costModel) {
+                ++groupEnd;
+            }
+            const size_t groupSize = groupEnd - begin;
+            const size_t chunkCount = config.sharePrefix ? std::min(pool.size(), groupSize) : groupSize;
+            for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+                const size_t first = begin + groupSize * chunk / chunkCount;
+                const size_t last = begin + groupSize * (chunk + 1) / chunkCount;
+                chunks.push_back(pool.submit([&, first, last]() {
+                    return runChunk(dataset, bars, pending, first, last, config.cash, config.sharePrefix, cache.get(),
+                                    concurrent);
+                }));
+            }
+            begin = groupEnd;
+        }
+
+        try {
+            // Merge cached and fresh results back into job order
+            size_t nextChunk = 0, nextResult = 0;
+            std::vector<RunResult> fresh;
+            for (std::optional<RunResult>& cell : cached) {
+                if (!cell) {
+                    while (nextResult == fresh.size()) {
+                        fresh = chunks[nextChunk++].get();
+                        nextResult = 0;
+                    }
+                    cell = std::move(fresh[nextResult++]);
+                }
+                else {
+                    for (ResultSink* sink : concurrent) sink->write(*cell);
+                }
+                if (!cell->ok()) ++failures;
+                for (ResultSink* sink : ordered) sink->write(*cell);
+            }
+        }
+        catch (...) {
+            // The remaining chunks still read this dataset and its cells
+            for (auto& chunk : chunks) {
+                if (chunk.valid()) chunk.wait();
+            }
+            throw;
+        }
+    }
+
+    for (ResultSink* sink : sinks) sink->close();
+    return failures;
+}
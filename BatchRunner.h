@@ -0,0 +1,54 @@
+#pragma once
+#include "BacktestingEngine.h"
+#include "BatchConfig.h"
+#include "ResultSink.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// ---------------------  Batch Runner  -------------------------------------------
+//
+// Runs a whole batch job (see BatchConfig.h) in one process. Each dataset is
+// loaded once and shared, read-only, by every run over it. Its grid cells are
+// split into contiguous chunks across a thread pool. A chunk is one cell
+// run with runBacktest or, with sharePrefix on, one prefix-sharing sweep
+// (BacktestingEngine::runSweep). Per-bar logging is discarded while the
+// job runs; results reach the sinks in job order (dataset, cost model,
+// strategy, grid cell) however the chunks are scheduled, except for
+// concurrent sinks, which the workers write directly as runs finish. With a
+// result cache configured, cells already in it are not run again (see
+// ResultCache.h) and every new successful run is added to it.
+class BatchRunner {
+public:
+    explicit BatchRunner(BatchConfig config) : config(std::move(config)) {}
+
+    const BatchConfig& getConfig() const { return config; }
+
+    // Factory for a strategy of a registered type with the given parameters,
+    // trading `symbol`. Types: "moving_average" (shortWindow below
+    // longWindow, and optionally quantity). Throws std::invalid_argument for unknown types,
+    // unknown or missing parameters and invalid values.
+    static StrategyFactory makeStrategyFactory(const std::string& type, const ParameterSet& parameters,
+                                               const std::string& symbol);
+
+    // Every parameter of a strategy type, defaults filled in, sorted by name
+    // (what decides the strategy's behaviour, for the result cache). Throws
+    // as makeStrategyFactory does.
+    static ParameterSet resolveParameters(const std::string& type, const ParameterSet& parameters);
+
+    // Run the job into the configured outputs, with console output going to
+    // `console` (the runs themselves do not log); returns the number of
+    // failed runs. Throws for configuration errors (checked before anything
+    // runs), unreadable datasets and sink failures.
+    size_t run(std::ostream& console);
+
+    // Run the job into `sinks` instead of the configured outputs
+    size_t run(const std::vector<ResultSink*>& sinks);
+
+    // Runs of the last run() answered from the result cache
+    size_t getCachedRuns() const { return cachedRuns; }
+
+private:
+    BatchConfig config;
+    size_t cachedRuns = 0;
+};
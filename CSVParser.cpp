@@ -0,0 +1,129 @@
+#include "CSVParser.h"
+#include "TimeUtils.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+// Strip surrounding spaces from a field
+void trim(const char*& first, const char*& last) {
+    while (first < last && *first == ' ') ++first;
+    while (last > first && (last[-1] == ' ' || last[-1] == '\r')) --last;
+}
+
+template <typename T>
+bool parseNumber(const char* first, const char* last, T& value) {
+    trim(first, last);
+    if (first < last && *first == '+') ++first;
+    auto [end, error] = std::from_chars(first, last, value);
+    return error == std::errc() && end == last && first != last;
+}
+
+} // namespace
+
+// Buffer raw bytes for parsing
+void CSVBarParser::append(const char* data, size_t size) {
+    // Drop already-parsed bytes before growing the buffer
+    if (offset > 0 && offset >= pending.size() / 2) {
+        pending.erase(0, offset);
+        offset = 0;
+    }
+    pending.append(data, size);
+}
+
+// Parse buffered complete lines into `out`
+size_t CSVBarParser::parse(BarColumns& out, size_t maxBars) {
+    size_t added = 0;
+    const char* data = pending.data();
+    while (added < maxBars) {
+        const char* lineStart = data + offset;
+        const char* newline = static_cast<const char*>(std::memchr(lineStart, '\n', pending.size() - offset));
+        if (!newline) break;
+        added += parseLine(lineStart, newline, out);
+        offset = newline - data + 1;
+    }
+    return added;
+}
+
+// Parse a final line that has no trailing newline
+size_t CSVBarParser::finish(BarColumns& out) {
+    size_t added = parse(out);
+    if (offset < pending.size()) {
+        added += parseLine(pending.data() + offset, pending.data() + pending.size(), out);
+    }
+    pending.clear();
+    offset = 0;
+    return added;
+}
+
+bool CSVBarParser::hasBufferedLines() const {
+    return std::memchr(pending.data() + offset, '\n', pending.size() - offset) != nullptr;
+}
+
+void CSVBarParser::reportError(const std::string& message) {
+    ++malformed;
+    if (onError) onError(lineNumber, message);
+}
+
+// Parse one line (without its newline)
+bool CSVBarParser::parseLine(const char* first, const char* last, BarColumns& out) {
+    if (++lineNumber == 1) {
+        // Skip header line if present
+        return false;
+    }
+
+    // Split into the first six comma-separated fields
+    const char* fields[7];
+    int fieldCount = 0;
+    fields[fieldCount++] = first;
+    for (const char* p = first; p < last && fieldCount < 7; ++p) {
+        if (*p == ',') fields[fieldCount++] = p + 1;
+    }
+    auto fieldEnd = [&](int index) { return index + 1 < fieldCount ? fields[index + 1] - 1 : last; };
+    auto fieldEmpty = [&](int index) {
+        const char* begin = fields[index];
+        const char* end = fieldEnd(index);
+        trim(begin, end);
+        return begin == end;
+    };
+
+    auto line = [&]() {
+        const char* end = last;
+        if (end > first && end[-1] == '\r') --end;
+        return std::string(first, end);
+    };
+    bool missing = fieldCount < 6;
+    for (int i = 0; i < 6 && !missing; ++i) missing = fieldEmpty(i);
+    if (missing) {
+        reportError("Error: Malformed line (" + std::to_string(lineNumber) + ") -> " + line());
+        return false;
+    }
+
+    const char* timestampFirst = fields[0];
+    const char* timestampLast = fieldEnd(0);
+    trim(timestampFirst, timestampLast);
+
+    int64_t timestamp;
+    double open, high, low, close;
+    int64_t volume;
+    const char* reason = nullptr;
+    if (!TimeUtils::parseTimestamp(timestampFirst, timestampLast, timestamp)) reason = "invalid timestamp";
+    else if (!parseNumber(fields[1], fieldEnd(1), open)) reason = "invalid open";
+    else if (!parseNumber(fields[2], fieldEnd(2), high)) reason = "invalid high";
+    else if (!parseNumber(fields[3], fieldEnd(3), low)) reason = "invalid low";
+    else if (!parseNumber(fields[4], fieldEnd(4), close)) reason = "invalid close";
+    else if (!parseNumber(fields[5], fieldEnd(5), volume)) reason = "invalid volume";
+    if (reason) {
+        reportError("Error parsing line (" + std::to_string(lineNumber) + "): " + line() + " -> " + reason);
+        return false;
+    }
+
+    out.timestamps.push_back(timestamp);
+    out.open.push_back(open);
+    out.high.push_back(high);
+    out.low.push_back(low);
+    out.close.push_back(close);
+    out.volume.push_back(volume);
+    return true;
+}
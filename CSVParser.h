@@ -0,0 +1,48 @@
+#pragma once
+#include "TimeSeries.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+
+// ---------------------  CSV Bar Parser  -------------------------------------------
+//
+// Incremental parser for "date,open,high,low,close,volume" rows. Raw bytes are
+// appended in arbitrary pieces; complete lines are parsed on demand, and a
+// partial line at the end of a piece is kept until the rest arrives. The first
+// line is treated as the header and skipped.
+class CSVBarParser {
+public:
+    // Called for every malformed row with its 1-based line number and a message
+    using ErrorHandler = std::function<void(size_t lineNumber, const std::string& message)>;
+
+    explicit CSVBarParser(ErrorHandler onError = nullptr) : onError(std::move(onError)) {}
+
+    // Buffer raw bytes for parsing
+    void append(const char* data, size_t size);
+
+    // Parse buffered complete lines into `out`, stopping once `maxBars` bars were
+    // added. Returns the number of bars added.
+    size_t parse(BarColumns& out, size_t maxBars = std::numeric_limits<size_t>::max());
+
+    // Parse a final line that has no trailing newline; call after the last append()
+    size_t finish(BarColumns& out);
+
+    // Whether complete lines remain buffered after a parse() that hit maxBars
+    bool hasBufferedLines() const;
+
+    size_t linesRead() const { return lineNumber; }
+    size_t malformedRows() const { return malformed; }
+
+private:
+    // Parse one line (without its newline). Returns true if a bar was added.
+    bool parseLine(const char* first, const char* last, BarColumns& out);
+    void reportError(const std::string& message);
+
+    ErrorHandler onError;
+    std::string pending;   // Buffered bytes not yet parsed
+    size_t offset = 0;     // Start of unparsed bytes in pending
+    size_t lineNumber = 0;
+    size_t malformed = 0;
+};
@@ -0,0 +1,91 @@
+#include "Checkpoint.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr char CheckpointMagic[8] = { 'B', 'T', 'C', 'H', 'K', 'P', 'T', '\0' };
+constexpr uint32_t CheckpointVersion = 3;
+
+uint64_t fnv1a(const std::vector<char>& bytes) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char byte : bytes) {
+        hash ^= static_cast<unsigned char>(byte);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+Checkpoint Checkpoint::capture(uint64_t barsProcessed, int64_t lastTimestamp, const Strategy& strategy,
+                               const Portfolio& portfolio) {
+    SnapshotWriter out;
+    strategy.saveState(out);
+    portfolio.saveState(out);
+
+    Checkpoint checkpoint;
+    checkpoint.barsProcessed = barsProcessed;
+    checkpoint.lastTimestamp = lastTimestamp;
+    checkpoint.state = out.take();
+    return checkpoint;
+}
+
+void Checkpoint::restore(Strategy& strategy, Portfolio& portfolio) const {
+    if (state.empty()) throw std::runtime_error("Cannot restore an empty checkpoint.");
+    SnapshotReader in(state);
+    strategy.loadState(in);
+    portfolio.loadState(in);
+    if (!in.atEnd()) throw std::runtime_error("Checkpoint has trailing data; was it taken with another strategy?");
+}
+
+void Checkpoint::save(const std::string& path) const {
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CheckpointMagic, sizeof(header.magic));
+    header.version = CheckpointVersion;
+    header.barsProcessed = barsProcessed;
+    header.lastTimestamp = lastTimestamp;
+    header.payloadBytes = state.size();
+    header.checksum = fnv1a(state);
+
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Failed to create checkpoint: " + temporary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(state.data(), static_cast<std::streamsize>(state.size()));
+        out.flush();
+        if (!out) throw std::runtime_error("Failed to write checkpoint: " + temporary);
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) throw std::runtime_error("Failed to replace checkpoint " + path + ": " + error.message());
+}
+
+Checkpoint Checkpoint::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Failed to open checkpoint: " + path);
+
+    CheckpointHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, CheckpointMagic, sizeof(CheckpointMagic)) != 0) {
+        throw std::runtime_error("Not a checkpoint: " + path);
+    }
+    if (header.version != CheckpointVersion) throw std::runtime_error("Unsupported checkpoint version: " + path);
+
+    std::error_code error;
+    const uintmax_t fileBytes = std::filesystem::file_size(path, error);
+    if (error || fileBytes - sizeof(header) != header.payloadBytes) throw std::runtime_error("Truncated checkpoint: " + path);
+
+    Checkpoint checkpoint;
+    checkpoint.barsProcessed = header.barsProcessed;
+    checkpoint.lastTimestamp = header.lastTimestamp;
+    checkpoint.state.resize(static_cast<size_t>(header.payloadBytes));
+    if (!in.read(checkpoint.state.data(), static_cast<std::streamsize>(checkpoint.state.size()))) {
+        throw std::runtime_error("Truncated checkpoint: " + path);
+    }
+    if (fnv1a(checkpoint.state) != header.checksum) throw std::runtime_error("Corrupt checkpoint: " + path);
+    return checkpoint;
+}
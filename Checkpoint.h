@@ -0,0 +1,63 @@
+#pragma once
+#include "Snapshot.h"
+#include "strategies.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ---------------------  Checkpoints  -------------------------------------------
+//
+// Snapshot of a run after a given number of bars: the strategy's and the
+// portfolio's state (positions, cash, equity curve and returns, from which
+// every metric is computed, fills and risk state), encoded with
+// SnapshotWriter. BacktestingEngine writes one at a fixed bar interval (see
+// setCheckpointing) and resumes from one, skipping the bars it covers.
+//
+// File layout: CheckpointHeader, then `payloadBytes` of state. The payload
+// checksum rejects torn or corrupted files, and save() writes a temporary
+// file and renames it over the target, so the latest complete checkpoint
+// survives a crash mid-write.
+//
+// A checkpoint can also be restored into several fresh strategy/portfolio
+// pairs, to fork what-if runs from a shared warm-up instead of replaying it.
+
+struct CheckpointHeader {
+    char magic[8];          // "BTCHKPT" followed by a zero byte
+    uint32_t version;       // Format version (currently 3)
+    uint32_t reserved;
+    uint64_t barsProcessed; // Bars of the run covered by the state
+    int64_t lastTimestamp;  // Time of the last of them (epoch seconds)
+    uint64_t payloadBytes;
+    uint64_t checksum;      // FNV-1a of the payload
+};
+static_assert(sizeof(CheckpointHeader) == 48, "CheckpointHeader must be 48 bytes");
+
+class Checkpoint {
+public:
+    Checkpoint() = default;
+
+    // State of `strategy` and `portfolio` after `barsProcessed` bars, the last at `lastTimestamp`
+    static Checkpoint capture(uint64_t barsProcessed, int64_t lastTimestamp, const Strategy& strategy,
+                              const Portfolio& portfolio);
+
+    // Replace the state of `strategy` and `portfolio` with the captured one.
+    // Both must be configured as when the checkpoint was taken (same strategy
+    // type and parameters); throws std::runtime_error otherwise.
+    void restore(Strategy& strategy, Portfolio& portfolio) const;
+
+    // Write atomically to `path`; throws std::runtime_error on I/O failure
+    void save(const std::string& path) const;
+
+    // Throws std::runtime_error if the file is missing, truncated or corrupt
+    static Checkpoint load(const std::string& path);
+
+    uint64_t getBarsProcessed() const { return barsProcessed; }
+    int64_t getLastTimestamp() const { return lastTimestamp; }
+    size_t size() const { return state.size(); }
+    bool empty() const { return state.empty(); }
+
+private:
+    uint64_t barsProcessed = 0;
+    int64_t lastTimestamp = 0;
+    std::vector<char> state;
+};
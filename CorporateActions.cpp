@@ -0,0 +1,183 @@
+#include "CorporateActions.h"
+#include "TimeUtils.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+std::string trim(const std::string& text) {
+    const size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return std::string();
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+// "4", "0.5" or "3:2"
+double parseRatio(const std::string& text) {
+    const size_t colon = text.find(':');
+    if (colon == std::string::npos) return std::stod(text);
+    return std::stod(text.substr(0, colon)) / std::stod(text.substr(colon + 1));
+}
+
+int64_t scaleVolume(int64_t volume, double factor) {
+    return factor == 1.0 ? volume : std::llround(static_cast<double>(volume) * factor);
+}
+
+} // namespace
+
+// ---------------------  CorporateActions  -------------------------------------------
+
+void CorporateActions::addSplit(int64_t exDate, double ratio) {
+    if (!(ratio > 0)) throw std::invalid_argument("Split ratio must be positive.");
+    add({ exDate, CorporateActionType::Split, ratio });
+}
+
+void CorporateActions::addDividend(int64_t exDate, double amount) {
+    if (!(amount >= 0)) throw std::invalid_argument("Dividend amount must not be negative.");
+    add({ exDate, CorporateActionType::Dividend, amount });
+}
+
+// Keep actions sorted by ex-date (stable for actions on the same date)
+void CorporateActions::add(const CorporateAction& action) {
+    auto position = std::upper_bound(actions.begin(), actions.end(), action.exDate,
+        [](int64_t exDate, const CorporateAction& other) { return exDate < other.exDate; });
+    actions.insert(position, action);
+}
+
+std::vector<AdjustmentFactor> CorporateActions::factors(const BarView& raw) const {
+    const int64_t* first = raw.timestamps;
+    const int64_t* last = raw.timestamps + raw.size();
+
+    // Factor contributed by each action on its own
+    std::vector<AdjustmentFactor> schedule(actions.size());
+    for (size_t i = 0; i < actions.size(); ++i) {
+        const CorporateAction& action = actions[i];
+        AdjustmentFactor& factor = schedule[i];
+        factor.until = action.exDate;
+        factor.price = 1.0;
+        factor.volume = 1.0;
+        if (action.type == CorporateActionType::Split) {
+            factor.price = 1.0 / action.value;
+            factor.volume = action.value;
+            continue;
+        }
+        const size_t next = std::lower_bound(first, last, action.exDate) - first;
+        if (next == 0) continue; // No bar before the ex-date to adjust
+        const double previousClose = raw.close[next - 1];
+        if (!(action.value < previousClose)) {
+            throw std::invalid_argument("Dividend on " + TimeUtils::toString(action.exDate) + " is not below the previous close.");
+        }
+        factor.price = 1.0 - action.value / previousClose;
+    }
+
+    // Accumulate from the latest action backwards: earlier bars carry every later factor
+    for (size_t i = schedule.size(); i-- > 1;) {
+        schedule[i - 1].price *= schedule[i].price;
+        schedule[i - 1].volume *= schedule[i].volume;
+    }
+    return schedule;
+}
+
+std::vector<BarView> CorporateActions::adjust(const BarView& view, const std::vector<AdjustmentFactor>& schedule) {
+    std::vector<BarView> segments;
+    const int64_t* timestamps = view.timestamps;
+    const size_t count = view.size();
+
+    size_t begin = 0;
+    for (const AdjustmentFactor& factor : schedule) {
+        if (begin == count) break;
+        const size_t end = std::lower_bound(timestamps + begin, timestamps + count, factor.until) - timestamps;
+        if (end > begin) {
+            BarView segment = view.subview(begin, end - begin);
+            segment.priceFactor *= factor.price;
+            segment.volumeFactor *= factor.volume;
+            segments.push_back(segment);
+        }
+        begin = end;
+    }
+    if (begin < count || segments.empty()) segments.push_back(view.subview(begin, count - begin));
+    return segments;
+}
+
+void CorporateActions::materialize(const std::vector<BarView>& segments, BarColumns& out) {
+    size_t total = 0;
+    for (const BarView& segment : segments) total += segment.size();
+    out.resize(total);
+
+    size_t offset = 0;
+    for (const BarView& segment : segments) {
+        const size_t n = segment.size();
+        const double price = segment.priceFactor;
+        const double volume = segment.volumeFactor;
+        std::copy(segment.timestamps, segment.timestamps + n, out.timestamps.data() + offset);
+        double* open = out.open.data() + offset;
+        double* high = out.high.data() + offset;
+        double* low = out.low.data() + offset;
+        double* close = out.close.data() + offset;
+        int64_t* volumes = out.volume.data() + offset;
+        // Separate multiply loops per column so each one vectorizes
+        for (size_t i = 0; i < n; ++i) open[i] = segment.open[i] * price;
+        for (size_t i = 0; i < n; ++i) high[i] = segment.high[i] * price;
+        for (size_t i = 0; i < n; ++i) low[i] = segment.low[i] * price;
+        for (size_t i = 0; i < n; ++i) close[i] = segment.close[i] * price;
+        if (volume == 1.0) std::copy(segment.volume, segment.volume + n, volumes);
+        else for (size_t i = 0; i < n; ++i) volumes[i] = scaleVolume(segment.volume[i], volume);
+        offset += n;
+    }
+}
+
+// ---------------------  CorporateActionTable  -------------------------------------------
+
+CorporateActionTable CorporateActionTable::loadCSV(const std::string& filePath) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) throw std::runtime_error("Failed to open corporate actions file: " + filePath);
+
+    CorporateActionTable table;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (trim(line).empty()) continue;
+
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) fields.push_back(trim(field));
+
+        auto fail = [&](const std::string& why) {
+            return std::runtime_error("Malformed corporate action (" + filePath + ":" + std::to_string(lineNumber) + ") -> " + why);
+        };
+        if (fields.size() != 4) throw fail("expected symbol,date,type,value");
+        if (lineNumber == 1 && fields[0] == "symbol") continue; // Header
+
+        int64_t exDate;
+        if (!TimeUtils::parseTimestamp(fields[1], exDate)) throw fail("invalid date " + fields[1]);
+        std::string type = fields[2];
+        std::transform(type.begin(), type.end(), type.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        try {
+            if (type == "split") table.symbols[fields[0]].addSplit(exDate, parseRatio(fields[3]));
+            else if (type == "dividend") table.symbols[fields[0]].addDividend(exDate, std::stod(fields[3]));
+            else throw fail("unknown type " + fields[2]);
+        }
+        catch (const std::logic_error& e) { // std::stod failures and invalid values
+            throw fail(e.what());
+        }
+    }
+    return table;
+}
+
+void CorporateActionTable::add(const std::string& symbol, const CorporateAction& action) {
+    CorporateActions& target = symbols[symbol];
+    if (action.type == CorporateActionType::Split) target.addSplit(action.exDate, action.value);
+    else target.addDividend(action.exDate, action.value);
+}
+
+const CorporateActions& CorporateActionTable::forSymbol(const std::string& symbol) const {
+    static const CorporateActions none;
+    auto it = symbols.find(symbol);
+    return it == symbols.end() ? none : it->second;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "TimeSeries.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ---------------------  Corporate Actions  -------------------------------------------
+//
+// Splits and cash dividends for one symbol, used to back-adjust its raw bars:
+// the latest bars keep their traded prices and every earlier bar is scaled by
+// the product of the factors of the actions that follow it.
+//
+//   split of ratio r:        prices * 1/r, volumes * r
+//   dividend of amount d:    prices * (1 - d / close of the last bar before the ex-date)
+//
+// The factor is constant between consecutive ex-dates, so an adjusted series
+// is a handful of BarViews over the raw columns with their priceFactor and
+// volumeFactor set; nothing is copied unless materialize() is asked to.
+
+enum class CorporateActionType { Split, Dividend };
+
+struct CorporateAction {
+    int64_t exDate;           // First timestamp trading at the new basis (usually midnight of the ex-date)
+    CorporateActionType type;
+    double value;             // Split: new shares per old share (4 for 4-for-1); dividend: cash per share
+};
+
+// Adjustment for the bars with timestamp < `until` (and >= the previous entry's `until`)
+struct AdjustmentFactor {
+    int64_t until;
+    double price;
+    double volume;
+};
+
+class CorporateActions {
+public:
+    // Throws std::invalid_argument unless ratio > 0
+    void addSplit(int64_t exDate, double ratio);
+
+    // Throws std::invalid_argument unless amount >= 0
+    void addDividend(int64_t exDate, double amount);
+
+    // Actions by ascending ex-date
+    const std::vector<CorporateAction>& getActions() const { return actions; }
+    bool empty() const { return actions.empty(); }
+
+    // Back-adjustment factors for `raw` (sorted, unadjusted bars), ascending by
+    // `until`; bars after the last entry are unadjusted. Dividends before the
+    // first bar are ignored. Throws std::invalid_argument if a dividend is not
+    // below the close it is measured against.
+    std::vector<AdjustmentFactor> factors(const BarView& raw) const;
+
+    // Split `view` into segments that each carry one adjustment factor. The
+    // segments share the view's storage and are returned in order.
+    static std::vector<BarView> adjust(const BarView& view, const std::vector<AdjustmentFactor>& schedule);
+
+    // Copy the adjusted bars of `segments` into contiguous columns (replacing
+    // the contents of `out`), for code that needs adjusted columns rather than
+    // adjusted rows
+    static void materialize(const std::vector<BarView>& segments, BarColumns& out);
+
+private:
+    void add(const CorporateAction& action);
+
+    std::vector<CorporateAction> actions;
+};
+
+// Corporate actions of many symbols, as read from a CSV file with rows
+//
+//   symbol,date,type,value
+//   AAPL,2020-08-31,split,4
+//   SPY,2024-03-15,dividend,1.5953
+//
+// Split ratios may also be written as "new:old" (3:2). A header row is optional.
+class CorporateActionTable {
+public:
+    // Throws std::runtime_error if the file cannot be read or a row is malformed
+    static CorporateActionTable loadCSV(const std::string& filePath);
+
+    void add(const std::string& symbol, const CorporateAction& action);
+
+    // Actions of `symbol` (empty if it has none)
+    const CorporateActions& forSymbol(const std::string& symbol) const;
+
+    size_t symbolCount() const { return symbols.size(); }
+
+private:
+    std::unordered_map<std::string, CorporateActions> symbols;
+};
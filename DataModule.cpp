@@ -0,0 +1,416 @@
+#include "DataModule.h"
+#include "BarFile.h"
+#include "CSVParser.h"
+#include "FileBlockReader.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include "TimeUtils.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t ReadBufferBytes = 8 << 20;
+constexpr size_t MaxEchoedErrors = 5;
+
+// Glob-style match supporting '*' (any run of characters) and '?' (one character)
+bool matchesPattern(const std::string& name, const std::string& pattern) {
+    size_t n = 0, p = 0, starPattern = std::string::npos, starName = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            ++n;
+            ++p;
+        }
+        else if (p < pattern.size() && pattern[p] == '*') {
+            starPattern = p++;
+            starName = n;
+        }
+        else if (starPattern != std::string::npos) {
+            p = starPattern + 1;
+            n = ++starName;
+        }
+        else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+// Copy `count` values of every column from `source` into `target` starting at `offset`
+void copyColumns(const BarColumns& source, BarColumns& target, size_t offset) {
+    std::copy(source.timestamps.begin(), source.timestamps.end(), target.timestamps.begin() + offset);
+    std::copy(source.open.begin(), source.open.end(), target.open.begin() + offset);
+    std::copy(source.high.begin(), source.high.end(), target.high.begin() + offset);
+    std::copy(source.low.begin(), source.low.end(), target.low.begin() + offset);
+    std::copy(source.close.begin(), source.close.end(), target.close.begin() + offset);
+    std::copy(source.volume.begin(), source.volume.end(), target.volume.begin() + offset);
+}
+
+void appendColumns(const BarColumns& source, BarColumns& target) {
+    target.timestamps.insert(target.timestamps.end(), source.timestamps.begin(), source.timestamps.end());
+    target.open.insert(target.open.end(), source.open.begin(), source.open.end());
+    target.high.insert(target.high.end(), source.high.begin(), source.high.end());
+    target.low.insert(target.low.end(), source.low.begin(), source.low.end());
+    target.close.insert(target.close.end(), source.close.begin(), source.close.end());
+    target.volume.insert(target.volume.end(), source.volume.begin(), source.volume.end());
+}
+
+} // namespace
+
+// ---------------------  Loading  -------------------------------------------
+
+// Function to load and parse time series data from CSV
+bool DataModule::loadTimeSeriesCSV(const std::string& filePath) {
+    BT_PROFILE_SCOPE(Load);
+    report = ValidationReport();
+    BarColumns chunk;
+    FileLoadResult result;
+    if (!parseCSV(filePath, chunk, result, true)) {
+        return false;
+    }
+
+    report.malformedRows = result.malformedRows;
+    validator.checkOrder(chunk, report);
+    report.duplicates += normalize(chunk);
+    std::vector<BarColumns> chunks;
+    chunks.push_back(std::move(chunk));
+    mergeChunks(chunks, nullptr);
+    finishValidation();
+    return true;
+}
+
+// Load every matching file in a directory in parallel
+std::vector<FileLoadResult> DataModule::loadDirectoryCSV(const std::string& directory, const std::string& pattern,
+                                                         size_t threads) {
+    BT_PROFILE_SCOPE(Load);
+    namespace fs = std::filesystem;
+
+    std::vector<std::string> paths;
+    std::error_code error;
+    for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        if (it->is_regular_file(error) && matchesPattern(it->path().filename().string(), pattern)) {
+            paths.push_back(it->path().string());
+        }
+    }
+    if (error) {
+        FileLoadResult failed;
+        failed.path = directory;
+        failed.error = "Failed to list directory: " + error.message();
+        return { failed };
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<BarColumns> chunks(paths.size());
+    std::vector<FileLoadResult> results(paths.size());
+    std::vector<ValidationReport> reports(paths.size());
+    ThreadPool pool(threads);
+    pool.parallelFor(paths.size(), [&](size_t i) {
+        results[i].path = paths[i];
+        if (parseCSV(paths[i], chunks[i], results[i], false)) {
+            reports[i].malformedRows = results[i].malformedRows;
+            validator.checkOrder(chunks[i], reports[i]);
+            reports[i].duplicates += normalize(chunks[i]);
+        }
+        else {
+            chunks[i].clear();
+        }
+    });
+
+    report = ValidationReport();
+    for (const auto& fileReport : reports) report.merge(fileReport, validator.getOptions().maxExamples);
+    mergeChunks(chunks, &pool);
+    finishValidation();
+    return results;
+}
+
+// Parse one CSV file into columns, reading it in fixed-size blocks
+bool DataModule::parseCSV(const std::string& filePath, BarColumns& out, FileLoadResult& result, bool echoErrors) {
+    std::unique_ptr<FileBlockReader> input;
+    try {
+        input = std::make_unique<FileBlockReader>(filePath, ReadBufferBytes);
+    }
+    catch (const std::exception&) {
+        result.error = "Failed to open CSV file: " + filePath;
+        if (echoErrors) std::cerr << result.error << std::endl;
+        return false;
+    }
+
+    // Rough row estimate from the file size (about 50 bytes per row, and
+    // gzip typically shrinks CSV bars about 3x)
+    std::error_code sizeError;
+    const auto fileSize = std::filesystem::file_size(filePath, sizeError);
+    if (!sizeError) out.reserve(static_cast<size_t>(fileSize * (input->isCompressed() ? 3 : 1) / 50));
+
+    // Keep the first few messages for a summary instead of printing every bad row
+    std::vector<std::string> firstErrors;
+    CSVBarParser parser([&](size_t, const std::string& message) {
+        if (result.error.empty()) result.error = message;
+        if (firstErrors.size() < MaxEchoedErrors) firstErrors.push_back(message);
+    });
+
+    try {
+        std::vector<char> buffer;
+        while (input->next(buffer)) {
+            parser.append(buffer.data(), buffer.size());
+            parser.parse(out);
+        }
+    }
+    catch (const std::exception& ex) {
+        result.error = "Failed to read CSV file: " + filePath + " -> " + ex.what();
+        if (echoErrors) std::cerr << result.error << std::endl;
+        return false;
+    }
+    parser.finish(out);
+
+    result.malformedRows = parser.malformedRows();
+    result.rows = out.size();
+    if (echoErrors && result.malformedRows > 0) {
+        std::cerr << "Skipped " << result.malformedRows << " malformed rows in " << filePath << ":" << std::endl;
+        for (const auto& message : firstErrors) std::cerr << "  " << message << std::endl;
+        if (result.malformedRows > firstErrors.size()) std::cerr << "  ..." << std::endl;
+    }
+    return true;
+}
+
+// Sort by timestamp and drop duplicates, keeping the last occurrence
+size_t DataModule::normalize(BarColumns& columns) {
+    const auto& timestamps = columns.timestamps;
+    if (std::adjacent_find(timestamps.begin(), timestamps.end(), std::greater_equal<int64_t>()) == timestamps.end()) {
+        return 0; // Already strictly increasing
+    }
+
+    std::vector<size_t> order(columns.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return timestamps[a] < timestamps[b]; });
+
+    BarColumns sorted;
+    sorted.reserve(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        // Of several rows with the same timestamp, only the last one loaded survives
+        if (i + 1 < order.size() && timestamps[order[i + 1]] == timestamps[order[i]]) continue;
+        size_t row = order[i];
+        sorted.timestamps.push_back(timestamps[row]);
+        sorted.open.push_back(columns.open[row]);
+        sorted.high.push_back(columns.high[row]);
+        sorted.low.push_back(columns.low[row]);
+        sorted.close.push_back(columns.close[row]);
+        sorted.volume.push_back(columns.volume[row]);
+    }
+    const size_t dropped = columns.size() - sorted.size();
+    columns = std::move(sorted);
+    return dropped;
+}
+
+// Merge normalized chunks (in priority order, later wins) into the stored series
+void DataModule::mergeChunks(std::vector<BarColumns>& chunks, ThreadPool* pool) {
+    if (!bars.empty()) chunks.insert(chunks.begin(), std::move(bars));
+    chunks.erase(std::remove_if(chunks.begin(), chunks.end(), [](const BarColumns& c) { return c.empty(); }), chunks.end());
+
+    bars.clear();
+    if (chunks.size() <= 1) {
+        if (!chunks.empty()) bars = std::move(chunks.front());
+        chunks.clear();
+        rebuildIndex();
+        return;
+    }
+
+    // Order chunks by their first timestamp and check whether their ranges are disjoint
+    std::vector<size_t> order(chunks.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(),
+        [&](size_t a, size_t b) { return chunks[a].timestamps.front() < chunks[b].timestamps.front(); });
+
+    bool disjoint = true;
+    size_t total = 0;
+    for (size_t k = 0; k < order.size(); ++k) {
+        total += chunks[order[k]].size();
+        if (k > 0 && chunks[order[k - 1]].timestamps.back() >= chunks[order[k]].timestamps.front()) disjoint = false;
+    }
+
+    if (disjoint) {
+        // Every chunk lands at a known offset: copy them into place in parallel
+        std::vector<size_t> offsets(order.size());
+        for (size_t k = 1; k < order.size(); ++k) offsets[k] = offsets[k - 1] + chunks[order[k - 1]].size();
+
+        bars.resize(total);
+        auto place = [&](size_t k) {
+            copyColumns(chunks[order[k]], bars, offsets[k]);
+            chunks[order[k]] = BarColumns();
+        };
+        if (pool) {
+            pool->parallelFor(order.size(), place);
+        }
+        else {
+            for (size_t k = 0; k < order.size(); ++k) place(k);
+        }
+    }
+    else {
+        // Overlapping ranges: concatenate in priority order, then sort with later rows winning
+        bars.reserve(total);
+        for (auto& chunk : chunks) {
+            appendColumns(chunk, bars);
+            chunk = BarColumns();
+        }
+        normalize(bars);
+    }
+    chunks.clear();
+    rebuildIndex();
+}
+
+// ---------------------  Index and Range Queries  -------------------------------------------
+
+// Rebuild the per-day offset table and adjustment factors after the bars changed
+void DataModule::rebuildIndex() {
+    // Dividend factors depend on the closes before their ex-dates
+    adjustments = corporateActions.factors(BarView(bars));
+
+    dayNumbers.clear();
+    dayOffsets.clear();
+    const auto& timestamps = bars.timestamps;
+    for (size_t i = 0; i < timestamps.size();) {
+        // Bars are sorted, so every day is one contiguous run: find its end by
+        // binary search instead of visiting each bar
+        const int64_t day = TimeUtils::dayOf(timestamps[i]);
+        dayNumbers.push_back(day);
+        dayOffsets.push_back(i);
+        i = std::lower_bound(timestamps.begin() + i, timestamps.end(), (day + 1) * 86400) - timestamps.begin();
+    }
+    dayOffsets.push_back(timestamps.size());
+}
+
+void DataModule::setCorporateActions(const CorporateActions& actions) {
+    adjustments = actions.factors(BarView(bars));
+    corporateActions = actions;
+}
+
+// Run the bar checks (and gap filling, if enabled) on the merged series
+void DataModule::finishValidation() {
+    validator.checkBars(BarView(bars), report);
+    if (validator.getOptions().forwardFill && validator.forwardFill(bars, report) > 0) {
+        rebuildIndex();
+    }
+}
+
+// Bars with start <= timestamp < end
+BarView DataModule::range(int64_t start, int64_t end) const {
+    const auto& timestamps = bars.timestamps;
+    const size_t first = std::lower_bound(timestamps.begin(), timestamps.end(), start) - timestamps.begin();
+    const size_t last = end > start
+        ? std::lower_bound(timestamps.begin() + first, timestamps.end(), end) - timestamps.begin()
+        : first;
+    return BarView(bars, first, last - first);
+}
+
+BarView DataModule::range(const std::string& start, const std::string& end) const {
+    int64_t startSeconds, endSeconds;
+    if (!TimeUtils::parseTimestamp(start, startSeconds)) throw std::invalid_argument("Invalid start timestamp: " + start);
+    if (!TimeUtils::parseTimestamp(end, endSeconds)) throw std::invalid_argument("Invalid end timestamp: " + end);
+    return range(startSeconds, endSeconds);
+}
+
+// Bars of `count` consecutive days starting at day `first`
+BarView DataModule::days(size_t first, size_t count) const {
+    first = std::min(first, dayNumbers.size());
+    count = std::min(count, dayNumbers.size() - first);
+    if (count == 0) return BarView();
+    return BarView(bars, dayOffsets[first], dayOffsets[first + count] - dayOffsets[first]);
+}
+
+// Bars inside `window` on each day of the range, one view per day
+std::vector<BarView> DataModule::sessions(int64_t start, int64_t end, const SessionWindow& window) const {
+    std::vector<BarView> result;
+    if (end <= start) return result;
+
+    const size_t firstDay = std::lower_bound(dayNumbers.begin(), dayNumbers.end(), TimeUtils::dayOf(start)) - dayNumbers.begin();
+    const auto& timestamps = bars.timestamps;
+    for (size_t d = firstDay; d < dayNumbers.size(); ++d) {
+        const int64_t midnight = dayNumbers[d] * 86400;
+        if (midnight >= end) break;
+        const int64_t from = std::max(start, midnight + window.startMinute * 60);
+        const int64_t to = std::min(end, midnight + window.endMinute * 60);
+        if (to <= from) continue;
+
+        // Binary search within the day only
+        const auto dayBegin = timestamps.begin() + dayOffsets[d];
+        const auto dayEnd = timestamps.begin() + dayOffsets[d + 1];
+        const size_t first = std::lower_bound(dayBegin, dayEnd, from) - timestamps.begin();
+        const size_t last = std::lower_bound(timestamps.begin() + first, dayEnd, to) - timestamps.begin();
+        if (last > first) result.emplace_back(bars, first, last - first);
+    }
+    return result;
+}
+
+// Rolling walk-forward folds over whole days
+std::vector<WalkForwardSplit> DataModule::walkForward(size_t trainDays, size_t testDays, size_t stepDays) const {
+    if (trainDays == 0 || testDays == 0) throw std::invalid_argument("Walk-forward periods must be positive.");
+    if (stepDays == 0) stepDays = testDays;
+
+    std::vector<WalkForwardSplit> splits;
+    for (size_t first = 0; first + trainDays + testDays <= dayNumbers.size(); first += stepDays) {
+        splits.push_back({ days(first, trainDays), days(first + trainDays, testDays) });
+    }
+    return splits;
+}
+
+// ---------------------  Binary Cache  -------------------------------------------
+
+// Function to load time series data from a binary bar file
+bool DataModule::loadTimeSeriesBinary(const std::string& filePath) {
+    BT_PROFILE_SCOPE(Load);
+    report = ValidationReport();
+    BarColumns chunk;
+    try {
+        BarFileReader reader(filePath);
+        chunk.reserve(reader.getHeader().barCount);
+        BarColumns block;
+        while (reader.readBlock(block)) {
+            appendColumns(block, chunk);
+        }
+    }
+    catch (const std::exception& ex) {
+        std::cerr << "Failed to load binary file: " << filePath << " -> " << ex.what() << std::endl;
+        return false;
+    }
+
+    validator.checkOrder(chunk, report);
+    report.duplicates += normalize(chunk);
+    std::vector<BarColumns> chunks;
+    chunks.push_back(std::move(chunk));
+    mergeChunks(chunks, nullptr);
+    finishValidation();
+    return true;
+}
+
+// Function to save the loaded time series data as a binary bar file
+bool DataModule::saveTimeSeriesBinary(const std::string& filePath, const std::string& symbol,
+                                      BarCompression compression) const {
+    try {
+        BarFileWriter writer(filePath, symbol, BarFileWriter::DefaultBlockBars, compression);
+        writer.write(bars);
+        writer.close();
+    }
+    catch (const std::exception& ex) {
+        std::cerr << "Failed to save binary file: " << filePath << " -> " << ex.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ---------------------  Output  -------------------------------------------
+
+// Function to print time series data
+void DataModule::printTimeSeriesData() const {
+    for (size_t i = 0; i < bars.size(); ++i) {
+        std::cout << TimeUtils::toString(bars.timestamps[i]) << " -> "
+            << "Open: " << bars.open[i] << ", "
+            << "High: " << bars.high[i] << ", "
+            << "Low: " << bars.low[i] << ", "
+            << "Close: " << bars.close[i] << ", "
+            << "Volume: " << bars.volume[i] << std::endl;
+    }
+}
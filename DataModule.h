@@ -1,108 +1,156 @@
 #ifndef DATA_MODULE_H
 #define DATA_MODULE_H
 
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <vector>
+#include "BarFile.h"
+#include "CorporateActions.h"
+#include "DataValidator.h"
+#include "TimeSeries.h"
+#include <cstddef>
 #include <string>
-#include <unordered_map>
-#include <map>
-#include <stdexcept>
-
-struct TimeSeriesData {
-    double open;
-    double high;
-    double low;
-    double close;
-    int volume;
-
-    // Convert to a market data format suitable for portfolio updates
-    std::unordered_map<std::string, double> toMarketData() const {
-        return {
-            {"Open", open},
-            {"High", high},
-            {"Low", low},
-            {"Close", close}
-        };
-    }
+#include <vector>
+
+class ThreadPool;
+
+// Outcome of loading one file in a multi-file load
+struct FileLoadResult {
+    std::string path;
+    size_t rows = 0;           // Bars parsed successfully
+    size_t malformedRows = 0;  // Rows skipped because they could not be parsed
+    std::string error;         // First error seen (file-level failure or malformed row)
+
+    bool ok() const { return error.empty(); } // No failure and no malformed rows
+};
+
+// Trading hours within a day as minutes after midnight, [startMinute, endMinute)
+struct SessionWindow {
+    int startMinute = 0;
+    int endMinute = 24 * 60;
 };
 
+// One walk-forward fold: fit on `train`, then evaluate on the `test` days that follow it
+struct WalkForwardSplit {
+    BarView train;
+    BarView test;
+};
+
+// Holds one symbol's bars in columnar form (BarColumns), sorted by timestamp
+// with unique timestamps. When loads overlap, later bars replace earlier ones
+// with the same timestamp.
+//
+// Sub-periods are served as zero-copy BarViews: timestamp ranges by binary
+// search and whole days from a per-day offset table built at load time, so
+// date-bounded runs, session filters and walk-forward splits never touch bars
+// outside their window. Views are invalidated by the next load.
+//
+// Every load is validated (see DataValidator.h): malformed rows are
+// summarized on std::cerr and the full outcome is kept in a report, so dirty
+// files no longer flood the output with one line per bad row.
+//
+// Prices are stored as loaded. With corporate actions set, adjusted() returns
+// back-adjusted views over the same raw storage (see CorporateActions.h): the
+// adjustment is a factor carried by each view, not a second copy of the data.
 class DataModule {
 public:
-    // Function to load and parse time series data from CSV
-    bool loadTimeSeriesCSV(const std::string& filePath) {
-        std::ifstream file(filePath);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open CSV file: " << filePath << std::endl;
-            return false;
-        }
-
-        std::string line;
-        int lineNumber = 0;
-        while (std::getline(file, line)) {
-            lineNumber++;
-            if (lineNumber == 1) {
-                // Skip header line if present
-                continue;
-            }
-
-            std::istringstream stream(line);
-            std::string timestamp, open, high, low, close, volume;
-
-            try {
-                // Parse each column (comma-separated)
-                std::getline(stream, timestamp, ',');
-                std::getline(stream, open, ',');
-                std::getline(stream, high, ',');
-                std::getline(stream, low, ',');
-                std::getline(stream, close, ',');
-                std::getline(stream, volume, ',');
-
-                // Validate and convert
-                if (timestamp.empty() || open.empty() || high.empty() || low.empty() || close.empty() || volume.empty()) {
-                    std::cerr << "Error: Malformed line (" << lineNumber << ") -> " << line << std::endl;
-                    continue;
-                }
-
-                TimeSeriesData tsData = {
-                    std::stod(open),
-                    std::stod(high),
-                    std::stod(low),
-                    std::stod(close),
-                    std::stoi(volume)
-                };
-
-                timeSeriesData[timestamp] = tsData;
-            }
-            catch (const std::exception& ex) {
-                std::cerr << "Error parsing line (" << lineNumber << "): " << line << " -> " << ex.what() << std::endl;
-            }
-        }
-
-        file.close();
-        return true;
-    }
+    // Validation settings for subsequent loads (outlier threshold, gap filling, ...)
+    void setValidationOptions(const ValidationOptions& options) { validator = DataValidator(options); }
+
+    // Validation outcome of the most recent load. Order and duplicate checks
+    // cover the rows of that load; bar checks cover every bar now held.
+    const ValidationReport& getValidationReport() const { return report; }
+
+    // Function to load and parse time series data from CSV. Gzip-compressed
+    // files are detected and decompressed on a separate thread while parsing.
+    bool loadTimeSeriesCSV(const std::string& filePath);
+
+    // Load every file in `directory` whose name matches `pattern` (* and ?
+    // wildcards) in parallel on `threads` workers (0 = hardware concurrency).
+    // Files are parsed into per-file column chunks and then placed into the
+    // combined series; non-overlapping chunks are copied straight into their
+    // final position. Returns one result per matching file, in name order.
+    std::vector<FileLoadResult> loadDirectoryCSV(const std::string& directory, const std::string& pattern = "*.csv",
+                                                 size_t threads = 0);
+
+    // Function to load time series data from a binary bar file (see BarFile.h)
+    bool loadTimeSeriesBinary(const std::string& filePath);
+
+    // Function to save the loaded time series data as a binary bar file
+    bool saveTimeSeriesBinary(const std::string& filePath, const std::string& symbol,
+                              BarCompression compression = BarCompression::None) const;
 
     // Function to print time series data
-    void printTimeSeriesData() const {
-        for (const auto& [timestamp, data] : timeSeriesData) {
-            std::cout << timestamp << " -> "
-                << "Open: " << data.open << ", "
-                << "High: " << data.high << ", "
-                << "Low: " << data.low << ", "
-                << "Close: " << data.close << ", "
-                << "Volume: " << data.volume << std::endl;
-        }
-    }
+    void printTimeSeriesData() const;
 
     // Getter function to retrieve the time series data
-    const std::map<std::string, TimeSeriesData>& getTimeSeriesData() const {
-        return timeSeriesData;
-    }
+    const BarColumns& getBars() const { return bars; }
+
+    // Number of bars loaded
+    size_t size() const { return bars.size(); }
+
+    // View of every bar
+    BarView view() const { return BarView(bars); }
+
+    // Bars with start <= timestamp < end (epoch seconds), found in O(log n)
+    BarView range(int64_t start, int64_t end) const;
+
+    // Same with timestamps as text ("YYYY-MM-DD[ HH:MM[:SS]]"); throws
+    // std::invalid_argument if either cannot be parsed
+    BarView range(const std::string& start, const std::string& end) const;
+
+    // Number of calendar days (sessions) with at least one bar
+    size_t dayCount() const { return dayNumbers.size(); }
+
+    // Day `index` as days since 1970-01-01
+    int64_t dayNumber(size_t index) const { return dayNumbers[index]; }
+
+    // Bars of `count` consecutive days starting at day `first`
+    BarView days(size_t first, size_t count = 1) const;
+
+    // Bars inside `window` on each day with start <= timestamp < end, one view
+    // per day (days without bars in the window are skipped)
+    std::vector<BarView> sessions(int64_t start, int64_t end, const SessionWindow& window) const;
+
+    // Splits and dividends to back-adjust with, replacing any previous ones.
+    // Throws std::invalid_argument if a dividend is not below the close it is
+    // measured against (as do later loads that make it so).
+    void setCorporateActions(const CorporateActions& actions);
+    const CorporateActions& getCorporateActions() const { return corporateActions; }
+
+    // Back-adjusted form of `bars` (a view into this module's bars): one view
+    // per run of bars sharing an adjustment factor, ready for the engine's
+    // segment overload. Without corporate actions this is just { bars }.
+    std::vector<BarView> adjusted(const BarView& bars) const { return CorporateActions::adjust(bars, adjustments); }
+    std::vector<BarView> adjusted() const { return adjusted(view()); }
+
+    // Rolling walk-forward folds of `trainDays` followed by `testDays`, advancing
+    // by `stepDays` (0 = testDays) until the test period would run past the data
+    std::vector<WalkForwardSplit> walkForward(size_t trainDays, size_t testDays, size_t stepDays = 0) const;
 
 private:
-    std::map<std::string, TimeSeriesData> timeSeriesData; // Maps timestamp to time series data
+    // Parse one CSV file into columns. Malformed rows are reported through
+    // `result`; if `echoErrors` is set they are also printed to std::cerr.
+    static bool parseCSV(const std::string& filePath, BarColumns& out, FileLoadResult& result, bool echoErrors);
+
+    // Sort by timestamp and drop duplicates, keeping the last occurrence.
+    // Returns the number of rows dropped.
+    static size_t normalize(BarColumns& columns);
+
+    // Merge normalized chunks (in priority order, later wins) into the stored series.
+    // `pool` parallelizes the final copy and may be null.
+    void mergeChunks(std::vector<BarColumns>& chunks, ThreadPool* pool);
+
+    // Rebuild the per-day offset table and adjustment factors after the bars changed
+    void rebuildIndex();
+
+    // Run the bar checks (and gap filling, if enabled) on the merged series
+    void finishValidation();
+
+    BarColumns bars; // Sorted, unique-timestamp bar columns
+    std::vector<int64_t> dayNumbers; // Distinct days with bars, ascending
+    std::vector<size_t> dayOffsets;  // First bar of each day, then bars.size()
+    CorporateActions corporateActions;
+    std::vector<AdjustmentFactor> adjustments; // corporateActions resolved against bars
+    DataValidator validator;
+    ValidationReport report;
 };
 
 #endif // DATA_MODULE_H
@@ -0,0 +1,300 @@
+#include "DataValidator.h"
+#include "TimeUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BT_VALIDATOR_SSE2 1
+#else
+#define BT_VALIDATOR_SSE2 0
+#endif
+
+namespace {
+
+constexpr size_t InferenceBars = 10000;
+
+// ---------------------  Column Checks  -------------------------------------------
+//
+// Each check counts matching rows. Compilers do not vectorize a floating-point
+// compare feeding an integer count at the baseline x86-64 target, so the SSE2
+// versions compare two rows at a time and accumulate the all-ones lane masks
+// (-1 per match) into 64-bit counters. Other targets use the scalar loops.
+
+#if BT_VALIDATOR_SSE2
+inline size_t horizontalCount(__m128i counts) {
+    alignas(16) int64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), counts);
+    return static_cast<size_t>(-(lanes[0] + lanes[1]));
+}
+#endif
+
+struct PriceCounts {
+    size_t invalid = 0;       // Any price not > 0 (includes NaN)
+    size_t inconsistent = 0;  // high < low, or open/close outside [low, high]
+    size_t outliers = 0;      // |close - previous close| > maxMove * previous close
+};
+
+// All price checks in one pass, so each price column is read once
+PriceCounts countPriceIssues(const double* o, const double* h, const double* l, const double* c, size_t n, double maxMove) {
+    PriceCounts counts;
+    if (n == 0) return counts;
+    counts.invalid = !(o[0] > 0) | !(h[0] > 0) | !(l[0] > 0) | !(c[0] > 0);
+    counts.inconsistent = (h[0] < l[0]) | (o[0] > h[0]) | (o[0] < l[0]) | (c[0] > h[0]) | (c[0] < l[0]);
+    size_t i = 1;
+#if BT_VALIDATOR_SSE2
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d limit = _mm_set1_pd(maxMove);
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    __m128i invalid = _mm_setzero_si128();
+    __m128i inconsistent = _mm_setzero_si128();
+    __m128i outliers = _mm_setzero_si128();
+    for (; i + 2 <= n; i += 2) {
+        const __m128d open = _mm_loadu_pd(o + i);
+        const __m128d high = _mm_loadu_pd(h + i);
+        const __m128d low = _mm_loadu_pd(l + i);
+        const __m128d close = _mm_loadu_pd(c + i);
+        const __m128d previous = _mm_loadu_pd(c + i - 1);
+
+        const __m128d nonPositive = _mm_or_pd(_mm_or_pd(_mm_cmpngt_pd(open, zero), _mm_cmpngt_pd(high, zero)),
+            _mm_or_pd(_mm_cmpngt_pd(low, zero), _mm_cmpngt_pd(close, zero)));
+        const __m128d outside = _mm_or_pd(_mm_or_pd(_mm_cmplt_pd(high, low), _mm_cmpgt_pd(open, high)),
+            _mm_or_pd(_mm_or_pd(_mm_cmplt_pd(open, low), _mm_cmpgt_pd(close, high)), _mm_cmplt_pd(close, low)));
+        const __m128d move = _mm_andnot_pd(signMask, _mm_sub_pd(close, previous));
+
+        invalid = _mm_add_epi64(invalid, _mm_castpd_si128(nonPositive));
+        inconsistent = _mm_add_epi64(inconsistent, _mm_castpd_si128(outside));
+        outliers = _mm_add_epi64(outliers, _mm_castpd_si128(_mm_cmpgt_pd(move, _mm_mul_pd(limit, previous))));
+    }
+    counts.invalid += horizontalCount(invalid);
+    counts.inconsistent += horizontalCount(inconsistent);
+    counts.outliers += horizontalCount(outliers);
+#endif
+    for (; i < n; ++i) {
+        counts.invalid += !(o[i] > 0) | !(h[i] > 0) | !(l[i] > 0) | !(c[i] > 0);
+        counts.inconsistent += (h[i] < l[i]) | (o[i] > h[i]) | (o[i] < l[i]) | (c[i] > h[i]) | (c[i] < l[i]);
+        counts.outliers += std::fabs(c[i] - c[i - 1]) > maxMove * c[i - 1];
+    }
+    return counts;
+}
+
+// Rows with a negative value
+size_t countNegative(const int64_t* values, size_t n) {
+    size_t i = 0;
+    size_t count = 0;
+#if BT_VALIDATOR_SSE2
+    // SSE2 has no 64-bit compare: shift the sign bit down and subtract it as a -1 mask would be
+    __m128i counts = _mm_setzero_si128();
+    for (; i + 2 <= n; i += 2) {
+        const __m128i sign = _mm_srli_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)), 63);
+        counts = _mm_sub_epi64(counts, sign);
+    }
+    count = horizontalCount(counts);
+#endif
+    for (; i < n; ++i) count += values[i] < 0;
+    return count;
+}
+
+// Rows whose value is below the previous row's (rows 1..n-1)
+size_t countDecreasing(const int64_t* values, size_t n) {
+    size_t i = 1;
+    size_t count = 0;
+#if BT_VALIDATOR_SSE2
+    __m128i counts = _mm_setzero_si128();
+    for (; i + 2 <= n; i += 2) {
+        const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        const __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i - 1));
+        counts = _mm_sub_epi64(counts, _mm_srli_epi64(_mm_sub_epi64(current, previous), 63));
+    }
+    count = horizontalCount(counts);
+#endif
+    for (; i < n; ++i) count += values[i] < values[i - 1];
+    return count;
+}
+
+// Whether the bar at `i` (i > 0) opens a gap after the previous bar
+inline bool isGap(const int64_t* timestamps, size_t i, int64_t barSeconds, bool intradayOnly) {
+    const int64_t delta = timestamps[i] - timestamps[i - 1];
+    if (delta <= barSeconds) return false;
+    return !intradayOnly || TimeUtils::dayOf(timestamps[i]) == TimeUtils::dayOf(timestamps[i - 1]);
+}
+
+} // namespace
+
+// ---------------------  ValidationReport  -------------------------------------------
+
+bool ValidationReport::clean() const {
+    return malformedRows == 0 && nonMonotonic == 0 && duplicates == 0 && invalidPrices == 0
+        && inconsistentOHLC == 0 && negativeVolumes == 0 && outliers == 0 && missingBars <= filledBars;
+}
+
+void ValidationReport::merge(const ValidationReport& other, size_t maxExamples) {
+    bars += other.bars;
+    malformedRows += other.malformedRows;
+    nonMonotonic += other.nonMonotonic;
+    duplicates += other.duplicates;
+    invalidPrices += other.invalidPrices;
+    inconsistentOHLC += other.inconsistentOHLC;
+    negativeVolumes += other.negativeVolumes;
+    outliers += other.outliers;
+    gaps += other.gaps;
+    missingBars += other.missingBars;
+    filledBars += other.filledBars;
+    if (barSeconds == 0) barSeconds = other.barSeconds;
+    for (const auto& example : other.examples) {
+        if (examples.size() >= maxExamples) break;
+        examples.push_back(example);
+    }
+}
+
+void ValidationReport::print(std::ostream& out, const std::string& source) const {
+    out << "Data validation for " << source << ": " << bars << " bars";
+    if (barSeconds > 0) out << " at " << barSeconds << "s";
+    if (clean() && gaps == 0) {
+        out << ", no issues" << std::endl;
+        return;
+    }
+    out << std::endl;
+
+    auto line = [&out](const char* label, size_t count) {
+        if (count > 0) out << "  " << label << count << std::endl;
+    };
+    line("Malformed rows:        ", malformedRows);
+    line("Out-of-order rows:     ", nonMonotonic);
+    line("Duplicate timestamps:  ", duplicates);
+    line("Invalid prices:        ", invalidPrices);
+    line("Inconsistent OHLC:     ", inconsistentOHLC);
+    line("Negative volumes:      ", negativeVolumes);
+    line("Outlier moves:         ", outliers);
+    line("Gaps:                  ", gaps);
+    line("Missing bars:          ", missingBars);
+    line("Forward-filled bars:   ", filledBars);
+    if (!examples.empty()) {
+        out << "  Examples:" << std::endl;
+        for (const auto& example : examples) out << "    " << example << std::endl;
+    }
+}
+
+// ---------------------  DataValidator  -------------------------------------------
+
+// Checks that need the rows in load order
+void DataValidator::checkOrder(const BarColumns& raw, ValidationReport& report) const {
+    const int64_t* ts = raw.timestamps.data();
+    const size_t n = raw.size();
+
+    const size_t decreasing = n > 1 ? countDecreasing(ts, n) : 0;
+    report.nonMonotonic += decreasing;
+
+    if (decreasing == 0) return;
+    for (size_t i = 1; i < n && report.examples.size() < options.maxExamples; ++i) {
+        if (ts[i] < ts[i - 1]) addExample(report, ts[i], "timestamp earlier than the previous row");
+    }
+}
+
+// Checks on sorted bars with unique timestamps
+void DataValidator::checkBars(const BarView& bars, ValidationReport& report) const {
+    const size_t n = bars.size();
+    const int64_t* ts = bars.timestamps;
+    const double* o = bars.open;
+    const double* h = bars.high;
+    const double* l = bars.low;
+    const double* c = bars.close;
+    const int64_t* v = bars.volume;
+    report.bars += n;
+
+    const PriceCounts prices = countPriceIssues(o, h, l, c, n, options.maxMove);
+    const size_t negative = countNegative(v, n);
+
+    // Gaps: the day check only runs for the rare pairs further apart than one bar
+    const int64_t barSeconds = options.barSeconds > 0 ? options.barSeconds : inferBarSeconds(bars);
+    if (report.barSeconds == 0) report.barSeconds = barSeconds;
+    size_t gaps = 0, missing = 0;
+    if (barSeconds > 0) {
+        for (size_t i = 1; i < n; ++i) {
+            if (isGap(ts, i, barSeconds, options.intradayGapsOnly)) {
+                ++gaps;
+                missing += static_cast<size_t>((ts[i] - ts[i - 1] - 1) / barSeconds);
+            }
+        }
+    }
+
+    report.invalidPrices += prices.invalid;
+    report.inconsistentOHLC += prices.inconsistent;
+    report.negativeVolumes += negative;
+    report.outliers += prices.outliers;
+    report.gaps += gaps;
+    report.missingBars += missing;
+
+    // Only dirty data pays for a second, row-by-row pass to record examples
+    if (prices.invalid + prices.inconsistent + negative + prices.outliers + gaps == 0) return;
+    for (size_t i = 0; i < n && report.examples.size() < options.maxExamples; ++i) {
+        if (!(o[i] > 0 && h[i] > 0 && l[i] > 0 && c[i] > 0)) addExample(report, ts[i], "non-positive or NaN price");
+        else if (h[i] < l[i] || o[i] > h[i] || o[i] < l[i] || c[i] > h[i] || c[i] < l[i]) addExample(report, ts[i], "inconsistent OHLC");
+        else if (v[i] < 0) addExample(report, ts[i], "negative volume");
+        else if (i > 0 && std::fabs(c[i] - c[i - 1]) > options.maxMove * c[i - 1]) addExample(report, ts[i], "outlier move");
+        else if (i > 0 && barSeconds > 0 && isGap(ts, i, barSeconds, options.intradayGapsOnly)) addExample(report, ts[i], "gap before this bar");
+    }
+}
+
+// Insert the missing bars of intraday gaps
+size_t DataValidator::forwardFill(BarColumns& bars, ValidationReport& report) const {
+    const size_t n = bars.size();
+    const int64_t barSeconds = options.barSeconds > 0 ? options.barSeconds : inferBarSeconds(BarView(bars));
+    if (barSeconds <= 0 || n < 2) return 0;
+
+    const int64_t* ts = bars.timestamps.data();
+    size_t missing = 0;
+    for (size_t i = 1; i < n; ++i) {
+        if (isGap(ts, i, barSeconds, options.intradayGapsOnly)) missing += static_cast<size_t>((ts[i] - ts[i - 1] - 1) / barSeconds);
+    }
+    if (missing == 0) return 0;
+
+    BarColumns filled;
+    filled.reserve(n + missing);
+    for (size_t i = 0; i < n; ++i) {
+        if (i > 0 && isGap(ts, i, barSeconds, options.intradayGapsOnly)) {
+            const double price = bars.close[i - 1];
+            for (int64_t t = ts[i - 1] + barSeconds; t < ts[i]; t += barSeconds) {
+                filled.timestamps.push_back(t);
+                filled.open.push_back(price);
+                filled.high.push_back(price);
+                filled.low.push_back(price);
+                filled.close.push_back(price);
+                filled.volume.push_back(0);
+            }
+        }
+        filled.timestamps.push_back(ts[i]);
+        filled.open.push_back(bars.open[i]);
+        filled.high.push_back(bars.high[i]);
+        filled.low.push_back(bars.low[i]);
+        filled.close.push_back(bars.close[i]);
+        filled.volume.push_back(bars.volume[i]);
+    }
+    bars = std::move(filled);
+    report.filledBars += missing;
+    return missing;
+}
+
+// Most common spacing between consecutive bars
+int64_t DataValidator::inferBarSeconds(const BarView& bars) {
+    const size_t n = std::min(bars.size(), InferenceBars);
+    std::unordered_map<int64_t, size_t> counts;
+    int64_t best = 0;
+    size_t bestCount = 0;
+    for (size_t i = 1; i < n; ++i) {
+        const int64_t delta = bars.timestamps[i] - bars.timestamps[i - 1];
+        if (delta <= 0) continue;
+        const size_t count = ++counts[delta];
+        if (count > bestCount || (count == bestCount && delta < best)) {
+            best = delta;
+            bestCount = count;
+        }
+    }
+    return best;
+}
+
+void DataValidator::addExample(ValidationReport& report, int64_t timestamp, const char* issue) const {
+    if (report.examples.size() >= options.maxExamples) return;
+    report.examples.push_back(TimeUtils::toString(timestamp) + ": " + issue);
+}
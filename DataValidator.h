@@ -0,0 +1,73 @@
+#pragma once
+#include "TimeSeries.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// ---------------------  Data Validation  -------------------------------------------
+//
+// Data quality checks run by DataModule on every load. Each check is a
+// branch-free counting pass over the columns (SSE2 where available); rows are
+// only revisited one by one (to record a few examples) when a check
+// actually found something. The outcome is one summary report per load
+// instead of a line per bad row.
+
+struct ValidationOptions {
+    int64_t barSeconds = 0;        // Expected bar interval; 0 infers the most common spacing
+    double maxMove = 0.25;         // Close-to-close relative move above which a bar is an outlier
+    bool intradayGapsOnly = true;  // Only count missing bars between bars of the same day
+    bool forwardFill = false;      // Insert missing intraday bars carrying the previous close
+    size_t maxExamples = 5;        // Example rows kept in the report
+};
+
+struct ValidationReport {
+    size_t bars = 0;              // Bars checked (after sorting and de-duplication)
+    size_t malformedRows = 0;     // Rows the parser rejected
+    size_t nonMonotonic = 0;      // Rows with an earlier timestamp than the row before, as loaded
+    size_t duplicates = 0;        // Rows dropped because a later row had the same timestamp
+    size_t invalidPrices = 0;     // Non-positive or NaN prices
+    size_t inconsistentOHLC = 0;  // high < low, or open/close outside [low, high]
+    size_t negativeVolumes = 0;
+    size_t outliers = 0;          // Close moved more than maxMove from the previous close
+    size_t gaps = 0;              // Runs of missing bars
+    size_t missingBars = 0;       // Bars missing inside those gaps
+    size_t filledBars = 0;        // Bars inserted by forward-filling
+    int64_t barSeconds = 0;       // Bar interval used for the gap check
+    std::vector<std::string> examples;
+
+    // No issues besides gaps that were forward-filled
+    bool clean() const;
+
+    // Fold in the counts of another report (examples are appended up to `maxExamples`)
+    void merge(const ValidationReport& other, size_t maxExamples);
+
+    // One summary block, naming `source` (a file path, for instance)
+    void print(std::ostream& out, const std::string& source) const;
+};
+
+class DataValidator {
+public:
+    explicit DataValidator(const ValidationOptions& options = ValidationOptions()) : options(options) {}
+
+    const ValidationOptions& getOptions() const { return options; }
+
+    // Checks that need the rows in load order, before sorting and de-duplication
+    void checkOrder(const BarColumns& raw, ValidationReport& report) const;
+
+    // Checks on sorted bars with unique timestamps
+    void checkBars(const BarView& bars, ValidationReport& report) const;
+
+    // Insert the missing bars of intraday gaps, with open/high/low/close set to
+    // the previous close and zero volume. Returns the number of bars inserted.
+    size_t forwardFill(BarColumns& bars, ValidationReport& report) const;
+
+    // Most common spacing between consecutive bars (checks the first 10000 bars)
+    static int64_t inferBarSeconds(const BarView& bars);
+
+private:
+    void addExample(ValidationReport& report, int64_t timestamp, const char* issue) const;
+
+    ValidationOptions options;
+};
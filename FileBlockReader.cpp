@@ -0,0 +1,72 @@
+#include "FileBlockReader.h"
+#include "Gzip.h"
+#include <stdexcept>
+#include <utility>
+
+FileBlockReader::FileBlockReader(const std::string& path, size_t blockBytes)
+    : file(path, std::ios::binary), blockBytes(blockBytes), compressed(Gzip::isGzipFile(path)) {
+    if (!file.is_open()) throw std::runtime_error("Failed to open file: " + path);
+    if (blockBytes == 0) throw std::invalid_argument("Block size must be positive.");
+    if (compressed) producer = std::thread([this]() { decompress(); });
+}
+
+FileBlockReader::~FileBlockReader() {
+    if (!producer.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    producer.join();
+}
+
+// Decompression thread: inflate into staging, then hand it over once the caller took the previous block
+void FileBlockReader::decompress() {
+    Gzip::Reader reader(file);
+    for (;;) {
+        size_t count = 0;
+        std::exception_ptr failure;
+        try {
+            staging.resize(blockBytes);
+            count = reader.read(staging.data(), staging.size());
+            staging.resize(count);
+        }
+        catch (...) {
+            failure = std::current_exception();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]() { return !hasReady || stopping; });
+        if (stopping) return;
+        if (failure || count == 0) {
+            error = failure;
+            exhausted = true;
+            changed.notify_all();
+            return;
+        }
+        std::swap(ready, staging);
+        hasReady = true;
+        changed.notify_all();
+    }
+}
+
+bool FileBlockReader::next(std::vector<char>& block) {
+    if (!compressed) {
+        block.resize(blockBytes);
+        file.read(block.data(), static_cast<std::streamsize>(block.size()));
+        block.resize(static_cast<size_t>(file.gcount()));
+        return !block.empty();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]() { return hasReady || exhausted; });
+    if (hasReady) {
+        std::swap(block, ready);
+        hasReady = false;
+        changed.notify_all();
+        return true;
+    }
+    if (error) std::rethrow_exception(error);
+    block.clear();
+    return false;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ---------------------  File Block Reader  -------------------------------------------
+//
+// Reads a file as a sequence of byte blocks for the incremental CSV parser.
+// Gzip files (recognized by their magic bytes, not their extension) are
+// decompressed transparently: a background thread inflates the next block
+// while the caller parses the current one, using the same staging/ready
+// double buffer as ReadAheadSource. Plain files are read on the caller's thread.
+class FileBlockReader {
+public:
+    static constexpr size_t DefaultBlockBytes = 1 << 20;
+
+    // Throws std::runtime_error if the file cannot be opened
+    explicit FileBlockReader(const std::string& path, size_t blockBytes = DefaultBlockBytes);
+    ~FileBlockReader();
+
+    FileBlockReader(const FileBlockReader&) = delete;
+    FileBlockReader& operator=(const FileBlockReader&) = delete;
+
+    // Replace the contents of `block` with the next bytes of (decompressed)
+    // data. Returns false at the end of the file. Decompression errors are
+    // rethrown here as std::runtime_error.
+    bool next(std::vector<char>& block);
+
+    bool isCompressed() const { return compressed; }
+
+private:
+    void decompress();
+
+    std::ifstream file;
+    size_t blockBytes;
+    bool compressed;
+
+    std::vector<char> staging; // Being filled by the decompression thread
+    std::vector<char> ready;   // Completed, waiting for the caller
+    bool hasReady = false;
+    bool exhausted = false;
+    bool stopping = false;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread producer;
+};
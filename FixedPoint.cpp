@@ -0,0 +1,71 @@
+#include "FixedPoint.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+// ---------------------  TickSize  -------------------------------------------
+
+FixedPoint::TickSize::TickSize(double size) {
+    const double micros = size * MicrosPerUnit;
+    tickMicros = std::llround(micros);
+    if (!(size > 0) || tickMicros <= 0 || std::fabs(micros - static_cast<double>(tickMicros)) > 1e-6 * micros) {
+        throw std::invalid_argument("Tick size must be a positive multiple of 0.000001.");
+    }
+    ticksPerUnit = static_cast<double>(MicrosPerUnit) / static_cast<double>(tickMicros);
+}
+
+// ---------------------  TickBars  -------------------------------------------
+
+TickBars::TickBars(const BarView& bars, FixedPoint::TickSize tickSize) : tick(tickSize) {
+    const size_t n = bars.size();
+    timestamps.assign(bars.timestamps, bars.timestamps + n);
+    volume.resize(n);
+    for (size_t i = 0; i < n; ++i) volume[i] = bars.at(i).volume;
+
+    // Convert into 64-bit columns first, then narrow them if the range allows
+    const double* columns[4] = { bars.open, bars.high, bars.low, bars.close };
+    int64_t lowest = 0, highest = 0;
+    for (int c = 0; c < 4; ++c) {
+        wide[c].resize(n);
+        for (size_t i = 0; i < n; ++i) wide[c][i] = tick.toTicks(columns[c][i] * bars.priceFactor);
+        if (n > 0) {
+            const auto [minIt, maxIt] = std::minmax_element(wide[c].begin(), wide[c].end());
+            lowest = std::min(lowest, *minIt);
+            highest = std::max(highest, *maxIt);
+        }
+    }
+
+    compact = lowest >= std::numeric_limits<int32_t>::min() && highest <= std::numeric_limits<int32_t>::max();
+    if (!compact) return;
+    for (int c = 0; c < 4; ++c) {
+        narrow[c].assign(wide[c].begin(), wide[c].end());
+        wide[c] = std::vector<int64_t>();
+    }
+}
+
+TickBar TickBars::at(size_t index) const {
+    if (compact) return { narrow[0][index], narrow[1][index], narrow[2][index], narrow[3][index], volume[index] };
+    return { wide[0][index], wide[1][index], wide[2][index], wide[3][index], volume[index] };
+}
+
+TimeSeriesData TickBars::bar(size_t index) const {
+    const TickBar ticks = at(index);
+    return { tick.toPrice(ticks.open), tick.toPrice(ticks.high), tick.toPrice(ticks.low), tick.toPrice(ticks.close), ticks.volume };
+}
+
+BarColumns TickBars::toColumns() const {
+    BarColumns out;
+    appendColumns(0, size(), out);
+    return out;
+}
+
+void TickBars::appendColumns(size_t begin, size_t end, BarColumns& out) const {
+    end = std::min(end, size());
+    if (begin >= end) return;
+    out.reserve(out.size() + (end - begin));
+    for (size_t i = begin; i < end; ++i) out.push_back(timestamps[i], bar(i));
+}
+
+size_t TickBars::priceBytes() const {
+    return compact ? 4 * narrow[0].size() * sizeof(int32_t) : 4 * wide[0].size() * sizeof(int64_t);
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "TimeSeries.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ---------------------  Fixed-Point Prices  -------------------------------------------
+//
+// Exact price and money arithmetic. Prices are whole numbers of ticks (int64),
+// each symbol having its own tick size, and money amounts are whole numbers of
+// micro-units of currency, so a fill of q shares at p ticks costs exactly
+// q * p * tickMicros. Sums of fills never drift, and a run reproduces its P&L
+// to the last micro-unit whatever the order of accumulation.
+//
+// TickBars keeps a whole series in ticks for runs that hold the bars in
+// memory: BacktestingEngine::runBacktest(const TickBars&, ...) streams it to
+// the engine through a TickBarSource (BarSource.h), expanding one chunk of
+// double columns at a time.
+namespace FixedPoint {
+
+constexpr int64_t MicrosPerUnit = 1000000;
+
+// Money in micro-units of currency (1e-6); int64 covers +-9.2e12 units
+using Money = int64_t;
+
+inline Money toMoney(double amount) { return std::llround(amount * MicrosPerUnit); }
+inline double toDouble(Money amount) { return static_cast<double>(amount) / MicrosPerUnit; }
+
+// Minimum price increment of a symbol, held as a whole number of micro-units
+// (0.01, 0.25, 1/32 and 0.0001 are all exact)
+class TickSize {
+public:
+    // Throws std::invalid_argument unless `size` is a positive whole number of micro-units
+    explicit TickSize(double size = 0.01);
+
+    int64_t micros() const { return tickMicros; }
+    double size() const { return toDouble(tickMicros); }
+
+    // Nearest tick to a price
+    int64_t toTicks(double price) const { return std::llround(price * ticksPerUnit); }
+
+    // Price of a tick count. Dividing by the (usually integral) ticks per unit
+    // gives the same double as parsing the decimal text, e.g. 47253 -> 472.53.
+    double toPrice(int64_t ticks) const { return static_cast<double>(ticks) / ticksPerUnit; }
+
+    // Value of `quantity` units at `ticks`
+    Money value(int64_t ticks, int64_t quantity) const { return ticks * tickMicros * quantity; }
+
+private:
+    int64_t tickMicros;
+    double ticksPerUnit;
+};
+
+} // namespace FixedPoint
+
+// One bar in ticks
+struct TickBar {
+    int64_t open;
+    int64_t high;
+    int64_t low;
+    int64_t close;
+    int64_t volume;
+};
+
+// Bars with prices stored as ticks. When every price of the series fits in 32
+// bits (below 21.4M units at a 0.01 tick) the price columns are int32, half the
+// memory of double columns; otherwise they are int64.
+class TickBars {
+public:
+    TickBars() = default;
+
+    // Round the prices of `bars` (adjusted by the view's factors) to `tick`
+    TickBars(const BarView& bars, FixedPoint::TickSize tick);
+
+    size_t size() const { return timestamps.size(); }
+    bool empty() const { return timestamps.empty(); }
+    bool isCompact() const { return compact; }
+    const FixedPoint::TickSize& getTickSize() const { return tick; }
+
+    int64_t timestamp(size_t index) const { return timestamps[index]; }
+    TickBar at(size_t index) const;
+
+    // Bar in prices, as consumed by strategies
+    TimeSeriesData bar(size_t index) const;
+
+    // Expand back into double columns
+    BarColumns toColumns() const;
+
+    // Append bars [begin, end) to `out` as double columns
+    void appendColumns(size_t begin, size_t end, BarColumns& out) const;
+
+    // Bytes held by the four price columns
+    size_t priceBytes() const;
+
+private:
+    FixedPoint::TickSize tick;
+    bool compact = true;
+    std::vector<int64_t> timestamps;
+    std::vector<int64_t> volume;
+    std::vector<int32_t> narrow[4]; // open, high, low, close when compact
+    std::vector<int64_t> wide[4];   // otherwise
+};
@@ -0,0 +1,84 @@
+#include "FxRates.h"
+#include <limits>
+#include <stdexcept>
+
+FxRateTable::FxRateTable(const std::string& baseCurrency) {
+    if (baseCurrency.empty()) throw std::invalid_argument("Base currency cannot be empty.");
+    codes.push_back(baseCurrency);
+    rates.push_back(1.0);
+    ids.emplace(baseCurrency, 0);
+}
+
+uint16_t FxRateTable::intern(const std::string& currency) {
+    auto it = ids.find(currency);
+    if (it != ids.end()) return it->second;
+    if (currency.empty()) throw std::invalid_argument("Currency code cannot be empty.");
+    if (codes.size() > std::numeric_limits<uint16_t>::max()) throw std::runtime_error("Too many currencies.");
+
+    const uint16_t id = static_cast<uint16_t>(codes.size());
+    codes.push_back(currency);
+    rates.push_back(0.0);
+    ids.emplace(currency, id);
+    return id;
+}
+
+int FxRateTable::find(const std::string& currency) const {
+    auto it = ids.find(currency);
+    return it == ids.end() ? -1 : it->second;
+}
+
+void FxRateTable::setRate(uint16_t id, double rate) {
+    if (id == 0) throw std::invalid_argument("The base currency rate is fixed at 1.");
+    if (!(rate > 0)) throw std::invalid_argument("FX rate must be positive.");
+    rates.at(id) = rate;
+}
+
+void FxRateTable::saveState(SnapshotWriter& out) const {
+    out.write<uint64_t>(codes.size());
+    for (const std::string& code : codes) out.writeString(code);
+    out.writeVector(rates);
+}
+
+void FxRateTable::loadState(SnapshotReader& in) {
+    const uint64_t count = in.read<uint64_t>();
+    if (count == 0 || count > std::numeric_limits<uint16_t>::max() + 1ull) throw std::runtime_error("Corrupt FX rate snapshot.");
+    codes.clear();
+    ids.clear();
+    for (uint64_t id = 0; id < count; ++id) {
+        codes.push_back(in.readString());
+        ids.emplace(codes.back(), static_cast<uint16_t>(id));
+    }
+    in.readVector(rates);
+    if (rates.size() != codes.size()) throw std::runtime_error("Corrupt FX rate snapshot.");
+}
+
+int FxRateTable::onBar(const std::string& pair, double price) {
+    std::optional<FxQuote> implied = quote(pair, price);
+    if (!implied) return -1;
+    const uint16_t id = intern(implied->currency);
+    rates[id] = implied->rate;
+    return id;
+}
+
+// The pair is BASEQUOTE (price = quote units per base unit), with an optional
+// '/', '-' or '_' between the two codes
+std::optional<FxQuote> FxRateTable::quote(const std::string& pair, double price) const {
+    std::string first, second;
+    const size_t separator = pair.find_first_of("/-_");
+    if (separator != std::string::npos) {
+        first = pair.substr(0, separator);
+        second = pair.substr(separator + 1);
+    }
+    else if (pair.size() == 6) {
+        first = pair.substr(0, 3);
+        second = pair.substr(3);
+    }
+    if (first.empty() || second.empty()) throw std::invalid_argument("Malformed currency pair: " + pair);
+    if (!(price > 0)) throw std::invalid_argument("FX rate must be positive.");
+
+    // EURUSD at 1.08 is 1.08 USD per EUR; USDJPY at 150 is 1/150 USD per JPY
+    const std::string& base = getBaseCurrency();
+    if (second == base && first != base) return FxQuote{ first, price };
+    if (first == base && second != base) return FxQuote{ second, 1.0 / price };
+    return std::nullopt;
+}
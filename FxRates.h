@@ -0,0 +1,69 @@
+#pragma once
+#include "Snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ---------------------  FX Rates  -------------------------------------------
+//
+// Conversion factors from each currency to a base currency. Currencies are
+// interned to small ids (the base currency is id 0 with a fixed rate of 1),
+// so a position resolves its currency once and each valuation after that is
+// `local value * rate(id)`: one multiply, with no symbol -> currency -> pair
+// lookups on the mark-to-market path.
+//
+// Rates are base units per unit of the currency (EUR with a USD base: 1.08).
+// An FX bar for a pair such as "EURUSD" or "USD/JPY" updates the leg that is
+// not the base currency; crosses that do not involve the base are ignored.
+
+// Rate of one currency read from an FX bar
+struct FxQuote {
+    std::string currency;
+    double rate; // Base currency units per unit of `currency`
+};
+
+class FxRateTable {
+public:
+    explicit FxRateTable(const std::string& baseCurrency = "USD");
+
+    const std::string& getBaseCurrency() const { return codes[0]; }
+
+    // Id of a currency code, adding it (without a rate) on first use
+    uint16_t intern(const std::string& currency);
+
+    // Id of a known currency, or -1
+    int find(const std::string& currency) const;
+
+    const std::string& code(uint16_t id) const { return codes[id]; }
+    size_t size() const { return codes.size(); }
+
+    // Base units per unit of currency `id` (0 while unknown)
+    double rate(uint16_t id) const { return rates[id]; }
+    bool hasRate(uint16_t id) const { return rates[id] > 0; }
+
+    // Set the rate of a non-base currency; throws std::invalid_argument for
+    // the base currency or a non-positive rate
+    void setRate(uint16_t id, double rate);
+
+    // Apply an FX bar's price for `pair` ("EURUSD", "EUR/USD", "USD-JPY").
+    // Returns the id of the currency updated, or -1 for a cross not involving
+    // the base currency. Throws std::invalid_argument for a malformed pair.
+    int onBar(const std::string& pair, double price);
+
+    // The rate an FX bar implies, without applying it (nothing for a cross)
+    std::optional<FxQuote> quote(const std::string& pair, double price) const;
+
+    // `amount` of currency `from` in currency `to`
+    double convert(double amount, uint16_t from, uint16_t to) const { return amount * rates[from] / rates[to]; }
+
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+
+private:
+    std::vector<std::string> codes;   // By id
+    std::vector<double> rates;        // By id
+    std::unordered_map<std::string, uint16_t> ids;
+};
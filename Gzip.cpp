@@ -0,0 +1,498 @@
+#include "Gzip.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t InputBufferBytes = 256 << 10;
+
+const uint16_t LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+                                  67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                  4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t DistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+                                    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8_t DistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8,
+                                    9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+const uint8_t CodeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// Slicing-by-8 tables for CRC-32 (reflected polynomial 0xEDB88320)
+const std::array<std::array<uint32_t, 256>, 8>& crcTables() {
+    static const auto tables = []() {
+        std::array<std::array<uint32_t, 256>, 8> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (size_t k = 1; k < 8; ++k) t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+        }
+        return t;
+    }();
+    return tables;
+}
+
+// Fixed literal/length code lengths (RFC 1951, 3.2.6)
+void fixedLiteralLengths(uint8_t* lengths) {
+    std::fill(lengths, lengths + 144, uint8_t(8));
+    std::fill(lengths + 144, lengths + 256, uint8_t(9));
+    std::fill(lengths + 256, lengths + 280, uint8_t(7));
+    std::fill(lengths + 280, lengths + 288, uint8_t(8));
+}
+
+uint32_t reverseBits(uint32_t code, int length) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < length; ++i) {
+        reversed = (reversed << 1) | (code & 1);
+        code >>= 1;
+    }
+    return reversed;
+}
+
+// Canonical codes for the given lengths, bit-reversed for LSB-first output
+void canonicalCodes(const uint8_t* lengths, int symbolCount, uint16_t* codes) {
+    uint16_t count[16] = {};
+    for (int i = 0; i < symbolCount; ++i) ++count[lengths[i]];
+    count[0] = 0;
+    uint16_t next[16] = {};
+    for (int length = 1, code = 0; length < 16; ++length) {
+        code = (code + count[length - 1]) << 1;
+        next[length] = static_cast<uint16_t>(code);
+    }
+    for (int i = 0; i < symbolCount; ++i) {
+        if (lengths[i]) codes[i] = static_cast<uint16_t>(reverseBits(next[lengths[i]]++, lengths[i]));
+    }
+}
+
+// LSB-first bit writer appending to a string
+class BitWriter {
+public:
+    explicit BitWriter(std::string& out) : out(out) {}
+
+    void put(uint32_t value, int count) {
+        buffer |= static_cast<uint64_t>(value) << bits;
+        bits += count;
+        while (bits >= 8) {
+            out.push_back(static_cast<char>(buffer & 0xFF));
+            buffer >>= 8;
+            bits -= 8;
+        }
+    }
+
+    void flush() {
+        if (bits > 0) out.push_back(static_cast<char>(buffer & 0xFF));
+        buffer = 0;
+        bits = 0;
+    }
+
+private:
+    std::string& out;
+    uint64_t buffer = 0;
+    int bits = 0;
+};
+
+void putLittleEndian32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+} // namespace
+
+namespace Gzip {
+
+// ---------------------  Checksum  -------------------------------------------
+
+uint32_t crc32(uint32_t crc, const void* data, size_t size) {
+    const auto& t = crcTables();
+    const auto* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    while (size >= 8) {
+        uint32_t low;
+        uint32_t high;
+        std::memcpy(&low, p, 4);
+        std::memcpy(&high, p + 4, 4);
+        low ^= crc;
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24]
+            ^ t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+        p += 8;
+        size -= 8;
+    }
+    while (size--) crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+bool isGzipFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    unsigned char magic[2] = {};
+    file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    return file.gcount() == 2 && magic[0] == 0x1F && magic[1] == 0x8B;
+}
+
+// ---------------------  Encoder  -------------------------------------------
+
+// Greedy LZ77 over a hash chain, emitted as a single fixed-Huffman block
+std::string compress(const char* data, size_t size) {
+    constexpr int HashBits = 15;
+    constexpr int MaxChain = 16;
+    constexpr size_t MinMatch = 3;
+    constexpr size_t MaxMatch = 258;
+    constexpr int64_t MaxDistance = 32768;
+
+    static const auto literalCodes = []() {
+        std::array<uint16_t, 288> codes{};
+        uint8_t lengths[288];
+        fixedLiteralLengths(lengths);
+        canonicalCodes(lengths, 288, codes.data());
+        return codes;
+    }();
+    auto literalLength = [](int symbol) { return symbol < 144 ? 8 : symbol < 256 ? 9 : symbol < 280 ? 7 : 8; };
+
+    std::string out;
+    out.reserve(size / 2 + 64);
+    const char header[10] = { '\x1F', '\x8B', 8, 0, 0, 0, 0, 0, 0, '\xFF' };
+    out.append(header, sizeof(header));
+
+    BitWriter writer(out);
+    writer.put(1, 1); // Final block
+    writer.put(1, 2); // Fixed Huffman codes
+
+    auto putSymbol = [&](int symbol) { writer.put(literalCodes[symbol], literalLength(symbol)); };
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+    std::vector<int64_t> head(size_t(1) << HashBits, -1);
+    std::vector<int64_t> previous(MaxDistance, -1);
+    auto hashAt = [&](size_t i) {
+        const uint32_t v = bytes[i] | (bytes[i + 1] << 8) | (bytes[i + 2] << 16);
+        return (v * 2654435761u) >> (32 - HashBits);
+    };
+    auto insert = [&](size_t i) {
+        const uint32_t h = hashAt(i);
+        previous[i & (MaxDistance - 1)] = head[h];
+        head[h] = static_cast<int64_t>(i);
+    };
+
+    size_t i = 0;
+    while (i < size) {
+        size_t bestLength = 0;
+        size_t bestDistance = 0;
+        if (i + MinMatch <= size) {
+            const size_t limit = std::min(MaxMatch, size - i);
+            int64_t candidate = head[hashAt(i)];
+            for (int chain = 0; chain < MaxChain && candidate >= 0 && static_cast<int64_t>(i) - candidate <= MaxDistance;
+                 ++chain) {
+                const uint8_t* a = bytes + candidate;
+                const uint8_t* b = bytes + i;
+                size_t length = 0;
+                while (length < limit && a[length] == b[length]) ++length;
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = i - static_cast<size_t>(candidate);
+                    if (length == limit) break;
+                }
+                candidate = previous[candidate & (MaxDistance - 1)];
+            }
+            insert(i);
+        }
+
+        if (bestLength >= MinMatch) {
+            const int lengthCode = static_cast<int>(std::upper_bound(LengthBase, LengthBase + 29, bestLength) - LengthBase) - 1;
+            putSymbol(257 + lengthCode);
+            writer.put(static_cast<uint32_t>(bestLength - LengthBase[lengthCode]), LengthExtra[lengthCode]);
+            const int distanceCode = static_cast<int>(std::upper_bound(DistanceBase, DistanceBase + 30, bestDistance) - DistanceBase) - 1;
+            writer.put(reverseBits(distanceCode, 5), 5);
+            writer.put(static_cast<uint32_t>(bestDistance - DistanceBase[distanceCode]), DistanceExtra[distanceCode]);
+            for (size_t k = 1; k < bestLength; ++k) {
+                if (i + k + MinMatch <= size) insert(i + k);
+            }
+            i += bestLength;
+        }
+        else {
+            putSymbol(bytes[i]);
+            ++i;
+        }
+    }
+    putSymbol(256);
+    writer.flush();
+
+    putLittleEndian32(out, crc32(0, data, size));
+    putLittleEndian32(out, static_cast<uint32_t>(size));
+    return out;
+}
+
+// ---------------------  Decoder  -------------------------------------------
+
+Reader::Reader(std::istream& in) : in(in), input(InputBufferBytes), window(WindowSize) {}
+
+size_t Reader::read(char* out, size_t size) {
+    size_t n = 0;
+    size_t checked = 0; // Bytes of `out` already added to the member checksum
+    while (n < size && state != State::End) {
+        switch (state) {
+        case State::MemberHeader:
+            state = startMember() ? State::BlockHeader : State::End;
+            break;
+        case State::BlockHeader:
+            readBlockHeader();
+            break;
+        case State::Stored:
+            while (storedRemaining > 0 && n < size) {
+                emit(out, n, static_cast<uint8_t>(bits(8)));
+                --storedRemaining;
+            }
+            if (storedRemaining == 0) state = lastBlock ? State::Trailer : State::BlockHeader;
+            break;
+        case State::Codes:
+            n = decodeCodes(out, n, size);
+            break;
+        case State::Trailer:
+            crc = crc32(crc, out + checked, n - checked);
+            checked = n;
+            readTrailer();
+            state = State::MemberHeader;
+            break;
+        case State::End:
+            break;
+        }
+    }
+    crc = crc32(crc, out + checked, n - checked);
+    return n;
+}
+
+// Read the next piece of compressed input; false at end of stream
+bool Reader::fillInput() {
+    in.read(input.data(), static_cast<std::streamsize>(input.size()));
+    inputPos = 0;
+    inputEnd = static_cast<size_t>(in.gcount());
+    return inputEnd > 0;
+}
+
+// Top up the bit buffer with as many whole bytes as fit (fewer at end of input)
+void Reader::refill() {
+    while (bitCount <= 56) {
+        if (inputPos == inputEnd && !fillInput()) return;
+        bitBuffer |= static_cast<uint64_t>(static_cast<uint8_t>(input[inputPos++])) << bitCount;
+        bitCount += 8;
+    }
+}
+
+uint32_t Reader::bits(int count) {
+    if (count == 0) return 0;
+    if (bitCount < count) {
+        refill();
+        if (bitCount < count) throw std::runtime_error("Unexpected end of gzip stream.");
+    }
+    const uint32_t value = static_cast<uint32_t>(bitBuffer & ((uint64_t(1) << count) - 1));
+    bitBuffer >>= count;
+    bitCount -= count;
+    return value;
+}
+
+int Reader::decode(const Huffman& code) {
+    if (bitCount < Huffman::FastBits) refill();
+    if (bitCount >= Huffman::FastBits) {
+        const uint16_t entry = code.fast[bitBuffer & ((1u << Huffman::FastBits) - 1)];
+        if (entry) {
+            bitBuffer >>= entry & 15;
+            bitCount -= entry & 15;
+            return entry >> 4;
+        }
+    }
+    return decodeSlow(code);
+}
+
+// Bit-at-a-time canonical decode for long codes and the last few bits of input
+int Reader::decodeSlow(const Huffman& code) {
+    int value = 0;
+    int first = 0;
+    int index = 0;
+    for (int length = 1; length < 16; ++length) {
+        value |= static_cast<int>(bits(1));
+        const int count = code.count[length];
+        if (value - count < first) return code.symbols[index + (value - first)];
+        index += count;
+        first = (first + count) << 1;
+        value <<= 1;
+    }
+    throw std::runtime_error("Invalid Huffman code in gzip stream.");
+}
+
+void Reader::alignToByte() {
+    const int drop = bitCount % 8;
+    bitBuffer >>= drop;
+    bitCount -= drop;
+}
+
+// Build decoding tables from code lengths; throws if the lengths are over-subscribed
+void Reader::build(Huffman& code, const uint8_t* lengths, int symbolCount) {
+    std::fill(std::begin(code.count), std::end(code.count), uint16_t(0));
+    for (int i = 0; i < symbolCount; ++i) ++code.count[lengths[i]];
+    code.count[0] = 0;
+
+    int left = 1;
+    for (int length = 1; length < 16; ++length) {
+        left = (left << 1) - code.count[length];
+        if (left < 0) throw std::runtime_error("Over-subscribed Huffman code in gzip stream.");
+    }
+
+    uint16_t offsets[16] = {};
+    for (int length = 1; length < 15; ++length) offsets[length + 1] = offsets[length] + code.count[length];
+    for (int i = 0; i < symbolCount; ++i) {
+        if (lengths[i]) code.symbols[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+    }
+
+    std::fill(std::begin(code.fast), std::end(code.fast), uint16_t(0));
+    uint16_t codes[288] = {};
+    canonicalCodes(lengths, symbolCount, codes);
+    for (int i = 0; i < symbolCount; ++i) {
+        const int length = lengths[i];
+        if (length == 0 || length > Huffman::FastBits) continue;
+        for (uint32_t slot = codes[i]; slot < (1u << Huffman::FastBits); slot += 1u << length) {
+            code.fast[slot] = static_cast<uint16_t>((i << 4) | length);
+        }
+    }
+}
+
+// Parse a member header; false at a clean end of input after at least one member
+bool Reader::startMember() {
+    refill();
+    if (bitCount == 0) {
+        if (members == 0) throw std::runtime_error("Empty gzip stream.");
+        return false;
+    }
+    if (bits(8) != 0x1F || bits(8) != 0x8B) throw std::runtime_error("Not a gzip stream.");
+    if (bits(8) != 8) throw std::runtime_error("Unsupported gzip compression method.");
+    const uint32_t flags = bits(8);
+    if (flags & 0xE0) throw std::runtime_error("Unsupported gzip header flags.");
+    for (int i = 0; i < 6; ++i) bits(8); // Modification time, extra flags, OS
+    if (flags & 0x04) {                  // FEXTRA
+        const uint32_t length = bits(16);
+        for (uint32_t i = 0; i < length; ++i) bits(8);
+    }
+    if (flags & 0x08) while (bits(8) != 0) {} // FNAME
+    if (flags & 0x10) while (bits(8) != 0) {} // FCOMMENT
+    if (flags & 0x02) bits(16);               // FHCRC
+
+    ++members;
+    memberBytes = 0;
+    crc = 0;
+    lastBlock = false;
+    return true;
+}
+
+void Reader::readBlockHeader() {
+    lastBlock = bits(1) != 0;
+    switch (bits(2)) {
+    case 0: {
+        alignToByte();
+        const uint32_t length = bits(16);
+        const uint32_t complement = bits(16);
+        if ((length ^ 0xFFFF) != complement) throw std::runtime_error("Corrupt stored block in gzip stream.");
+        storedRemaining = length;
+        state = State::Stored;
+        break;
+    }
+    case 1: {
+        uint8_t lengths[318];
+        fixedLiteralLengths(lengths);
+        std::fill(lengths + 288, lengths + 318, uint8_t(5));
+        build(literals, lengths, 288);
+        build(distances, lengths + 288, 30);
+        state = State::Codes;
+        break;
+    }
+    case 2:
+        readDynamicCodes();
+        state = State::Codes;
+        break;
+    default:
+        throw std::runtime_error("Invalid block type in gzip stream.");
+    }
+}
+
+void Reader::readDynamicCodes() {
+    const int literalCount = static_cast<int>(bits(5)) + 257;
+    const int distanceCount = static_cast<int>(bits(5)) + 1;
+    const int codeLengthCount = static_cast<int>(bits(4)) + 4;
+    if (literalCount > 286 || distanceCount > 30) throw std::runtime_error("Invalid code counts in gzip stream.");
+
+    uint8_t lengths[320] = {};
+    for (int i = 0; i < codeLengthCount; ++i) lengths[CodeLengthOrder[i]] = static_cast<uint8_t>(bits(3));
+    Huffman codeLengths;
+    build(codeLengths, lengths, 19);
+
+    std::fill(std::begin(lengths), std::end(lengths), uint8_t(0));
+    const int total = literalCount + distanceCount;
+    for (int i = 0; i < total;) {
+        const int symbol = decode(codeLengths);
+        if (symbol < 16) {
+            lengths[i++] = static_cast<uint8_t>(symbol);
+            continue;
+        }
+        uint8_t value = 0;
+        int repeat;
+        if (symbol == 16) {
+            if (i == 0) throw std::runtime_error("Invalid code length repeat in gzip stream.");
+            value = lengths[i - 1];
+            repeat = 3 + static_cast<int>(bits(2));
+        }
+        else if (symbol == 17) {
+            repeat = 3 + static_cast<int>(bits(3));
+        }
+        else {
+            repeat = 11 + static_cast<int>(bits(7));
+        }
+        if (i + repeat > total) throw std::runtime_error("Invalid code length repeat in gzip stream.");
+        std::fill(lengths + i, lengths + i + repeat, value);
+        i += repeat;
+    }
+    if (lengths[256] == 0) throw std::runtime_error("Missing end-of-block code in gzip stream.");
+
+    build(literals, lengths, literalCount);
+    build(distances, lengths + literalCount, distanceCount);
+}
+
+// Decode literals and matches until `out` is full or the block ends
+size_t Reader::decodeCodes(char* out, size_t n, size_t size) {
+    while (n < size) {
+        if (copyLength > 0) {
+            const size_t end = n + std::min<size_t>(copyLength, size - n);
+            copyLength -= static_cast<uint32_t>(end - n);
+            while (n < end) emit(out, n, window[(windowPos - copyDistance) & WindowMask]);
+            continue;
+        }
+
+        const int symbol = decode(literals);
+        if (symbol < 256) {
+            emit(out, n, static_cast<uint8_t>(symbol));
+        }
+        else if (symbol == 256) {
+            state = lastBlock ? State::Trailer : State::BlockHeader;
+            break;
+        }
+        else {
+            const int lengthCode = symbol - 257;
+            if (lengthCode >= 29) throw std::runtime_error("Invalid length code in gzip stream.");
+            copyLength = LengthBase[lengthCode] + bits(LengthExtra[lengthCode]);
+            const int distanceCode = decode(distances);
+            if (distanceCode >= 30) throw std::runtime_error("Invalid distance code in gzip stream.");
+            copyDistance = DistanceBase[distanceCode] + bits(DistanceExtra[distanceCode]);
+            if (copyDistance > memberBytes) throw std::runtime_error("Distance too far back in gzip stream.");
+        }
+    }
+    return n;
+}
+
+void Reader::readTrailer() {
+    alignToByte();
+    uint32_t expectedCrc = bits(16);
+    expectedCrc |= bits(16) << 16;
+    uint32_t expectedSize = bits(16);
+    expectedSize |= bits(16) << 16;
+    if (expectedCrc != crc) throw std::runtime_error("Gzip checksum mismatch.");
+    if (expectedSize != static_cast<uint32_t>(memberBytes)) throw std::runtime_error("Gzip length mismatch.");
+}
+
+} // namespace Gzip
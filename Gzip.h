@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+// ---------------------  Gzip  -------------------------------------------
+//
+// Self-contained gzip (RFC 1952) / DEFLATE (RFC 1951) codec, so compressed
+// inputs load without zlib or any other system library. The decoder handles
+// all three DEFLATE block types and multi-member files (as written by gzip,
+// pigz, bgzip and compress() below). The encoder is a single-pass LZ77 with
+// the fixed Huffman code: it trades ratio for speed and is meant for
+// generated data, not archival.
+namespace Gzip {
+
+// CRC-32 as used by gzip. Pass the previous result to continue a running checksum.
+uint32_t crc32(uint32_t crc, const void* data, size_t size);
+
+// Whether the file starts with the gzip magic bytes
+bool isGzipFile(const std::string& path);
+
+// Compress `data` into one complete gzip member. Concatenated members form a
+// valid .gz file, so large inputs can be compressed as independent pieces in parallel.
+std::string compress(const char* data, size_t size);
+
+// Streaming decoder reading compressed bytes from `in`
+class Reader {
+public:
+    explicit Reader(std::istream& in);
+
+    // Decompress up to `size` bytes into `out`. Returns fewer than `size` bytes
+    // only at the end of the last member, then 0. Throws std::runtime_error on
+    // corrupt or truncated input and on checksum mismatch.
+    size_t read(char* out, size_t size);
+
+private:
+    // Canonical Huffman code with a direct lookup table for short codes
+    struct Huffman {
+        static constexpr int FastBits = 10;
+        uint16_t fast[1 << FastBits]; // (symbol << 4) | length, 0 if the code is longer than FastBits
+        uint16_t count[16];           // Number of codes of each length
+        uint16_t symbols[288];        // Symbols ordered by code
+    };
+
+    enum class State { MemberHeader, BlockHeader, Stored, Codes, Trailer, End };
+
+    static void build(Huffman& code, const uint8_t* lengths, int symbolCount);
+
+    bool fillInput();
+    void refill();
+    uint32_t bits(int count);
+    int decode(const Huffman& code);
+    int decodeSlow(const Huffman& code);
+    void alignToByte();
+
+    bool startMember();
+    void readBlockHeader();
+    void readDynamicCodes();
+    void readTrailer();
+    size_t decodeCodes(char* out, size_t n, size_t size);
+
+    void emit(char* out, size_t& n, uint8_t byte) {
+        window[windowPos++ & WindowMask] = byte;
+        out[n++] = static_cast<char>(byte);
+        ++memberBytes;
+    }
+
+    static constexpr size_t WindowSize = 32768;
+    static constexpr size_t WindowMask = WindowSize - 1;
+
+    std::istream& in;
+    std::vector<char> input;
+    size_t inputPos = 0;
+    size_t inputEnd = 0;
+    uint64_t bitBuffer = 0;
+    int bitCount = 0;
+
+    State state = State::MemberHeader;
+    bool lastBlock = false;
+    uint32_t storedRemaining = 0;
+    uint32_t copyLength = 0;
+    uint32_t copyDistance = 0;
+    uint64_t members = 0;
+    uint64_t memberBytes = 0; // Decompressed bytes in the current member
+    uint32_t crc = 0;
+
+    std::vector<uint8_t> window;
+    size_t windowPos = 0;
+    Huffman literals;
+    Huffman distances;
+};
+
+} // namespace Gzip
@@ -0,0 +1,203 @@
+#pragma once
+
+// ---------------------  Profiler  -------------------------------------------
+//
+// Low-overhead per-phase timers and counters for the backtest hot path.
+// Instrumentation is compiled in only when BACKTESTER_INSTRUMENTATION is
+// defined to a non-zero value (CMake option BACKTESTER_ENABLE_INSTRUMENTATION);
+// otherwise every BT_PROFILE_* / BT_COUNT macro expands to nothing.
+//
+//   BT_PROFILE_SCOPE(OnData);          // time the enclosing scope
+//   BT_COUNT(Fills, 1);                // bump a counter
+//   BT_PROFILE_REPORT(std::cout);      // print the end-of-run report
+//
+// Timers read the TSC on x86 and std::chrono::steady_clock elsewhere. Each
+// thread accumulates into its own slot, so recording never takes a lock.
+
+#ifndef BACKTESTER_INSTRUMENTATION
+#define BACKTESTER_INSTRUMENTATION 0
+#endif
+
+#if BACKTESTER_INSTRUMENTATION
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define BT_PROFILER_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BT_PROFILER_HAS_TSC 1
+#else
+#define BT_PROFILER_HAS_TSC 0
+#endif
+
+namespace Profiler {
+
+enum class Phase { Load, OnData, UpdateNetWorth, Metrics, Count };
+enum class Counter { BarsProcessed, Orders, Fills, Allocations, Count };
+
+inline const char* phaseName(Phase phase) {
+    static const char* names[] = { "Load", "onData", "updateNetWorth", "Metrics" };
+    return names[static_cast<int>(phase)];
+}
+
+inline const char* counterName(Counter counter) {
+    static const char* names[] = { "Bars processed", "Orders", "Fills", "Allocations" };
+    return names[static_cast<int>(counter)];
+}
+
+inline uint64_t readTicks() {
+#if BT_PROFILER_HAS_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+struct ThreadStats {
+    std::array<uint64_t, static_cast<size_t>(Phase::Count)> ticks{};
+    std::array<uint64_t, static_cast<size_t>(Phase::Count)> calls{};
+    std::array<uint64_t, static_cast<size_t>(Counter::Count)> counters{};
+};
+
+// Owns every thread's stats so they can be summed after the threads exit
+class Registry {
+public:
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    ThreadStats& local() {
+        thread_local ThreadStats* stats = nullptr;
+        if (!stats) {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.push_back(std::make_unique<ThreadStats>());
+            stats = threads.back().get();
+        }
+        return *stats;
+    }
+
+    ThreadStats total() {
+        ThreadStats sum;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& stats : threads) {
+            for (size_t i = 0; i < sum.ticks.size(); ++i) {
+                sum.ticks[i] += stats->ticks[i];
+                sum.calls[i] += stats->calls[i];
+            }
+            for (size_t i = 0; i < sum.counters.size(); ++i) sum.counters[i] += stats->counters[i];
+        }
+        return sum;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& stats : threads) *stats = ThreadStats{};
+    }
+
+    // Ticks per nanosecond, measured against steady_clock since the registry was created
+    double ticksPerNanosecond() const {
+#if BT_PROFILER_HAS_TSC
+        const uint64_t ticks = readTicks() - startTicks;
+        const auto elapsed = std::chrono::steady_clock::now() - startTime;
+        const double nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        return nanoseconds > 0 ? ticks / nanoseconds : 1.0;
+#else
+        using Period = std::chrono::steady_clock::period;
+        return 1e-9 * Period::den / Period::num;
+#endif
+    }
+
+private:
+    Registry() : startTicks(readTicks()), startTime(std::chrono::steady_clock::now()) {}
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadStats>> threads;
+    uint64_t startTicks;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+// Adds the lifetime of the object to a phase
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Phase phase) : phase(phase), start(readTicks()) {}
+    ~ScopedTimer() {
+        ThreadStats& stats = Registry::instance().local();
+        stats.ticks[static_cast<size_t>(phase)] += readTicks() - start;
+        stats.calls[static_cast<size_t>(phase)] += 1;
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Phase phase;
+    uint64_t start;
+};
+
+inline void count(Counter counter, uint64_t amount) {
+    Registry::instance().local().counters[static_cast<size_t>(counter)] += amount;
+}
+
+inline void reset() {
+    Registry::instance().reset();
+}
+
+// Print per-phase time and counters accumulated across all threads
+inline void report(std::ostream& out) {
+    const ThreadStats stats = Registry::instance().total();
+    const double ticksPerNs = Registry::instance().ticksPerNanosecond();
+
+    uint64_t totalTicks = 0;
+    for (uint64_t ticks : stats.ticks) totalTicks += ticks;
+
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << "\nProfile Report:" << std::endl;
+    out << "---------------" << std::endl;
+    out << std::left << std::setw(16) << "Phase" << std::right << std::setw(14) << "Calls"
+        << std::setw(14) << "Total ms" << std::setw(12) << "ns/call" << std::setw(9) << "Share" << std::endl;
+    for (size_t i = 0; i < stats.ticks.size(); ++i) {
+        if (stats.calls[i] == 0) continue;
+        const double ns = stats.ticks[i] / ticksPerNs;
+        out << std::left << std::setw(16) << phaseName(static_cast<Phase>(i)) << std::right
+            << std::setw(14) << stats.calls[i]
+            << std::setw(14) << std::fixed << std::setprecision(2) << ns / 1e6
+            << std::setw(12) << std::setprecision(1) << ns / stats.calls[i]
+            << std::setw(8) << std::setprecision(1) << (totalTicks ? 100.0 * stats.ticks[i] / totalTicks : 0.0) << "%"
+            << std::endl;
+    }
+    for (size_t i = 0; i < stats.counters.size(); ++i) {
+        out << std::left << std::setw(16) << counterName(static_cast<Counter>(i)) << std::right
+            << std::setw(14) << stats.counters[i] << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace Profiler
+
+#define BT_PROFILE_CONCAT_INNER(a, b) a##b
+#define BT_PROFILE_CONCAT(a, b) BT_PROFILE_CONCAT_INNER(a, b)
+#define BT_PROFILE_SCOPE(phase) ::Profiler::ScopedTimer BT_PROFILE_CONCAT(btProfileScope, __LINE__)(::Profiler::Phase::phase)
+#define BT_COUNT(counter, amount) ::Profiler::count(::Profiler::Counter::counter, (amount))
+#define BT_PROFILE_RESET() ::Profiler::reset()
+#define BT_PROFILE_REPORT(stream) ::Profiler::report(stream)
+
+#else
+
+#define BT_PROFILE_SCOPE(phase)
+#define BT_COUNT(counter, amount) ((void)0)
+#define BT_PROFILE_RESET() ((void)0)
+#define BT_PROFILE_REPORT(stream) ((void)0)
+
+#endif // BACKTESTER_INSTRUMENTATION
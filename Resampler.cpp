@@ -0,0 +1,147 @@
+#include "Resampler.h"
+#include <cctype>
+#include <cmath>
+
+namespace {
+
+// Reductions with four independent accumulators, so the compiler can keep
+// several comparisons in flight (or in one vector register) per iteration
+double maxOf(const double* values, size_t count) {
+    double m0 = values[0], m1 = m0, m2 = m0, m3 = m0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        m0 = values[i] > m0 ? values[i] : m0;
+        m1 = values[i + 1] > m1 ? values[i + 1] : m1;
+        m2 = values[i + 2] > m2 ? values[i + 2] : m2;
+        m3 = values[i + 3] > m3 ? values[i + 3] : m3;
+    }
+    for (; i < count; ++i) m0 = values[i] > m0 ? values[i] : m0;
+    return std::max(std::max(m0, m1), std::max(m2, m3));
+}
+
+double minOf(const double* values, size_t count) {
+    double m0 = values[0], m1 = m0, m2 = m0, m3 = m0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        m0 = values[i] < m0 ? values[i] : m0;
+        m1 = values[i + 1] < m1 ? values[i + 1] : m1;
+        m2 = values[i + 2] < m2 ? values[i + 2] : m2;
+        m3 = values[i + 3] < m3 ? values[i + 3] : m3;
+    }
+    for (; i < count; ++i) m0 = values[i] < m0 ? values[i] : m0;
+    return std::min(std::min(m0, m1), std::min(m2, m3));
+}
+
+int64_t sumOf(const int64_t* values, size_t count) {
+    int64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        s0 += values[i];
+        s1 += values[i + 1];
+        s2 += values[i + 2];
+        s3 += values[i + 3];
+    }
+    for (; i < count; ++i) s0 += values[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+} // namespace
+
+// ---------------------  Resampler  -------------------------------------------
+
+BarColumns Resampler::resample(const BarView& bars, int64_t intervalSeconds) {
+    if (intervalSeconds <= 0) throw std::invalid_argument("Invalid resampling interval.");
+
+    BarColumns out;
+    const int64_t* timestamps = bars.timestamps;
+    const size_t count = bars.size();
+    if (count == 0) return out;
+    const int64_t span = timestamps[count - 1] - timestamps[0];
+    out.reserve(static_cast<size_t>(std::min<int64_t>(static_cast<int64_t>(count), span / intervalSeconds + 2)));
+    for (size_t first = 0; first < count;) {
+        const int64_t start = bucketStart(timestamps[first], intervalSeconds);
+        const size_t last = std::lower_bound(timestamps + first, timestamps + count, start + intervalSeconds) - timestamps;
+        const size_t length = last - first;
+
+        // Adjustment factors are positive, so they commute with max and min
+        out.timestamps.push_back(start);
+        out.open.push_back(bars.open[first] * bars.priceFactor);
+        out.high.push_back(maxOf(bars.high + first, length) * bars.priceFactor);
+        out.low.push_back(minOf(bars.low + first, length) * bars.priceFactor);
+        out.close.push_back(bars.close[last - 1] * bars.priceFactor);
+        const int64_t volume = sumOf(bars.volume + first, length);
+        out.volume.push_back(bars.volumeFactor == 1.0 ? volume : std::llround(static_cast<double>(volume) * bars.volumeFactor));
+        first = last;
+    }
+    return out;
+}
+
+int64_t Resampler::parseInterval(const std::string& text) {
+    size_t digits = 0;
+    while (digits < text.size() && std::isdigit(static_cast<unsigned char>(text[digits]))) ++digits;
+    if (digits == 0 || digits + 1 != text.size()) throw std::invalid_argument("Invalid interval: " + text);
+
+    const int64_t amount = std::stoll(text.substr(0, digits));
+    int64_t unit;
+    switch (text.back()) {
+    case 's': unit = 1; break;
+    case 'm': unit = 60; break;
+    case 'h': unit = 3600; break;
+    case 'd': unit = 86400; break;
+    default: throw std::invalid_argument("Invalid interval: " + text);
+    }
+    if (amount <= 0) throw std::invalid_argument("Invalid interval: " + text);
+    return amount * unit;
+}
+
+// ---------------------  ResampledSource  -------------------------------------------
+
+ResampledSource::ResampledSource(std::unique_ptr<BarSource> wrapped, int64_t intervalSeconds)
+    : source(std::move(wrapped)), interval(intervalSeconds) {
+    if (!source) throw std::invalid_argument("ResampledSource needs a source.");
+    if (interval <= 0) throw std::invalid_argument("Invalid resampling interval.");
+}
+
+bool ResampledSource::nextChunk(BarColumns& chunk) {
+    chunk.clear();
+    while (chunk.empty() && !finished) {
+        if (!source->nextChunk(input)) {
+            // End of input: the held-back bucket is final
+            std::swap(chunk, carry);
+            carry.clear();
+            finished = true;
+            break;
+        }
+
+        BarColumns buckets = Resampler::resample(BarView(input), interval);
+        if (!carry.empty()) {
+            if (carry.timestamps[0] == buckets.timestamps[0]) {
+                // The bucket spans the chunk boundary: fold the new part into the carried bar
+                buckets.open[0] = carry.open[0];
+                buckets.high[0] = std::max(buckets.high[0], carry.high[0]);
+                buckets.low[0] = std::min(buckets.low[0], carry.low[0]);
+                buckets.volume[0] += carry.volume[0];
+            }
+            else {
+                chunk.push_back(carry.timestamps[0], carry.at(0));
+                chunk.volume.back() = carry.volume[0];
+            }
+            carry.clear();
+        }
+
+        // Everything but the last bucket is complete
+        const size_t complete = buckets.size() - 1;
+        chunk.reserve(chunk.size() + complete);
+        for (size_t i = 0; i < complete; ++i) {
+            chunk.timestamps.push_back(buckets.timestamps[i]);
+            chunk.open.push_back(buckets.open[i]);
+            chunk.high.push_back(buckets.high[i]);
+            chunk.low.push_back(buckets.low[i]);
+            chunk.close.push_back(buckets.close[i]);
+            chunk.volume.push_back(buckets.volume[i]);
+        }
+        carry.push_back(buckets.timestamps[complete], buckets.at(complete));
+        carry.volume.back() = buckets.volume[complete];
+    }
+    return !chunk.empty();
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "BarSource.h"
+#include "TimeSeries.h"
+#include "TimeUtils.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// ---------------------  Resampler  -------------------------------------------
+//
+// Aggregates bars into a coarser timeframe: open of the first bar, highest
+// high, lowest low, close of the last bar and summed volume. Buckets are
+// aligned to multiples of the interval since the epoch (so 1d buckets start
+// at midnight) and each output bar is stamped with its bucket's start time.
+// Buckets without input bars produce no output.
+class Resampler {
+public:
+    // Resample a view in one pass over the columns. Bucket boundaries are found
+    // by binary search over the sorted timestamps, then each bucket is reduced
+    // over contiguous column slices. The view's adjustment factors are applied
+    // to the output.
+    static BarColumns resample(const BarView& bars, int64_t intervalSeconds);
+
+    // Parse an interval such as "30s", "5m", "1h" or "1d" into seconds; throws
+    // std::invalid_argument on anything else
+    static int64_t parseInterval(const std::string& text);
+
+    // Start of the bucket containing `timestamp`
+    static int64_t bucketStart(int64_t timestamp, int64_t intervalSeconds) {
+        int64_t start = timestamp - timestamp % intervalSeconds;
+        return start > timestamp ? start - intervalSeconds : start;
+    }
+};
+
+// Incremental resampler for bar-at-a-time use, such as a multi-timeframe
+// strategy building 5m and 1h bars from the 1m bars it is fed:
+//
+//   BarAggregator fiveMinute(300, 60);
+//   fiveMinute.update(epochSeconds, bar, [&](int64_t start, const TimeSeriesData& fiveMinuteBar) { ... });
+//
+// With `baseSeconds` (the input bar interval) a bucket is emitted as soon as
+// its last input bar arrives, so the coarse bar lines up with the fine bar
+// that closes it. Buckets missing their last bar, or all buckets when
+// baseSeconds is 0, are emitted when the first bar of a later bucket arrives
+// or on flush().
+class BarAggregator {
+public:
+    explicit BarAggregator(int64_t intervalSeconds, int64_t baseSeconds = 0)
+        : interval(intervalSeconds), base(baseSeconds) {
+        if (interval <= 0 || base < 0) throw std::invalid_argument("Invalid resampling interval.");
+    }
+
+    // Add one input bar; `emit(bucketStart, bar)` is called for every bucket it completes
+    template <typename Emit>
+    void update(int64_t timestamp, const TimeSeriesData& bar, Emit&& emit) {
+        const int64_t bucket = Resampler::bucketStart(timestamp, interval);
+        if (open && bucket != start) flush(emit);
+        if (!open) {
+            open = true;
+            start = bucket;
+            partial = bar;
+            volume = bar.volume;
+        }
+        else {
+            partial.high = std::max(partial.high, bar.high);
+            partial.low = std::min(partial.low, bar.low);
+            partial.close = bar.close;
+            volume += bar.volume;
+        }
+        if (base > 0 && timestamp + base >= start + interval) flush(emit);
+    }
+
+    // Same with the timestamp as text, as handed to Strategy::onData
+    template <typename Emit>
+    void update(const std::string& timestamp, const TimeSeriesData& bar, Emit&& emit) {
+        int64_t epochSeconds;
+        if (!TimeUtils::parseTimestamp(timestamp, epochSeconds)) throw std::invalid_argument("Invalid timestamp: " + timestamp);
+        update(epochSeconds, bar, emit);
+    }
+
+    // Emit the partial bucket, if any (call at the end of the data)
+    template <typename Emit>
+    void flush(Emit&& emit) {
+        if (!open) return;
+        partial.volume = volume;
+        open = false;
+        emit(start, static_cast<const TimeSeriesData&>(partial));
+    }
+
+    // Whether a bucket has input bars that were not emitted yet
+    bool hasPartial() const { return open; }
+
+private:
+    int64_t interval;
+    int64_t base;
+    bool open = false;
+    int64_t start = 0;
+    TimeSeriesData partial{};
+    int64_t volume = 0;
+};
+
+// Streaming decorator that resamples another source chunk by chunk. Each
+// input chunk is resampled with Resampler::resample; the last bucket of a
+// chunk is held back and merged with the next chunk's first bucket when the
+// bucket spans the chunk boundary.
+class ResampledSource : public BarSource {
+public:
+    ResampledSource(std::unique_ptr<BarSource> source, int64_t intervalSeconds);
+
+    bool nextChunk(BarColumns& chunk) override;
+
+private:
+    std::unique_ptr<BarSource> source;
+    int64_t interval;
+    BarColumns input;
+    BarColumns carry; // Last (possibly incomplete) bucket seen so far, at most one bar
+    bool finished = false;
+};
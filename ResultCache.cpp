@@ -0,0 +1,203 @@
+#include "ResultCache.h"
+#include "BacktestingEngine.h"
+#include "Snapshot.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+namespace {
+
+constexpr char CacheMagic[8] = { 'B', 'T', 'C', 'A', 'C', 'H', 'E', '\0' };
+constexpr uint32_t CacheVersion = 1;
+constexpr uint32_t HasEquityCurve = 1;
+
+static_assert(std::is_trivially_copyable<MetricSummary>::value, "MetricSummary is cached as raw bytes");
+
+// Incremental FNV-1a
+class Fnv1a {
+public:
+    void add(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    template <typename T>
+    void add(const T& value) { add(&value, sizeof(T)); }
+
+    uint64_t value() const { return hash; }
+
+private:
+    uint64_t hash = 14695981039346656037ull;
+};
+
+uint64_t checksum(const std::vector<char>& bytes) {
+    Fnv1a hash;
+    hash.add(bytes.data(), bytes.size());
+    return hash.value();
+}
+
+std::atomic<uint64_t> temporaryCounter{ 0 };
+
+} // namespace
+
+ResultCache::ResultCache(std::string cacheDirectory, bool storeCurves)
+    : directory(std::move(cacheDirectory)), storeEquityCurves(storeCurves) {
+    if (directory.empty()) throw std::invalid_argument("Result cache directory cannot be empty.");
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error || !std::filesystem::is_directory(directory)) {
+        throw std::runtime_error("Failed to create result cache directory: " + directory);
+    }
+}
+
+uint64_t ResultCache::hashBars(const std::vector<BarView>& segments) {
+    Fnv1a hash;
+    hash.add<uint64_t>(segments.size());
+    for (const BarView& bars : segments) {
+        hash.add<uint64_t>(bars.count);
+        hash.add(bars.priceFactor);
+        hash.add(bars.volumeFactor);
+        hash.add(bars.timestamps, bars.count * sizeof(int64_t));
+        hash.add(bars.open, bars.count * sizeof(double));
+        hash.add(bars.high, bars.count * sizeof(double));
+        hash.add(bars.low, bars.count * sizeof(double));
+        hash.add(bars.close, bars.count * sizeof(double));
+        hash.add(bars.volume, bars.count * sizeof(int64_t));
+    }
+    return hash.value();
+}
+
+// Exact (round-trip) text of every input, one field per line
+std::string ResultCache::makeKey(uint64_t barsHash, const std::string& symbol, const std::string& strategyType,
+                                 const ParameterSet& parameters, const Portfolio& portfolio) {
+    std::ostringstream key;
+    key.precision(17);
+    key << "engine " << BacktestingEngine::ResultVersion << "\n"
+        << "bars " << std::hex << barsHash << std::dec << "\n"
+        << "symbol " << symbol << "\n"
+        << "strategy " << strategyType << "\n";
+    for (const auto& [name, value] : parameters) key << "parameter " << name << " " << value << "\n";
+
+    const CostModel& costs = portfolio.getCostModel();
+    key << "cash " << portfolio.getCash() << "\n"
+        << "commissionPerShare " << costs.commissionPerShare << "\n"
+        << "commissionPerOrder " << costs.commissionPerOrder << "\n"
+        << "slippageBps " << costs.slippageBps << "\n"
+        << "sampling " << static_cast<int>(portfolio.getEquitySampling()) << " "
+        << portfolio.getEquitySamplingInterval() << "\n";
+    if (portfolio.isMarginAccount()) {
+        const MarginSettings& margin = portfolio.getMarginSettings();
+        key << "margin " << margin.allowShort << " " << margin.initialMargin << " " << margin.maintenanceMargin
+            << " " << margin.maxLeverage << "\n";
+    }
+    if (portfolio.isFixedPoint()) key << "fixedPoint " << portfolio.getTickSize(symbol).micros() << "\n";
+    if (const RiskEngine* risk = portfolio.getRiskEngine()) {
+        const RiskLimits& limits = risk->getLimits();
+        key << "risk " << risk->getPositionLimit(symbol) << " " << limits.maxGrossExposure << " "
+            << limits.maxNetExposure << " " << limits.maxOrders << " " << limits.orderWindowSeconds << " "
+            << limits.maxDrawdown << " " << limits.maxSessionLoss << "\n";
+    }
+    return key.str();
+}
+
+std::string ResultCache::entryPath(const std::string& key) const {
+    Fnv1a hash;
+    hash.add(key.data(), key.size());
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.btc", static_cast<unsigned long long>(hash.value()));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+bool ResultCache::lookup(const std::string& key, RunResult& result, std::vector<double>* equityCurve) const {
+    std::ifstream in(entryPath(key), std::ios::binary);
+    if (!in) return false;
+
+    ResultCacheHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (std::memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) != 0 || header.version != CacheVersion) return false;
+    if (equityCurve && !(header.flags & HasEquityCurve)) return false;
+
+    std::vector<char> payload;
+    try {
+        payload.resize(static_cast<size_t>(header.payloadBytes));
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+    if (!in.read(payload.data(), static_cast<std::streamsize>(payload.size())) || in.peek() != EOF) return false;
+    if (checksum(payload) != header.checksum) return false;
+
+    try {
+        SnapshotReader entry(payload);
+        if (entry.readString() != key) return false;
+        const MetricSummary metrics = entry.read<MetricSummary>();
+        const double finalEquity = entry.read<double>();
+        const uint64_t fills = entry.read<uint64_t>();
+        std::vector<double> curve;
+        if (header.flags & HasEquityCurve) entry.readVector(curve);
+        if (!entry.atEnd()) return false;
+
+        result.metrics = metrics;
+        result.finalEquity = finalEquity;
+        result.fills = static_cast<size_t>(fills);
+        result.error.clear();
+        if (equityCurve) *equityCurve = std::move(curve);
+        return true;
+    }
+    catch (const std::runtime_error&) {
+        return false;
+    }
+}
+
+void ResultCache::store(const std::string& key, const RunResult& result, SeriesView equityCurve) const {
+    if (!result.ok()) throw std::invalid_argument("Only successful runs are cached.");
+
+    SnapshotWriter entry;
+    entry.writeString(key);
+    entry.write(result.metrics);
+    entry.write(result.finalEquity);
+    entry.write<uint64_t>(result.fills);
+    const bool withCurve = storeEquityCurves && !equityCurve.empty();
+    if (withCurve) {
+        entry.write<uint64_t>(equityCurve.size());
+        for (double value : equityCurve) entry.write(value);
+    }
+    const std::vector<char> payload = entry.take();
+
+    ResultCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CacheMagic, sizeof(header.magic));
+    header.version = CacheVersion;
+    header.flags = withCurve ? HasEquityCurve : 0;
+    header.payloadBytes = payload.size();
+    header.checksum = checksum(payload);
+
+    // Unique per writer, so threads storing the same key never share a temporary
+    const std::string path = entryPath(key);
+    const std::string temporary = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()))
+        + "." + std::to_string(temporaryCounter++) + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Failed to create result cache entry: " + temporary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        out.flush();
+        if (!out) throw std::runtime_error("Failed to write result cache entry: " + temporary);
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        throw std::runtime_error("Failed to store result cache entry " + path);
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "BatchConfig.h"
+#include "ResultSink.h"
+#include "TimeSeries.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ---------------------  Result Cache  -------------------------------------------
+//
+// On-disk cache of finished runs, so a repeated sweep only runs the grid
+// cells it has not seen before. A run is keyed by a hash of the bars it ran
+// on (their contents, not the file they came from) and by everything else
+// that decides its outcome: the engine's result version, symbol, strategy
+// type and every parameter (defaults included), and the portfolio's starting
+// cash and settings. Names given in the configuration are not part of the key.
+//
+// Each entry is one file in the cache directory, named by the key's hash:
+// ResultCacheHeader, then the run's key text, metrics, final equity, fill
+// count and (optionally) equity curve, encoded with SnapshotWriter. The key
+// text is compared on lookup, so a hash collision is a miss, not a wrong
+// result. Entries are written to a temporary file and renamed into place, so
+// concurrent writers and crashes never leave a partial entry behind. The
+// values are stored in native layout; the header version covers the layout,
+// and BacktestingEngine::ResultVersion in the key covers the results.
+
+struct ResultCacheHeader {
+    char magic[8];          // "BTCACHE" followed by a zero byte
+    uint32_t version;       // Format version (currently 1)
+    uint32_t flags;         // Bit 0: the entry holds an equity curve
+    uint64_t payloadBytes;
+    uint64_t checksum;      // FNV-1a of the payload
+};
+static_assert(sizeof(ResultCacheHeader) == 32, "ResultCacheHeader must be 32 bytes");
+
+class ResultCache {
+public:
+    // Cache in `directory`, created if missing; throws std::runtime_error if
+    // it cannot be. With `storeEquityCurves`, entries also hold the curve.
+    explicit ResultCache(std::string directory, bool storeEquityCurves = false);
+
+    // Hash of bar contents (segment by segment, with their adjustment factors)
+    static uint64_t hashBars(const std::vector<BarView>& segments);
+
+    // Key of a run over bars with hash `barsHash`. `parameters` are the
+    // strategy's resolved parameters (see BatchRunner::resolveParameters) and
+    // `portfolio` is set up as the run's portfolio starts: its cash, cost
+    // model, equity sampling, margin, fixed-point and risk settings are keyed.
+    static std::string makeKey(uint64_t barsHash, const std::string& symbol, const std::string& strategyType,
+                               const ParameterSet& parameters, const Portfolio& portfolio);
+
+    // Fill the outcome of a cached run (metrics, final equity, fills) into
+    // `result`, and its equity curve into `equityCurve` if given. Returns
+    // false on a miss; unreadable or corrupt entries, and entries without a
+    // curve when one is asked for, are misses too.
+    bool lookup(const std::string& key, RunResult& result, std::vector<double>* equityCurve = nullptr) const;
+
+    // Store a successful run; safe to call from several threads at once.
+    // Throws std::runtime_error on I/O failure.
+    void store(const std::string& key, const RunResult& result, SeriesView equityCurve = SeriesView(nullptr, 0)) const;
+
+    const std::string& getDirectory() const { return directory; }
+    bool storesEquityCurves() const { return storeEquityCurves; }
+
+private:
+    std::string entryPath(const std::string& key) const;
+
+    std::string directory;
+    bool storeEquityCurves;
+};
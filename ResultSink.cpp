@@ -0,0 +1,100 @@
+#include "ResultSink.h"
+#include "ResultTable.h"
+#include "json/json.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+std::string formatParameters(const ParameterSet& parameters) {
+    std::ostringstream text;
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        text << (i > 0 ? " " : "") << parameters[i].first << "=" << parameters[i].second;
+    }
+    return text.str();
+}
+
+// ---------------------  Console Sink  -------------------------------------------
+
+void ConsoleSink::write(const RunResult& result) {
+    out << result.dataset << " | " << result.strategy << " " << formatParameters(result.parameters)
+        << " | " << result.costModel << " | ";
+    if (!result.ok()) {
+        out << "failed: " << result.error << std::endl;
+        return;
+    }
+    const MetricSummary& metrics = result.metrics;
+    out << "return " << metrics.totalReturn * 100 << "%, max drawdown " << metrics.maxDrawdown * 100
+        << "%, Sharpe " << metrics.sharpeRatio << ", " << metrics.trades.trades << " round trips" << std::endl;
+}
+
+// ---------------------  JSON Sink  -------------------------------------------
+
+JsonSink::JsonSink(std::string path) : path(std::move(path)), runs(std::make_unique<Json::Value>(Json::arrayValue)) {}
+
+JsonSink::~JsonSink() = default;
+
+void JsonSink::write(const RunResult& result) {
+    Json::Value run;
+    run["dataset"] = result.dataset;
+    run["strategy"] = result.strategy;
+    run["costModel"] = result.costModel;
+    Json::Value& parameters = run["parameters"] = Json::Value(Json::objectValue);
+    for (const auto& [name, value] : result.parameters) parameters[name] = value;
+    if (!result.ok()) {
+        run["error"] = result.error;
+        runs->append(run);
+        return;
+    }
+
+    const MetricSummary& metrics = result.metrics;
+    Json::Value& values = run["metrics"];
+    values["totalReturn"] = metrics.totalReturn;
+    values["annualizedReturn"] = metrics.annualizedReturn;
+    values["maxDrawdown"] = metrics.maxDrawdown;
+    values["sharpeRatio"] = metrics.sharpeRatio;
+    values["sortinoRatio"] = metrics.sortinoRatio;
+    values["calmarRatio"] = metrics.calmarRatio;
+    values["winRate"] = metrics.winRate;
+    values["profitFactor"] = metrics.profitFactor;
+    values["averageTradeReturn"] = metrics.averageTradeReturn;
+    values["expectancy"] = metrics.expectancy;
+
+    const TradeStats& trades = metrics.trades;
+    Json::Value& tradeValues = run["trades"];
+    tradeValues["trades"] = Json::UInt64(trades.trades);
+    tradeValues["wins"] = Json::UInt64(trades.wins);
+    tradeValues["losses"] = Json::UInt64(trades.losses);
+    tradeValues["winRate"] = trades.winRate;
+    tradeValues["grossProfit"] = trades.grossProfit;
+    tradeValues["grossLoss"] = trades.grossLoss;
+    tradeValues["netProfit"] = trades.netProfit;
+    tradeValues["profitFactor"] = trades.profitFactor;
+    tradeValues["expectancy"] = trades.expectancy;
+    tradeValues["averageWin"] = trades.averageWin;
+    tradeValues["averageLoss"] = trades.averageLoss;
+    tradeValues["averageReturn"] = trades.averageReturn;
+    tradeValues["averageHoldingSeconds"] = trades.averageHoldingSeconds;
+    tradeValues["maxHoldingSeconds"] = Json::Int64(trades.maxHoldingSeconds);
+    tradeValues["averageMAE"] = trades.averageMAE;
+    tradeValues["averageMFE"] = trades.averageMFE;
+
+    run["finalEquity"] = result.finalEquity;
+    run["fills"] = Json::UInt64(result.fills);
+    runs->append(run);
+}
+
+void JsonSink::close() {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Failed to open results file: " + path);
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "  ";
+    out << Json::writeString(writer, *runs) << std::endl;
+    if (!out) throw std::runtime_error("Failed to write results file: " + path);
+}
+
+std::unique_ptr<ResultSink> makeResultSink(const OutputSpec& output, const BatchConfig& config, std::ostream& console) {
+    if (output.type == "console") return std::make_unique<ConsoleSink>(console);
+    if (output.type == "json") return std::make_unique<JsonSink>(output.path);
+    if (output.type == "columnar") return std::make_unique<ColumnarSink>(output.path, ResultSchema(config), output.exportPath);
+    throw std::invalid_argument("Unknown output type: " + output.type);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "BatchConfig.h"
+#include "metrics.h"
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Json {
+class Value;
+}
+
+// ---------------------  Run Results  -------------------------------------------
+
+// Outcome of one run of a batch job
+struct RunResult {
+    std::string dataset;
+    std::string strategy;        // StrategySpec::name
+    std::string costModel;       // CostModelSpec::name
+    ParameterSet parameters;
+    MetricSummary metrics;
+    double finalEquity = 0.0;
+    size_t fills = 0;
+    std::string error;           // Why the run failed (the numbers are unset); empty on success
+
+    bool ok() const { return error.empty(); }
+};
+
+// Destination for the results of a batch job. BatchRunner writes results from
+// one thread, in job order, and calls close() once at the end. A concurrent
+// sink is instead written from the worker threads as their runs finish, in
+// no particular order, and must accept writes from several threads at once.
+class ResultSink {
+public:
+    virtual ~ResultSink() = default;
+
+    virtual bool isConcurrent() const { return false; }
+    virtual void write(const RunResult& result) = 0;
+    virtual void close() {}
+};
+
+// One line per run, with the headline metrics
+class ConsoleSink : public ResultSink {
+public:
+    explicit ConsoleSink(std::ostream& out) : out(out) {}
+
+    void write(const RunResult& result) override;
+
+private:
+    std::ostream& out;
+};
+
+// Every metric of every run as a JSON array, written to a file on close()
+class JsonSink : public ResultSink {
+public:
+    explicit JsonSink(std::string path);
+    ~JsonSink() override;
+
+    void write(const RunResult& result) override;
+
+    // Throws std::runtime_error if the file cannot be written
+    void close() override;
+
+private:
+    std::string path;
+    std::unique_ptr<Json::Value> runs;
+};
+
+// Sink for an output of `config`; `console` receives console output
+std::unique_ptr<ResultSink> makeResultSink(const OutputSpec& output, const BatchConfig& config, std::ostream& console);
+
+// Parameters rendered as "name=value name=value"
+std::string formatParameters(const ParameterSet& parameters);
@@ -0,0 +1,507 @@
+#include "ResultTable.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char ResultMagic[8] = { 'B', 'T', 'R', 'E', 'S', 'U', 'L', 'T' };
+constexpr uint32_t ResultVersion = 1;
+constexpr uint32_t RowGroupMagic = 0x50524752; // "RGRP"
+
+std::atomic<uint64_t> nextWriterSerial{ 1 };
+
+// Slots of the live writers. A destroyed writer's slot goes to the next one,
+// so the slots in use never exceed the most writers alive at once.
+std::mutex slotMutex;
+std::vector<size_t> freeSlots;
+size_t slotCount = 0;
+
+size_t acquireSlot() {
+    std::lock_guard<std::mutex> lock(slotMutex);
+    if (freeSlots.empty()) return slotCount++;
+    const size_t slot = freeSlots.back();
+    freeSlots.pop_back();
+    return slot;
+}
+
+void releaseSlot(size_t slot) {
+    std::lock_guard<std::mutex> lock(slotMutex);
+    freeSlots.push_back(slot);
+}
+
+// A value column of every row, read from the run's result
+struct ValueColumn {
+    const char* name;
+    ColumnType type;
+    double (*get)(const RunResult& result);
+};
+
+const ValueColumn ValueColumns[] = {
+    { "totalReturn", ColumnType::Float64, [](const RunResult& r) { return r.metrics.totalReturn; } },
+    { "annualizedReturn", ColumnType::Float64, [](const RunResult& r) { return r.metrics.annualizedReturn; } },
+    { "maxDrawdown", ColumnType::Float64, [](const RunResult& r) { return r.metrics.maxDrawdown; } },
+    { "sharpeRatio", ColumnType::Float64, [](const RunResult& r) { return r.metrics.sharpeRatio; } },
+    { "sortinoRatio", ColumnType::Float64, [](const RunResult& r) { return r.metrics.sortinoRatio; } },
+    { "calmarRatio", ColumnType::Float64, [](const RunResult& r) { return r.metrics.calmarRatio; } },
+    { "winRate", ColumnType::Float64, [](const RunResult& r) { return r.metrics.winRate; } },
+    { "profitFactor", ColumnType::Float64, [](const RunResult& r) { return r.metrics.profitFactor; } },
+    { "averageTradeReturn", ColumnType::Float64, [](const RunResult& r) { return r.metrics.averageTradeReturn; } },
+    { "expectancy", ColumnType::Float64, [](const RunResult& r) { return r.metrics.expectancy; } },
+    { "trades", ColumnType::Int64, [](const RunResult& r) { return double(r.metrics.trades.trades); } },
+    { "wins", ColumnType::Int64, [](const RunResult& r) { return double(r.metrics.trades.wins); } },
+    { "losses", ColumnType::Int64, [](const RunResult& r) { return double(r.metrics.trades.losses); } },
+    { "tradeWinRate", ColumnType::Float64, [](const RunResult& r) { return r.metrics.trades.winRate; } },
+    { "grossProfit", ColumnType::Float64, [](const RunResult& r) { return r.metrics.trades.grossProfit; } },
+    { "grossLoss", ColumnType::Float64, [](const RunResult& r) { return r.metrics.trades.grossLoss; } },
+    { "netProfit", ColumnType::Float64, [](const RunResult& r) { return r.metrics.trades.netProfit; } },
+    { "tradeProfitFactor", ColumnType::Float64, [](const RunResult& r) { return r.metrics.trades.profitFactor; } },
+    { "tradeExpectancy", ColumnType::Float64, [](const RunResult& r) { return r.metrics.trades.expectancy; } },
+    { "averageWin", ColumnType::Float64, [](const RunResult& r) { return r.metrics.trades.averageWin; } },
+    { "averageLoss", ColumnType::Float64, [](const RunResult& r) { return r.metrics.trades.averageLoss; } },
+    { "tradeAverageReturn", ColumnType::Float64, [](const RunResult& r) { return r.metrics.trades.averageReturn; } },
+    { "averageHoldingSeconds", ColumnType::Float64, [](const RunResult& r) { return r.metrics.trades.averageHoldingSeconds; } },
+    { "maxHoldingSeconds", ColumnType::Int64, [](const RunResult& r) { return double(r.metrics.trades.maxHoldingSeconds); } },
+    { "averageMAE", ColumnType::Float64, [](const RunResult& r) { return r.metrics.trades.averageMAE; } },
+    { "averageMFE", ColumnType::Float64, [](const RunResult& r) { return r.metrics.trades.averageMFE; } },
+    { "finalEquity", ColumnType::Float64, [](const RunResult& r) { return r.finalEquity; } },
+    { "fills", ColumnType::Int64, [](const RunResult& r) { return double(r.fills); } },
+};
+
+const char* const DictionaryNames[] = { "dataset", "strategy", "costModel" };
+
+uint64_t bitsOf(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double doubleOf(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint64_t alignedSchemaEnd(uint64_t schemaBytes) {
+    return (sizeof(ResultTableHeader) + schemaBytes + 7) / 8 * 8;
+}
+
+void writeJSONString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+        else out << c;
+    }
+    out << '"';
+}
+
+// CSV field, quoted when it holds a separator, quote or line break
+void writeCSVField(std::ostream& out, const std::string& text) {
+    if (text.find_first_of(",\"\r\n") == std::string::npos) {
+        out << text;
+        return;
+    }
+    out << '"';
+    for (char c : text) out << (c == '"' ? "\"\"" : std::string(1, c));
+    out << '"';
+}
+
+} // namespace
+
+// ---------------------  Result Schema  -------------------------------------------
+
+ResultSchema::ResultSchema(const BatchConfig& config) {
+    for (const StrategySpec& strategy : config.strategies) {
+        dictionaries[1].push_back(strategy.name);
+        for (const ParameterSet& cell : strategy.grid) {
+            for (const auto& [name, value] : cell) {
+                if (std::find(parameters.begin(), parameters.end(), name) == parameters.end()) parameters.push_back(name);
+            }
+        }
+    }
+    for (const DatasetSpec& dataset : config.datasets) dictionaries[0].push_back(dataset.name);
+    for (const CostModelSpec& costModel : config.costModels) dictionaries[2].push_back(costModel.name);
+    build();
+}
+
+ResultSchema::ResultSchema(std::vector<std::string> parameterNames, std::vector<std::string> datasets,
+                           std::vector<std::string> strategies, std::vector<std::string> costModels)
+    : parameters(std::move(parameterNames)) {
+    dictionaries[0] = std::move(datasets);
+    dictionaries[1] = std::move(strategies);
+    dictionaries[2] = std::move(costModels);
+    build();
+}
+
+// Index the dictionaries and lay out the columns: ids, status, parameters, values
+void ResultSchema::build() {
+    columns.clear();
+    for (size_t d = 0; d < DictionaryColumns; ++d) {
+        ids[d].clear();
+        for (size_t id = 0; id < dictionaries[d].size(); ++id) ids[d].emplace(dictionaries[d][id], static_cast<uint32_t>(id));
+        columns.push_back(ResultColumn{ DictionaryNames[d], ColumnType::Int64 });
+    }
+    columns.push_back(ResultColumn{ "ok", ColumnType::Int64 });
+    parameterColumns.clear();
+    for (const std::string& parameter : parameters) {
+        parameterColumns.emplace(parameter, static_cast<uint32_t>(columns.size()));
+        columns.push_back(ResultColumn{ "param_" + parameter, ColumnType::Float64 });
+    }
+    for (const ValueColumn& column : ValueColumns) columns.push_back(ResultColumn{ column.name, column.type });
+}
+
+const std::string& ResultSchema::name(size_t column, int64_t id) const {
+    if (column >= DictionaryColumns || id < 0 || static_cast<size_t>(id) >= dictionaries[column].size()) {
+        throw std::out_of_range("No dictionary entry " + std::to_string(id) + " in column " + std::to_string(column));
+    }
+    return dictionaries[column][static_cast<size_t>(id)];
+}
+
+void ResultSchema::encode(const RunResult& result, uint64_t* row) const {
+    const std::string* names[DictionaryColumns] = { &result.dataset, &result.strategy, &result.costModel };
+    for (size_t d = 0; d < DictionaryColumns; ++d) {
+        auto it = ids[d].find(*names[d]);
+        if (it == ids[d].end()) throw std::invalid_argument(std::string("Unknown ") + DictionaryNames[d] + ": " + *names[d]);
+        row[d] = it->second;
+    }
+    row[DictionaryColumns] = result.ok() ? 1 : 0;
+
+    const size_t firstParameter = DictionaryColumns + 1;
+    std::fill(row + firstParameter, row + firstParameter + parameters.size(), bitsOf(std::numeric_limits<double>::quiet_NaN()));
+    for (const auto& [name, value] : result.parameters) {
+        auto it = parameterColumns.find(name);
+        if (it == parameterColumns.end()) throw std::invalid_argument("Unknown parameter: " + name);
+        row[it->second] = bitsOf(value);
+    }
+
+    // A failed run has no values: NaN, or 0 in the integer columns
+    uint64_t* values = row + firstParameter + parameters.size();
+    for (const ValueColumn& column : ValueColumns) {
+        const double value = result.ok() ? column.get(result) : std::numeric_limits<double>::quiet_NaN();
+        if (column.type == ColumnType::Float64) *values++ = bitsOf(value);
+        else *values++ = static_cast<uint64_t>(result.ok() ? static_cast<int64_t>(value) : 0);
+    }
+}
+
+void ResultSchema::save(SnapshotWriter& out) const {
+    out.write<uint64_t>(parameters.size());
+    for (const std::string& parameter : parameters) out.writeString(parameter);
+    for (const std::vector<std::string>& dictionary : dictionaries) {
+        out.write<uint64_t>(dictionary.size());
+        for (const std::string& entry : dictionary) out.writeString(entry);
+    }
+}
+
+ResultSchema ResultSchema::load(SnapshotReader& in) {
+    auto readNames = [&]() {
+        std::vector<std::string> names(static_cast<size_t>(in.read<uint64_t>()));
+        for (std::string& name : names) name = in.readString();
+        return names;
+    };
+    std::vector<std::string> parameterNames = readNames();
+    std::vector<std::string> datasets = readNames();
+    std::vector<std::string> strategies = readNames();
+    std::vector<std::string> costModels = readNames();
+    return ResultSchema(std::move(parameterNames), std::move(datasets), std::move(strategies), std::move(costModels));
+}
+
+// ---------------------  Result Table Writer  -------------------------------------------
+
+ResultTableWriter::ResultTableWriter(const std::string& filePath, ResultSchema tableSchema, size_t rowsPerGroup)
+    : path(filePath), schema(std::move(tableSchema)), groupRows(rowsPerGroup), serial(nextWriterSerial++) {
+    if (groupRows == 0 || groupRows > std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("Row group size must be between 1 and 2^32 - 1.");
+    }
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) throw std::runtime_error("Failed to create results file: " + path);
+    file = handle;
+#else
+    descriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0) throw std::runtime_error("Failed to create results file: " + path);
+#endif
+
+    SnapshotWriter encoded;
+    schema.save(encoded);
+    ResultTableHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, ResultMagic, sizeof(header.magic));
+    header.version = ResultVersion;
+    header.columnCount = static_cast<uint32_t>(schema.getColumns().size());
+    header.schemaBytes = encoded.bytes().size();
+    try {
+        writeAt(0, &header, sizeof(header));
+        writeAt(sizeof(header), encoded.bytes().data(), encoded.bytes().size());
+    }
+    catch (...) {
+        closed = true;
+#ifdef _WIN32
+        CloseHandle(file);
+#else
+        ::close(descriptor);
+#endif
+        throw;
+    }
+    end = alignedSchemaEnd(header.schemaBytes);
+    slot = acquireSlot();
+}
+
+ResultTableWriter::~ResultTableWriter() {
+    try {
+        close();
+    }
+    catch (...) {
+        // Destructors must not throw; call close() to see I/O errors
+    }
+    ThreadBuffer* buffer = buffers.load();
+    while (buffer) {
+        ThreadBuffer* next = buffer->next;
+        delete buffer;
+        buffer = next;
+    }
+    releaseSlot(slot);
+}
+
+// Each thread keeps its buffers in a table indexed by writer slot, so finding
+// one is an index and no thread ever blocks another. A slot's entry is
+// replaced when a new writer reuses the slot; serials are never reused, so
+// the entry of a destroyed writer never matches.
+ResultTableWriter::ThreadBuffer& ResultTableWriter::bufferForThisThread() {
+    thread_local std::vector<std::pair<uint64_t, ThreadBuffer*>> owned;
+    if (owned.size() <= slot) owned.resize(slot + 1, { 0, nullptr });
+    std::pair<uint64_t, ThreadBuffer*>& entry = owned[slot];
+    if (entry.first == serial) return *entry.second;
+
+    ThreadBuffer* buffer = new ThreadBuffer;
+    buffer->values.resize(schema.getColumns().size() * groupRows);
+    buffer->next = buffers.load(std::memory_order_relaxed);
+    while (!buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    entry = { serial, buffer };
+    return *buffer;
+}
+
+void ResultTableWriter::append(const RunResult& result) {
+    const size_t columnCount = schema.getColumns().size();
+    thread_local std::vector<uint64_t> row;
+    row.resize(columnCount);
+    schema.encode(result, row.data());
+
+    ThreadBuffer& buffer = bufferForThisThread();
+    for (size_t c = 0; c < columnCount; ++c) buffer.values[c * groupRows + buffer.rows] = row[c];
+    if (++buffer.rows == groupRows) flush(buffer);
+}
+
+// Claim the group's place in the file and write it there
+void ResultTableWriter::flush(ThreadBuffer& buffer) {
+    if (buffer.rows == 0) return;
+    const size_t columnCount = schema.getColumns().size();
+    if (buffer.rows < groupRows) {
+        // Close the gaps a partial group leaves between the columns
+        for (size_t c = 1; c < columnCount; ++c) {
+            std::memmove(&buffer.values[c * buffer.rows], &buffer.values[c * groupRows], buffer.rows * sizeof(uint64_t));
+        }
+    }
+
+    RowGroupHeader header{ RowGroupMagic, static_cast<uint32_t>(buffer.rows) };
+    const size_t dataBytes = columnCount * buffer.rows * sizeof(uint64_t);
+    const uint64_t offset = end.fetch_add(sizeof(header) + dataBytes);
+    writeAt(offset, &header, sizeof(header));
+    writeAt(offset + sizeof(header), buffer.values.data(), dataBytes);
+    rowCount += buffer.rows;
+    ++groupCount;
+    buffer.rows = 0;
+}
+
+void ResultTableWriter::writeAt(uint64_t offset, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+#ifdef _WIN32
+        OVERLAPPED position = {};
+        position.Offset = static_cast<DWORD>(offset);
+        position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD written = 0;
+        const DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+        if (!WriteFile(file, bytes, chunk, &written, &position) || written == 0) {
+#else
+        const ssize_t written = ::pwrite(descriptor, bytes, size, static_cast<off_t>(offset));
+        if (written <= 0) {
+#endif
+            failed = true;
+            throw std::runtime_error("Failed to write results file: " + path);
+        }
+        bytes += written;
+        offset += written;
+        size -= written;
+    }
+}
+
+void ResultTableWriter::close() {
+    if (closed) return;
+    closed = true;
+    bool ok = !failed;
+    try {
+        for (ThreadBuffer* buffer = buffers.load(); buffer; buffer = buffer->next) flush(*buffer);
+
+        ResultTableHeader header;
+        std::memset(&header, 0, sizeof(header));
+        SnapshotWriter encoded;
+        schema.save(encoded);
+        std::memcpy(header.magic, ResultMagic, sizeof(header.magic));
+        header.version = ResultVersion;
+        header.columnCount = static_cast<uint32_t>(schema.getColumns().size());
+        header.schemaBytes = encoded.bytes().size();
+        header.rowCount = rowCount;
+        header.rowGroupCount = groupCount;
+        header.complete = ok ? 1 : 0;
+        writeAt(0, &header, sizeof(header));
+    }
+    catch (...) {
+        ok = false;
+    }
+#ifdef _WIN32
+    ok = CloseHandle(file) && ok;
+#else
+    ok = ::close(descriptor) == 0 && ok;
+#endif
+    if (!ok) throw std::runtime_error("Failed to write results file: " + path);
+}
+
+// ---------------------  Result Table Reader  -------------------------------------------
+
+ResultTableReader::ResultTableReader(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Failed to open results file: " + path);
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    ResultTableHeader header;
+    if (bytes.size() < sizeof(header)) throw std::runtime_error("Not a results file: " + path);
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, ResultMagic, sizeof(ResultMagic)) != 0) throw std::runtime_error("Not a results file: " + path);
+    if (header.version != ResultVersion) throw std::runtime_error("Unsupported results file version: " + path);
+    if (header.complete != 1) throw std::runtime_error("Results file was not closed: " + path);
+    if (header.schemaBytes > bytes.size() - sizeof(header)) throw std::runtime_error("Truncated results file: " + path);
+
+    SnapshotReader schemaIn(bytes.data() + sizeof(header), static_cast<size_t>(header.schemaBytes));
+    schema = ResultSchema::load(schemaIn);
+    const size_t columnCount = schema.getColumns().size();
+    if (columnCount != header.columnCount) throw std::runtime_error("Corrupt results file: " + path);
+
+    values.assign(columnCount, std::vector<uint64_t>());
+    for (std::vector<uint64_t>& column : values) column.reserve(static_cast<size_t>(header.rowCount));
+    uint64_t offset = alignedSchemaEnd(header.schemaBytes);
+    uint64_t groups = 0;
+    while (offset < bytes.size()) {
+        RowGroupHeader group;
+        if (bytes.size() - offset < sizeof(group)) throw std::runtime_error("Truncated results file: " + path);
+        std::memcpy(&group, bytes.data() + offset, sizeof(group));
+        offset += sizeof(group);
+        const uint64_t columnBytes = uint64_t(group.rows) * sizeof(uint64_t);
+        if (group.magic != RowGroupMagic || (bytes.size() - offset) / columnCount < columnBytes) {
+            throw std::runtime_error("Corrupt results file: " + path);
+        }
+        for (size_t c = 0; c < columnCount; ++c) {
+            // The file's bytes carry no alignment, so copy rather than cast
+            const size_t start = values[c].size();
+            values[c].resize(start + group.rows);
+            std::memcpy(values[c].data() + start, bytes.data() + offset, static_cast<size_t>(columnBytes));
+            offset += columnBytes;
+        }
+        rows += group.rows;
+        ++groups;
+    }
+    if (rows != header.rowCount || groups != header.rowGroupCount) throw std::runtime_error("Corrupt results file: " + path);
+}
+
+double ResultTableReader::value(size_t row, size_t column) const {
+    const uint64_t bits = values[column][row];
+    if (schema.getColumns()[column].type == ColumnType::Int64) return static_cast<double>(static_cast<int64_t>(bits));
+    return doubleOf(bits);
+}
+
+size_t ResultTableReader::column(const std::string& name) const {
+    const std::vector<ResultColumn>& columns = schema.getColumns();
+    for (size_t c = 0; c < columns.size(); ++c) {
+        if (columns[c].name == name) return c;
+    }
+    throw std::invalid_argument("No column named " + name);
+}
+
+void ResultTableReader::writeCSV(std::ostream& out) const {
+    const std::vector<ResultColumn>& columns = schema.getColumns();
+    for (size_t c = 0; c < columns.size(); ++c) out << (c > 0 ? "," : "") << columns[c].name;
+    out << '\n';
+
+    out << std::setprecision(17);
+    for (size_t row = 0; row < rows; ++row) {
+        for (size_t c = 0; c < columns.size(); ++c) {
+            if (c > 0) out << ',';
+            const uint64_t bits = values[c][row];
+            if (schema.isDictionary(c)) writeCSVField(out, schema.name(c, static_cast<int64_t>(bits)));
+            else if (columns[c].type == ColumnType::Int64) out << static_cast<int64_t>(bits);
+            else if (!std::isnan(doubleOf(bits))) out << doubleOf(bits);
+        }
+        out << '\n';
+    }
+}
+
+void ResultTableReader::writeJSON(std::ostream& out) const {
+    const std::vector<ResultColumn>& columns = schema.getColumns();
+    out << std::setprecision(17) << '[';
+    for (size_t row = 0; row < rows; ++row) {
+        out << (row > 0 ? ",\n  {" : "\n  {");
+        for (size_t c = 0; c < columns.size(); ++c) {
+            if (c > 0) out << ", ";
+            writeJSONString(out, columns[c].name);
+            out << ": ";
+            const uint64_t bits = values[c][row];
+            const double number = doubleOf(bits);
+            if (schema.isDictionary(c)) writeJSONString(out, schema.name(c, static_cast<int64_t>(bits)));
+            else if (columns[c].type == ColumnType::Int64) out << static_cast<int64_t>(bits);
+            else if (std::isfinite(number)) out << number;
+            else out << "null";
+        }
+        out << '}';
+    }
+    out << (rows > 0 ? "\n]\n" : "]\n");
+}
+
+void ResultTableReader::exportTo(const std::string& path) const {
+    const std::string extension = std::filesystem::path(path).extension().string();
+    if (extension != ".csv" && extension != ".json") {
+        throw std::invalid_argument("Export path must end in .csv or .json: " + path);
+    }
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Failed to open export file: " + path);
+    if (extension == ".csv") writeCSV(out);
+    else writeJSON(out);
+    if (!out) throw std::runtime_error("Failed to write export file: " + path);
+}
+
+// ---------------------  Columnar Sink  -------------------------------------------
+
+ColumnarSink::ColumnarSink(const std::string& filePath, ResultSchema schema, std::string exportFile)
+    : path(filePath), exportPath(std::move(exportFile)), writer(filePath, std::move(schema)) {}
+
+void ColumnarSink::close() {
+    writer.close();
+    if (!exportPath.empty()) ResultTableReader(path).exportTo(exportPath);
+}
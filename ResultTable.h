@@ -0,0 +1,189 @@
+#pragma once
+#include "ResultSink.h"
+#include "Snapshot.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ---------------------  Columnar Results  -------------------------------------------
+//
+// Binary results file with one fixed-schema row per run: the dataset,
+// strategy and cost model (as ids into name dictionaries), a status, one
+// column per strategy parameter (NaN where a run has no such parameter)
+// and every value of MetricSummary plus the final equity and fill count.
+// Every column is 8 bytes (int64 or float64). File layout (little-endian):
+//
+//   ResultTableHeader
+//   schema: columns and dictionaries, in the encoding of Snapshot.h
+//   repeated row groups: RowGroupHeader, then each column's values for the
+//     group's rows, column after column
+//
+// Writers append from any number of threads without locking. Each thread
+// fills a row group of its own and claims the group's place in the file
+// with one atomic add, then writes it there with a positional write, so
+// groups from different threads never wait on each other. The header's row
+// and group counts are written by close(); ResultTableReader rejects a file
+// that was never closed. Row order across threads is unspecified.
+
+enum class ColumnType : uint8_t { Int64 = 0, Float64 = 1 };
+
+struct ResultColumn {
+    std::string name;
+    ColumnType type;
+};
+
+struct ResultTableHeader {
+    char magic[8];           // "BTRESULT"
+    uint32_t version;        // Format version (currently 1)
+    uint32_t columnCount;
+    uint64_t schemaBytes;    // Size of the schema block following the header
+    uint64_t rowCount;       // Written by close()
+    uint64_t rowGroupCount;  // Written by close()
+    uint64_t complete;       // 1 once close() has written the counts
+};
+static_assert(sizeof(ResultTableHeader) == 48, "ResultTableHeader must be 48 bytes");
+
+struct RowGroupHeader {
+    uint32_t magic;          // "RGRP"
+    uint32_t rows;
+};
+static_assert(sizeof(RowGroupHeader) == 8, "RowGroupHeader must be 8 bytes");
+
+// Columns and name dictionaries of a results file
+class ResultSchema {
+public:
+    ResultSchema() = default;
+
+    // Schema for the runs of a batch job: its datasets, strategies, cost
+    // models and the union of its parameter names
+    explicit ResultSchema(const BatchConfig& config);
+
+    ResultSchema(std::vector<std::string> parameters, std::vector<std::string> datasets,
+                 std::vector<std::string> strategies, std::vector<std::string> costModels);
+
+    const std::vector<ResultColumn>& getColumns() const { return columns; }
+    const std::vector<std::string>& getParameters() const { return parameters; }
+
+    // Name of dictionary entry `id` of an id column (dataset, strategy, costModel)
+    const std::string& name(size_t column, int64_t id) const;
+
+    // Whether a column holds dictionary ids
+    bool isDictionary(size_t column) const { return column < DictionaryColumns; }
+
+    // Encode a result into one 8-byte value per column; throws
+    // std::invalid_argument for names or parameters outside the schema
+    void encode(const RunResult& result, uint64_t* row) const;
+
+    void save(SnapshotWriter& out) const;
+    static ResultSchema load(SnapshotReader& in);
+
+private:
+    static constexpr size_t DictionaryColumns = 3;
+
+    void build();
+
+    std::vector<std::string> parameters;
+    std::vector<std::string> dictionaries[DictionaryColumns];
+    std::unordered_map<std::string, uint32_t> ids[DictionaryColumns];
+    std::unordered_map<std::string, uint32_t> parameterColumns;
+    std::vector<ResultColumn> columns;
+};
+
+class ResultTableWriter {
+public:
+    static constexpr size_t DefaultGroupRows = 1024;
+
+    // Create (or truncate) `path`; throws std::runtime_error on failure
+    ResultTableWriter(const std::string& path, ResultSchema schema, size_t groupRows = DefaultGroupRows);
+    ~ResultTableWriter();
+
+    ResultTableWriter(const ResultTableWriter&) = delete;
+    ResultTableWriter& operator=(const ResultTableWriter&) = delete;
+
+    // Append a row; safe to call from any number of threads at once
+    void append(const RunResult& result);
+
+    // Write every thread's partial row group and the header's counts. Call
+    // once all appends have returned; throws std::runtime_error on I/O failure.
+    void close();
+
+    const ResultSchema& getSchema() const { return schema; }
+
+private:
+    // Row group being filled by one thread, column-major
+    struct ThreadBuffer {
+        std::vector<uint64_t> values;
+        size_t rows = 0;
+        ThreadBuffer* next = nullptr;
+    };
+
+    ThreadBuffer& bufferForThisThread();
+    void flush(ThreadBuffer& buffer);
+    void writeAt(uint64_t offset, const void* data, size_t size);
+
+    std::string path;
+    ResultSchema schema;
+    size_t groupRows;
+    uint64_t serial;                                // Tells this writer's thread buffers apart from other writers'
+    size_t slot = 0;                                // Index of this writer's buffer in each thread's table
+    std::atomic<ThreadBuffer*> buffers{ nullptr };  // Lock-free list of every thread's buffer
+    std::atomic<uint64_t> end{ 0 };                 // File offset the next row group is written at
+    std::atomic<uint64_t> rowCount{ 0 };
+    std::atomic<uint64_t> groupCount{ 0 };
+    std::atomic<bool> failed{ false };
+    bool closed = false;
+#ifdef _WIN32
+    void* file = nullptr;
+#else
+    int descriptor = -1;
+#endif
+};
+
+class ResultTableReader {
+public:
+    // Read a whole closed file; throws std::runtime_error if it is not one
+    explicit ResultTableReader(const std::string& path);
+
+    const ResultSchema& getSchema() const { return schema; }
+    size_t rowCount() const { return rows; }
+
+    // Raw 8-byte value of a cell, and the same as a double (int64 columns converted)
+    uint64_t raw(size_t row, size_t column) const { return values[column][row]; }
+    double value(size_t row, size_t column) const;
+
+    // Index of a named column; throws std::invalid_argument if there is none
+    size_t column(const std::string& name) const;
+
+    // Export with a header row / as an array of objects, dictionary ids as
+    // names and NaN as an empty cell / null
+    void writeCSV(std::ostream& out) const;
+    void writeJSON(std::ostream& out) const;
+
+    // Export to a file, in CSV or JSON by its extension (.csv or .json)
+    void exportTo(const std::string& path) const;
+
+private:
+    ResultSchema schema;
+    size_t rows = 0;
+    std::vector<std::vector<uint64_t>> values; // By column
+};
+
+// ResultSink appending to a columnar results file from the worker threads,
+// with an optional CSV or JSON export of the file on close()
+class ColumnarSink : public ResultSink {
+public:
+    ColumnarSink(const std::string& path, ResultSchema schema, std::string exportPath = "");
+
+    bool isConcurrent() const override { return true; }
+    void write(const RunResult& result) override { writer.append(result); }
+    void close() override;
+
+private:
+    std::string path;
+    std::string exportPath;
+    ResultTableWriter writer;
+};
@@ -0,0 +1,166 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+// ---------------------  Ring Buffers  -------------------------------------------
+//
+// Bounded lock-free queues for handing work between threads: SpscRing for
+// one producer and one consumer, MpscRing for any number of producers and
+// one consumer. Capacities are rounded up to a power of two. tryPush and
+// tryPop never block; they return false when the queue is full or empty,
+// and the value is left untouched when a push fails. Backoff gives the
+// waiting side something to do between attempts.
+
+// Keeps indices written by different threads on separate cache lines
+constexpr size_t RingCacheLine = 64;
+
+inline size_t ringCapacity(size_t requested) {
+    if (requested == 0 || requested > (size_t(1) << (sizeof(size_t) * 8 - 2))) {
+        throw std::invalid_argument("Ring buffer capacity must be positive.");
+    }
+    size_t capacity = 2;
+    while (capacity < requested) capacity *= 2;
+    return capacity;
+}
+
+// Spin briefly, then yield the core, so a waiting stage does not starve the
+// stage it waits for when there are fewer cores than threads
+class Backoff {
+public:
+    void pause() {
+        if (spins < SpinLimit) ++spins;
+        else std::this_thread::yield();
+    }
+
+    void reset() { spins = 0; }
+
+private:
+    static constexpr int SpinLimit = 64;
+    int spins = 0;
+};
+
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t requestedCapacity)
+        : capacity(ringCapacity(requestedCapacity)), mask(capacity - 1), slots(new T[capacity]) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side
+    bool tryPush(T&& value) {
+        const size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - cachedHead == capacity) {
+            cachedHead = headIndex.load(std::memory_order_acquire);
+            if (tail - cachedHead == capacity) return false;
+        }
+        slots[tail & mask] = std::move(value);
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPush(const T& value) {
+        T copy(value);
+        return tryPush(std::move(copy));
+    }
+
+    // Consumer side
+    bool tryPop(T& value) {
+        const size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == cachedTail) {
+            cachedTail = tailIndex.load(std::memory_order_acquire);
+            if (head == cachedTail) return false;
+        }
+        value = std::move(slots[head & mask]);
+        headIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t getCapacity() const { return capacity; }
+
+private:
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<T[]> slots;
+
+    // Written by the consumer; cachedTail is its last look at tailIndex
+    alignas(RingCacheLine) std::atomic<size_t> headIndex{ 0 };
+    size_t cachedTail = 0;
+
+    // Written by the producer; cachedHead is its last look at headIndex
+    alignas(RingCacheLine) std::atomic<size_t> tailIndex{ 0 };
+    size_t cachedHead = 0;
+};
+
+// Each slot carries a sequence number telling producers and the consumer
+// whose turn it is, so producers only contend on claiming a position
+template <typename T>
+class MpscRing {
+public:
+    explicit MpscRing(size_t requestedCapacity)
+        : capacity(ringCapacity(requestedCapacity)), mask(capacity - 1), slots(new Slot[capacity]) {
+        for (size_t i = 0; i < capacity; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Any thread
+    bool tryPush(T&& value) {
+        size_t position = tailIndex.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[position & mask];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (lag == 0) {
+                if (tailIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            }
+            else if (lag < 0) {
+                return false; // The consumer has not freed this slot yet: full
+            }
+            else {
+                position = tailIndex.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPush(const T& value) {
+        T copy(value);
+        return tryPush(std::move(copy));
+    }
+
+    // Consumer side
+    bool tryPop(T& value) {
+        Slot& slot = slots[headIndex & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != headIndex + 1) return false;
+        value = std::move(slot.value);
+        slot.sequence.store(headIndex + capacity, std::memory_order_release);
+        ++headIndex;
+        return true;
+    }
+
+    size_t getCapacity() const { return capacity; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    alignas(RingCacheLine) size_t headIndex = 0;  // Consumer only
+    alignas(RingCacheLine) std::atomic<size_t> tailIndex{ 0 };
+};
@@ -0,0 +1,149 @@
+#include "RiskEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double Unlimited = std::numeric_limits<double>::infinity();
+
+} // namespace
+
+const char* riskCheckName(RiskCheck check) {
+    switch (check) {
+    case RiskCheck::Passed: return "passed";
+    case RiskCheck::PositionLimit: return "position limit";
+    case RiskCheck::GrossExposure: return "gross exposure";
+    case RiskCheck::NetExposure: return "net exposure";
+    case RiskCheck::OrderRate: return "order rate";
+    case RiskCheck::KillSwitch: return "kill switch";
+    }
+    return "unknown";
+}
+
+RiskEngine::RiskEngine(const RiskLimits& limits) {
+    setLimits(limits);
+}
+
+void RiskEngine::setLimits(const RiskLimits& newLimits) {
+    if (newLimits.maxPosition < 0 || newLimits.maxGrossExposure < 0 || newLimits.maxNetExposure < 0) {
+        throw std::invalid_argument("Risk limits cannot be negative.");
+    }
+    if (newLimits.maxOrders > 0 && newLimits.orderWindowSeconds <= 0) {
+        throw std::invalid_argument("Order rate window must be positive.");
+    }
+    if (newLimits.maxDrawdown < 0 || newLimits.maxDrawdown >= 1 || newLimits.maxSessionLoss < 0 || newLimits.maxSessionLoss >= 1) {
+        throw std::invalid_argument("Drawdown limits must be in [0, 1).");
+    }
+    limits = newLimits;
+    grossCap = limits.maxGrossExposure > 0 ? limits.maxGrossExposure : Unlimited;
+    netCap = limits.maxNetExposure > 0 ? limits.maxNetExposure : Unlimited;
+    positionCap = limits.maxPosition > 0 ? limits.maxPosition : std::numeric_limits<int>::max();
+
+    // Keep the most recent order times that still fit the new ring, oldest first
+    std::vector<int64_t> recent;
+    for (size_t i = std::min(orderCount, limits.maxOrders); i > 0; --i) {
+        recent.push_back(orderTimes[(nextOrder + orderTimes.size() - i) % orderTimes.size()]);
+    }
+    orderTimes.assign(limits.maxOrders, 0);
+    orderCount = recent.size();
+    std::copy(recent.begin(), recent.end(), orderTimes.begin());
+    nextOrder = limits.maxOrders > 0 ? orderCount % limits.maxOrders : 0;
+}
+
+void RiskEngine::setPositionLimit(const std::string& symbol, int maxShares) {
+    if (maxShares < 0) throw std::invalid_argument("Position limit cannot be negative.");
+    if (maxShares == 0) symbolLimits.erase(symbol);
+    else symbolLimits.insert_or_assign(symbol, maxShares);
+}
+
+int RiskEngine::getPositionLimit(const std::string& symbol) const {
+    auto it = symbolLimits.find(symbol);
+    return it == symbolLimits.end() ? limits.maxPosition : it->second;
+}
+
+// Every limit is evaluated and the failures collected as bits (bit n for
+// RiskCheck n), so the common case of an accepted order is a single branch
+RiskCheck RiskEngine::check(const std::string& symbol, const OrderImpact& impact) const {
+    int cap = positionCap;
+    if (!symbolLimits.empty()) {
+        auto it = symbolLimits.find(symbol);
+        if (it != symbolLimits.end()) cap = it->second;
+    }
+    const int64_t held = std::abs(static_cast<int64_t>(impact.held));
+    const int64_t after = std::abs(static_cast<int64_t>(impact.after));
+    const bool addsRisk = impact.grossAfter > impact.grossBefore || after > held;
+
+    // The oldest of the last maxOrders orders sits at nextOrder once the ring is full
+    const bool rateFull = orderCount == orderTimes.size() && orderCount > 0
+        && impact.time - orderTimes[nextOrder] < limits.orderWindowSeconds;
+
+    const unsigned failed =
+        unsigned(after > cap && after > held) << 1
+        | unsigned(impact.grossAfter > grossCap && impact.grossAfter > impact.grossBefore) << 2
+        | unsigned(std::fabs(impact.netAfter) > netCap && std::fabs(impact.netAfter) > std::fabs(impact.netBefore)) << 3
+        | unsigned(rateFull) << 4
+        | unsigned(halted && addsRisk) << 5;
+    if (failed == 0) return RiskCheck::Passed;
+
+    unsigned bit = 1;
+    while (!(failed & (1u << bit))) ++bit;
+    return static_cast<RiskCheck>(bit);
+}
+
+void RiskEngine::onOrder(int64_t time) {
+    ++accepted;
+    if (orderTimes.empty()) return;
+    orderTimes[nextOrder] = time;
+    nextOrder = (nextOrder + 1) % orderTimes.size();
+    orderCount = std::min(orderCount + 1, orderTimes.size());
+}
+
+void RiskEngine::onEquity(double equity, bool sessionClose) {
+    if (!hasEquity) {
+        hasEquity = true;
+        peakEquity = equity;
+        sessionStartEquity = equity;
+    }
+    peakEquity = std::max(peakEquity, equity);
+    if (limits.maxDrawdown > 0 && equity < peakEquity * (1.0 - limits.maxDrawdown)) halted = true;
+    if (limits.maxSessionLoss > 0 && equity < sessionStartEquity * (1.0 - limits.maxSessionLoss)) halted = true;
+
+    // The next session's loss is measured from this session's close
+    if (sessionClose) sessionStartEquity = equity;
+}
+
+// Order times are saved oldest first, so they can be replayed into a ring of any size
+void RiskEngine::saveState(SnapshotWriter& out) const {
+    std::vector<int64_t> recent;
+    for (size_t i = orderCount; i > 0; --i) recent.push_back(orderTimes[(nextOrder + orderTimes.size() - i) % orderTimes.size()]);
+    out.writeVector(recent);
+    out.write(halted);
+    out.write(hasEquity);
+    out.write(peakEquity);
+    out.write(sessionStartEquity);
+    out.write(accepted);
+    for (uint64_t count : rejections) out.write(count);
+}
+
+void RiskEngine::loadState(SnapshotReader& in) {
+    std::vector<int64_t> recent;
+    in.readVector(recent);
+    std::fill(orderTimes.begin(), orderTimes.end(), 0);
+    nextOrder = 0;
+    orderCount = 0;
+    for (size_t i = recent.size() > orderTimes.size() ? recent.size() - orderTimes.size() : 0; i < recent.size(); ++i) {
+        onOrder(recent[i]);
+    }
+    in.read(halted);
+    in.read(hasEquity);
+    in.read(peakEquity);
+    in.read(sessionStartEquity);
+    in.read(accepted);
+    for (uint64_t& count : rejections) in.read(count);
+}
+
+void RiskEngine::resetKillSwitch() {
+    halted = false;
+    hasEquity = false;
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include "Snapshot.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ---------------------  Pre-Trade Risk  -------------------------------------------
+//
+// Risk layer between strategy signals and the fills of a Portfolio (see
+// Portfolio::setRiskEngine). Every order is checked against:
+//   - per-symbol position limits (|shares|)
+//   - caps on gross and net exposure
+//   - a maximum number of orders per rolling window of bar time
+//   - kill switches on drawdown from peak equity and on the loss within a
+//     session, which, once tripped, block every order that adds exposure
+//     until resetKillSwitch()
+//
+// The checks read the portfolio's running exposure totals (an OrderImpact)
+// rather than its positions, so an order costs the same whether one or
+// thousands of positions are open. All limits are evaluated on every order
+// and combined into one mask, so the accepted path takes a single branch.
+// Orders that shrink a position, or exposure, are never blocked by the
+// corresponding limit, so a book that is over its limits can always be
+// worked down.
+
+enum class RiskCheck : uint8_t {
+    Passed,
+    PositionLimit,
+    GrossExposure,
+    NetExposure,
+    OrderRate,
+    KillSwitch
+};
+
+constexpr size_t RiskCheckCount = 6;
+
+// Short name of a check result ("passed", "position limit", ...)
+const char* riskCheckName(RiskCheck check);
+
+// Unset limits (0) are not enforced
+struct RiskLimits {
+    int maxPosition = 0;              // Shares per symbol, long or short (see also setPositionLimit)
+    double maxGrossExposure = 0.0;    // Long + short value
+    double maxNetExposure = 0.0;      // |Long - short| value
+    size_t maxOrders = 0;             // Orders per orderWindowSeconds of bar time
+    int64_t orderWindowSeconds = 60;
+    double maxDrawdown = 0.0;         // Fraction below peak equity that trips the kill switch
+    double maxSessionLoss = 0.0;      // Fraction below the previous session close that trips it
+};
+
+// What an order would do to the book, with the symbol re-marked at the order price
+struct OrderImpact {
+    int64_t time;         // Bar time of the order (epoch seconds)
+    int held;             // Shares before the order (negative for a short)
+    int after;            // Shares after the order
+    double equity;
+    double grossBefore;
+    double grossAfter;
+    double netBefore;
+    double netAfter;
+};
+
+// Thrown by Portfolio::buy / sell for orders the risk engine rejects
+class RiskViolation : public std::runtime_error {
+public:
+    explicit RiskViolation(RiskCheck check)
+        : std::runtime_error(std::string("Order rejected by risk limits: ") + riskCheckName(check)), check(check) {}
+
+    RiskCheck getCheck() const { return check; }
+
+private:
+    RiskCheck check;
+};
+
+class RiskEngine {
+public:
+    explicit RiskEngine(const RiskLimits& limits = RiskLimits());
+
+    // Replace the limits; the order history and kill switch state are kept
+    void setLimits(const RiskLimits& limits);
+    const RiskLimits& getLimits() const { return limits; }
+
+    // Position limit for one symbol, overriding RiskLimits::maxPosition (0 removes the limit)
+    void setPositionLimit(const std::string& symbol, int maxShares);
+
+    // Position limit that applies to `symbol` (0 if none)
+    int getPositionLimit(const std::string& symbol) const;
+
+    // First limit the order breaks, or RiskCheck::Passed. Does not count the order.
+    RiskCheck check(const std::string& symbol, const OrderImpact& impact) const;
+
+    // Count an order that passed the checks (for the order rate)
+    void onOrder(int64_t time);
+
+    // Count an order that was rejected
+    void onReject(RiskCheck check) { ++rejections[static_cast<size_t>(check)]; }
+
+    // Feed the latest equity; `sessionClose` marks the last bar of a session.
+    // Trips the kill switch when a drawdown limit is breached.
+    void onEquity(double equity, bool sessionClose);
+
+    bool isHalted() const { return halted; }
+    RiskCheck getHaltReason() const { return halted ? RiskCheck::KillSwitch : RiskCheck::Passed; }
+
+    // Re-arm after a kill switch; drawdowns are measured from the current equity again
+    void resetKillSwitch();
+
+    uint64_t getAccepted() const { return accepted; }
+    uint64_t getRejected(RiskCheck check) const { return rejections[static_cast<size_t>(check)]; }
+
+    // Order history, kill switch and counters for a checkpoint. The limits are
+    // configuration and are not saved, so a run can resume under new limits.
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+
+private:
+    RiskLimits limits;
+    double grossCap;   // Limits with 0 replaced by infinity, so every check is one compare
+    double netCap;
+    int positionCap;
+    std::unordered_map<std::string, int> symbolLimits; // Symbols with their own position limit
+
+    std::vector<int64_t> orderTimes; // Ring of the last maxOrders order times
+    size_t nextOrder = 0;
+    size_t orderCount = 0;
+
+    bool halted = false;
+    bool hasEquity = false;
+    double peakEquity = 0.0;
+    double sessionStartEquity = 0.0;
+
+    uint64_t accepted = 0;
+    std::array<uint64_t, RiskCheckCount> rejections{};
+};
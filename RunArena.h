@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+// ---------------------  Run Arena  -------------------------------------------
+//
+// Per-run memory arena for sweeps. Hand resource() to Portfolio and the
+// strategy; all of their containers then allocate from a monotonic buffer
+// with a node pool on top (so erase/insert churn in maps is recycled within
+// the run). reset() drops everything in one go, so the next run on the same
+// thread starts from an empty arena without a single free() per node.
+//
+// Every object allocated from the arena must be destroyed before reset().
+// The arena is not thread-safe; use one per worker thread (see forCurrentThread()).
+class RunArena {
+public:
+    explicit RunArena(size_t initialBytes = 1 << 20)
+        : upstream(std::pmr::new_delete_resource()) {
+        allocateBuffer(initialBytes);
+    }
+
+    RunArena(const RunArena&) = delete;
+    RunArena& operator=(const RunArena&) = delete;
+
+    // Memory resource for per-run containers
+    std::pmr::memory_resource* resource() { return &*pool; }
+
+    // Release everything allocated during the run. If the run overflowed the
+    // initial buffer, the buffer is grown to the run's high-water mark so the
+    // next run of similar size needs no upstream allocations at all.
+    void reset() {
+        const size_t spilled = upstream.bytesAllocated();
+        pool.reset();
+        monotonic.reset();
+        if (spilled > 0) {
+            allocateBuffer(bufferSize + spilled);
+        }
+        else {
+            createResources();
+        }
+    }
+
+    // Bytes reserved in the arena's own buffer
+    size_t capacity() const { return bufferSize; }
+
+    // Arena owned by the calling thread
+    static RunArena& forCurrentThread() {
+        thread_local RunArena arena;
+        return arena;
+    }
+
+private:
+    // Upstream that counts bytes requested once the initial buffer is exhausted
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        explicit CountingResource(std::pmr::memory_resource* parent) : parent(parent) {}
+        size_t bytesAllocated() const { return allocated; }
+        void clear() { allocated = 0; }
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            allocated += bytes;
+            return parent->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            parent->deallocate(p, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        std::pmr::memory_resource* parent;
+        size_t allocated = 0;
+    };
+
+    void allocateBuffer(size_t bytes) {
+        pool.reset();
+        monotonic.reset();
+        buffer.reset(new std::byte[bytes]);
+        bufferSize = bytes;
+        createResources();
+    }
+
+    void createResources() {
+        upstream.clear();
+        monotonic.emplace(buffer.get(), bufferSize, &upstream);
+        pool.emplace(&*monotonic);
+    }
+
+    CountingResource upstream;
+    std::unique_ptr<std::byte[]> buffer;
+    size_t bufferSize = 0;
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic;
+    std::optional<std::pmr::unsynchronized_pool_resource> pool;
+};
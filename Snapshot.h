@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ---------------------  Snapshot Encoding  -------------------------------------------
+//
+// Flat binary encoding for run state (see Checkpoint.h). Values are written
+// as their raw bytes in native (little-endian on every supported platform)
+// layout, strings and vectors as a uint64 count followed by their elements,
+// so saving and restoring a component is a straight copy of its members.
+// Structs with padding are written field by field, keeping uninitialized
+// bytes out of checkpoints and their checksums.
+// Each component writes and reads its fields in the same order; there are
+// no field tags, the checkpoint's version covers the layout as a whole.
+
+class SnapshotWriter {
+public:
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot values must be trivially copyable");
+        append(&value, sizeof(T));
+    }
+
+    void writeString(std::string_view text) {
+        write<uint64_t>(text.size());
+        append(text.data(), text.size());
+    }
+
+    // Any contiguous container of trivially copyable elements (std or pmr vector)
+    template <typename Vector>
+    void writeVector(const Vector& values) {
+        using T = typename Vector::value_type;
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot values must be trivially copyable");
+        write<uint64_t>(values.size());
+        append(values.data(), values.size() * sizeof(T));
+    }
+
+    const std::vector<char>& bytes() const { return buffer; }
+    std::vector<char> take() { return std::move(buffer); }
+
+private:
+    void append(const void* data, size_t size) {
+        const char* first = static_cast<const char*>(data);
+        buffer.insert(buffer.end(), first, first + size);
+    }
+
+    std::vector<char> buffer;
+};
+
+// Reads what a SnapshotWriter wrote; throws std::runtime_error past the end
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, size_t size) : cursor(data), end(data + size) {}
+    explicit SnapshotReader(const std::vector<char>& bytes) : SnapshotReader(bytes.data(), bytes.size()) {}
+
+    template <typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot values must be trivially copyable");
+        T value;
+        copy(&value, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void read(T& value) { value = read<T>(); }
+
+    std::string readString() {
+        const size_t size = count(1);
+        std::string text(cursor, size);
+        cursor += size;
+        return text;
+    }
+
+    template <typename Vector>
+    void readVector(Vector& values) {
+        using T = typename Vector::value_type;
+        values.resize(count(sizeof(T)));
+        copy(values.data(), values.size() * sizeof(T));
+    }
+
+    bool atEnd() const { return cursor == end; }
+
+private:
+    // Element count of a string or vector, checked against the bytes left
+    size_t count(size_t elementBytes) {
+        const uint64_t size = read<uint64_t>();
+        if (elementBytes > 0 && size > static_cast<uint64_t>(end - cursor) / elementBytes) {
+            throw std::runtime_error("Truncated snapshot.");
+        }
+        return static_cast<size_t>(size);
+    }
+
+    void copy(void* target, size_t size) {
+        if (size > static_cast<size_t>(end - cursor)) throw std::runtime_error("Truncated snapshot.");
+        if (size > 0) std::memcpy(target, cursor, size);
+        cursor += size;
+    }
+
+    const char* cursor;
+    const char* end;
+};
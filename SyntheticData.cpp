@@ -0,0 +1,351 @@
+#include "SyntheticData.h"
+#include "BarFile.h"
+#include "Gzip.h"
+#include "ThreadPool.h"
+#include "TimeUtils.h"
+#include <cmath>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr double TradingDaysPerYear = 252.0;
+
+uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** generator. Implemented here rather than using <random>
+// distributions so the output is identical across standard libraries.
+class RandomStream {
+public:
+    RandomStream(uint64_t seed, uint64_t symbol, uint64_t block, uint64_t stream) {
+        uint64_t state = seed ^ (symbol + 1) * 0xD1B54A32D192ED03ULL ^ (block + 1) * 0x8CB92BA72F3D8DD7ULL
+            ^ (stream + 1) * 0xA0761D6478BD642FULL;
+        for (auto& word : s) word = splitMix64(state);
+    }
+
+    uint64_t next() {
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Uniform in (0, 1)
+    double uniform() { return ((next() >> 11) + 0.5) * 0x1.0p-53; }
+
+    // Standard normal (Box-Muller)
+    double normal() {
+        const double radius = std::sqrt(-2.0 * std::log(uniform()));
+        return radius * std::cos(6.283185307179586 * uniform());
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    uint64_t s[4];
+};
+
+// Random streams used by each block. The path stream drives regimes and
+// returns (replayed when planning blocks); the shape stream drives wicks and volume.
+enum Stream : uint64_t { PathStream = 0, ShapeStream = 1 };
+
+// Largest magnitude formatPrice can scale to an int64 of ten-thousandths
+constexpr double MaxFormattedPrice = 9.0e14;
+
+// Write `value` with four decimals and return the end pointer
+char* formatPrice(double value, char* out) {
+    if (!(std::abs(value) < MaxFormattedPrice)) {
+        throw std::out_of_range("Price out of the range that can be written: " + std::to_string(value));
+    }
+    if (value < 0) {
+        *out++ = '-';
+        value = -value;
+    }
+    int64_t scaled = static_cast<int64_t>(value * 10000.0 + 0.5);
+    int64_t whole = scaled / 10000;
+    int fraction = static_cast<int>(scaled % 10000);
+
+    char digits[20];
+    int length = 0;
+    do {
+        digits[length++] = static_cast<char>('0' + whole % 10);
+        whole /= 10;
+    } while (whole > 0);
+    while (length > 0) *out++ = digits[--length];
+
+    *out++ = '.';
+    out[3] = static_cast<char>('0' + fraction % 10);
+    out[2] = static_cast<char>('0' + fraction / 10 % 10);
+    out[1] = static_cast<char>('0' + fraction / 100 % 10);
+    out[0] = static_cast<char>('0' + fraction / 1000);
+    return out + 4;
+}
+
+char* formatInteger(int64_t value, char* out) {
+    if (value < 0) {
+        *out++ = '-';
+        value = -value;
+    }
+    char digits[20];
+    int length = 0;
+    do {
+        digits[length++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (length > 0) *out++ = digits[--length];
+    return out;
+}
+
+// Format a block as CSV rows in the DataModule layout
+std::string formatCSV(const BarColumns& bars) {
+    std::string text(bars.size() * 96, '\0');
+    char* out = text.data();
+    for (size_t i = 0; i < bars.size(); ++i) {
+        out = TimeUtils::formatTimestamp(bars.timestamps[i], out);
+        *out++ = ',';
+        out = formatPrice(bars.open[i], out);
+        *out++ = ',';
+        out = formatPrice(bars.high[i], out);
+        *out++ = ',';
+        out = formatPrice(bars.low[i], out);
+        *out++ = ',';
+        out = formatPrice(bars.close[i], out);
+        *out++ = ',';
+        out = formatInteger(bars.volume[i], out);
+        *out++ = '\n';
+    }
+    text.resize(out - text.data());
+    return text;
+}
+
+} // namespace
+
+// ---------------------  SyntheticDataGenerator  -------------------------------------------
+
+SyntheticDataGenerator::SyntheticDataGenerator(const SyntheticDataConfig& cfg) : config(cfg) {
+    if (config.symbols == 0 || config.blockBars == 0 || config.barsPerSession <= 0 || config.barSeconds <= 0) {
+        throw std::invalid_argument("Symbols, block size, session length and bar interval must be positive.");
+    }
+    if (config.startPrice <= 0 || config.annualVolatility < 0 || config.stressedVolatility < 0) {
+        throw std::invalid_argument("Start price must be positive and volatilities non-negative.");
+    }
+    if (!(config.reversionHalfLifeYears >= 0)) throw std::invalid_argument("Reversion half-life cannot be negative.");
+
+    // Start on a weekday
+    while (TimeUtils::weekday(config.startDay) >= 5) ++config.startDay;
+
+    const double barsPerYear = TradingDaysPerYear * config.barsPerSession;
+    const double annualDrifts[2] = { config.annualDrift, config.stressedDrift };
+    const double annualVolatilities[2] = { config.annualVolatility, config.stressedVolatility };
+    for (int regime = 0; regime < 2; ++regime) {
+        volatility[regime] = annualVolatilities[regime] / std::sqrt(barsPerYear);
+        drift[regime] = (annualDrifts[regime] - 0.5 * annualVolatilities[regime] * annualVolatilities[regime]) / barsPerYear;
+    }
+    anchor = std::log(config.startPrice);
+    retention = config.reversionHalfLifeYears > 0
+        ? std::exp(-std::log(2.0) / (config.reversionHalfLifeYears * barsPerYear)) : 1.0;
+}
+
+std::string SyntheticDataGenerator::symbolName(size_t symbol) const {
+    std::string digits = std::to_string(symbol);
+    return "SYN" + std::string(digits.size() < 4 ? 4 - digits.size() : 0, '0') + digits;
+}
+
+size_t SyntheticDataGenerator::blockCount() const {
+    return (config.barsPerSymbol + config.blockBars - 1) / config.blockBars;
+}
+
+size_t SyntheticDataGenerator::blockSize(size_t block) const {
+    return std::min(config.blockBars, config.barsPerSymbol - block * config.blockBars);
+}
+
+// Weekday sessions of barsPerSession bars each, starting at startDay
+int64_t SyntheticDataGenerator::barTimestamp(size_t bar) const {
+    const int64_t session = static_cast<int64_t>(bar / config.barsPerSession);
+    const int64_t barInSession = static_cast<int64_t>(bar % config.barsPerSession);
+    const int64_t startWeekday = TimeUtils::weekday(config.startDay);
+    const int64_t tradingDay = session + startWeekday;
+    const int64_t calendarDay = config.startDay - startWeekday + tradingDay / 5 * 7 + tradingDay % 5;
+    return calendarDay * TimeUtils::SecondsPerDay + config.sessionStartMinute * TimeUtils::SecondsPerMinute
+        + barInSession * config.barSeconds;
+}
+
+// Price paths must be continuous across blocks, so each block's starting log
+// price and regime depend on every earlier block. Blocks are first simulated in
+// parallel from each possible starting regime from a log price at the anchor,
+// recording where it ends and the final regime. As a bar's step is linear in
+// the log price, a block starting `d` away from the anchor ends retention^n * d
+// further from where that simulation ended, and a cheap sequential scan then
+// picks the actual starts.
+std::vector<SyntheticDataGenerator::BlockStart> SyntheticDataGenerator::planBlocks(size_t symbol, ThreadPool& pool) const {
+    const bool switching = config.model == PriceModel::RegimeSwitching;
+    const int startRegimes = switching ? 2 : 1;
+    const size_t blocks = blockCount();
+
+    struct BlockSummary {
+        double endLogPrice[2];   // Starting from the anchor
+        int endRegime[2];
+    };
+    std::vector<BlockSummary> summaries(blocks);
+
+    pool.parallelFor(blocks, [&](size_t block) {
+        for (int startRegime = 0; startRegime < startRegimes; ++startRegime) {
+            RandomStream path(config.seed, symbol, block, PathStream);
+            int regime = startRegime;
+            double logPrice = anchor;
+            for (size_t i = 0, count = blockSize(block); i < count; ++i) {
+                if (switching && path.uniform() < (regime == 0 ? config.calmToStressed : config.stressedToCalm)) {
+                    regime ^= 1;
+                }
+                logPrice = step(logPrice, regime, path.normal());
+            }
+            summaries[block].endLogPrice[startRegime] = logPrice;
+            summaries[block].endRegime[startRegime] = regime;
+        }
+    });
+
+    std::vector<BlockStart> starts(blocks);
+    BlockStart current{ anchor, 0 };
+    for (size_t block = 0; block < blocks; ++block) {
+        starts[block] = current;
+        const double decay = std::pow(retention, static_cast<double>(blockSize(block)));
+        current.logPrice = summaries[block].endLogPrice[current.regime] + (current.logPrice - anchor) * decay;
+        current.regime = summaries[block].endRegime[current.regime];
+    }
+    return starts;
+}
+
+// Generate one block's bars. Replays the same path stream as planBlocks.
+void SyntheticDataGenerator::generateBlock(size_t symbol, size_t block, const BlockStart& start, BarColumns& out) const {
+    const bool switching = config.model == PriceModel::RegimeSwitching;
+    const size_t count = blockSize(block);
+    const size_t firstBar = block * config.blockBars;
+
+    RandomStream path(config.seed, symbol, block, PathStream);
+    RandomStream shape(config.seed, symbol, block, ShapeStream);
+    out.resize(count);
+
+    int regime = start.regime;
+    double logPrice = start.logPrice;
+    double open = std::exp(logPrice);
+    for (size_t i = 0; i < count; ++i) {
+        if (switching && path.uniform() < (regime == 0 ? config.calmToStressed : config.stressedToCalm)) {
+            regime ^= 1;
+        }
+        logPrice = step(logPrice, regime, path.normal());
+        const double close = std::exp(logPrice);
+        const double wickUp = std::abs(shape.normal()) * volatility[regime] * 0.5;
+        const double wickDown = std::abs(shape.normal()) * volatility[regime] * 0.5;
+
+        out.timestamps[i] = barTimestamp(firstBar + i);
+        out.open[i] = open;
+        out.close[i] = close;
+        out.high[i] = std::max(open, close) * std::exp(wickUp);
+        out.low[i] = std::min(open, close) * std::exp(-wickDown);
+        out.volume[i] = static_cast<int64_t>(config.baseVolume * std::exp(0.5 * shape.normal()) * (regime + 1));
+        open = close;
+    }
+}
+
+// Generate every bar of one symbol into memory
+BarColumns SyntheticDataGenerator::generate(size_t symbol) const {
+    if (symbol >= config.symbols) throw std::out_of_range("Symbol index out of range.");
+
+    ThreadPool pool(config.threads);
+    BarColumns bars;
+    bars.reserve(config.barsPerSymbol);
+    writeSymbol(symbol, pool, [](BarColumns&& block) { return std::move(block); },
+        [&bars](BarColumns&& block) {
+            bars.timestamps.insert(bars.timestamps.end(), block.timestamps.begin(), block.timestamps.end());
+            bars.open.insert(bars.open.end(), block.open.begin(), block.open.end());
+            bars.high.insert(bars.high.end(), block.high.begin(), block.high.end());
+            bars.low.insert(bars.low.end(), block.low.begin(), block.low.end());
+            bars.close.insert(bars.close.end(), block.close.begin(), block.close.end());
+            bars.volume.insert(bars.volume.end(), block.volume.begin(), block.volume.end());
+        });
+    return bars;
+}
+
+template <typename Transform, typename Sink>
+void SyntheticDataGenerator::writeSymbol(size_t symbol, ThreadPool& pool, Transform transform, Sink sink) const {
+    using Result = decltype(transform(std::declval<BarColumns&&>()));
+    const std::vector<BlockStart> starts = planBlocks(symbol, pool);
+
+    // Keep a bounded window of blocks in flight so memory stays flat at any size
+    const size_t window = 2 * pool.size();
+    std::deque<std::future<Result>> inFlight;
+    for (size_t block = 0; block < starts.size() || !inFlight.empty();) {
+        while (block < starts.size() && inFlight.size() < window) {
+            inFlight.push_back(pool.submit([this, symbol, block, &starts, &transform]() {
+                BarColumns bars;
+                generateBlock(symbol, block, starts[block], bars);
+                return transform(std::move(bars));
+            }));
+            ++block;
+        }
+        sink(inFlight.front().get());
+        inFlight.pop_front();
+    }
+}
+
+// Write one CSV per symbol in the DataModule format
+std::vector<std::string> SyntheticDataGenerator::writeCSV(const std::string& directory, bool compress) const {
+    std::filesystem::create_directories(directory);
+    ThreadPool pool(config.threads);
+    std::vector<std::string> paths;
+
+    for (size_t symbol = 0; symbol < config.symbols; ++symbol) {
+        const std::string name = symbolName(symbol) + (compress ? ".csv.gz" : ".csv");
+        const std::string path = (std::filesystem::path(directory) / name).string();
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) throw std::runtime_error("Failed to create CSV file: " + path);
+
+        const std::string header = "date,open,high,low,close,volume\n";
+        auto write = [&file](std::string&& text) { file.write(text.data(), text.size()); };
+        if (compress) {
+            // Every block becomes its own gzip member, compressed on the worker that generated it
+            write(Gzip::compress(header.data(), header.size()));
+            writeSymbol(symbol, pool, [](BarColumns&& block) {
+                const std::string text = formatCSV(block);
+                return Gzip::compress(text.data(), text.size());
+            }, write);
+        }
+        else {
+            write(std::string(header));
+            writeSymbol(symbol, pool, formatCSV, write);
+        }
+        if (!file) throw std::runtime_error("Failed to write CSV file: " + path);
+        paths.push_back(path);
+    }
+    return paths;
+}
+
+// Write one binary bar file per symbol
+std::vector<std::string> SyntheticDataGenerator::writeBinary(const std::string& directory,
+                                                             BarCompression compression) const {
+    std::filesystem::create_directories(directory);
+    ThreadPool pool(config.threads);
+    std::vector<std::string> paths;
+
+    for (size_t symbol = 0; symbol < config.symbols; ++symbol) {
+        const std::string path = (std::filesystem::path(directory) / (symbolName(symbol) + ".bin")).string();
+        BarFileWriter writer(path, symbolName(symbol), static_cast<uint32_t>(config.blockBars), compression);
+        writeSymbol(symbol, pool, [](BarColumns&& block) { return std::move(block); },
+            [&writer](BarColumns&& block) { writer.write(block); });
+        writer.close();
+        paths.push_back(path);
+    }
+    return paths;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "BarFile.h"
+#include "TimeSeries.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// ---------------------  Synthetic Market Data  -------------------------------------------
+//
+// Deterministic OHLCV generator for scale testing. Bars are produced in
+// fixed-size blocks, each drawing from its own random stream derived from
+// (seed, symbol, block), so the output is identical for a given seed no
+// matter how many threads generate it.
+//
+// The log price is pulled back towards log(startPrice) (an Ornstein-Uhlenbeck
+// term with a configurable half-life), so prices stay in a bounded range at
+// any length: with pure drift, 100M one-minute bars would compound the
+// default 7% a year into a price around 1e24. The pull is linear in the log
+// price, which keeps the parallel block planning exact.
+
+enum class PriceModel {
+    GeometricBrownianMotion, // Constant drift and volatility
+    RegimeSwitching          // Two-state Markov chain between a calm and a stressed regime
+};
+
+struct SyntheticDataConfig {
+    PriceModel model = PriceModel::GeometricBrownianMotion;
+    size_t symbols = 1;                 // Number of independent symbols
+    size_t barsPerSymbol = 1000000;     // Bars generated for each symbol
+    uint64_t seed = 42;                 // Random seed; same seed -> same data
+
+    double startPrice = 100.0;
+    double annualDrift = 0.07;          // Calm regime (and GBM) drift
+    double annualVolatility = 0.20;     // Calm regime (and GBM) volatility
+    double stressedDrift = -0.30;       // Stressed regime drift
+    double stressedVolatility = 0.60;   // Stressed regime volatility
+    double calmToStressed = 0.0002;     // Per-bar probability of entering the stressed regime
+    double stressedToCalm = 0.002;      // Per-bar probability of leaving the stressed regime
+    double reversionHalfLifeYears = 10.0; // Half-life of the log price's pull towards startPrice (0 = none, unbounded)
+
+    int64_t startDay = 10959;           // First session, in days since 1970-01-01 (2000-01-03)
+    int sessionStartMinute = 570;       // Session open as minutes after midnight (09:30)
+    int barsPerSession = 390;           // Bars per weekday session
+    int barSeconds = 60;                // Bar interval
+    int64_t baseVolume = 100000;        // Median bar volume in the calm regime
+
+    size_t blockBars = 65536;           // Bars per generation block
+    size_t threads = 0;                 // Worker threads (0 = hardware concurrency)
+};
+
+class SyntheticDataGenerator {
+public:
+    explicit SyntheticDataGenerator(const SyntheticDataConfig& config);
+
+    const SyntheticDataConfig& getConfig() const { return config; }
+
+    // Symbol name for an index ("SYN0000", "SYN0001", ...)
+    std::string symbolName(size_t symbol) const;
+
+    // Generate every bar of one symbol into memory
+    BarColumns generate(size_t symbol) const;
+
+    // Write one CSV per symbol (<directory>/<symbol>.csv) in the DataModule format.
+    // With `compress` the files are gzip-compressed (<symbol>.csv.gz), one gzip
+    // member per generation block. Returns the paths written.
+    std::vector<std::string> writeCSV(const std::string& directory, bool compress = false) const;
+
+    // Write one binary bar file per symbol (<directory>/<symbol>.bin). Returns the paths written.
+    std::vector<std::string> writeBinary(const std::string& directory,
+                                         BarCompression compression = BarCompression::None) const;
+
+private:
+    // Price and regime at the first bar of a block
+    struct BlockStart {
+        double logPrice;
+        int regime;
+    };
+
+    // Log price after one bar, from the log price before it
+    double step(double logPrice, int regime, double shock) const {
+        return anchor + (logPrice - anchor) * retention + drift[regime] + volatility[regime] * shock;
+    }
+
+    size_t blockCount() const;
+    size_t blockSize(size_t block) const;
+    int64_t barTimestamp(size_t bar) const;
+    std::vector<BlockStart> planBlocks(size_t symbol, ThreadPool& pool) const;
+    void generateBlock(size_t symbol, size_t block, const BlockStart& start, BarColumns& out) const;
+
+    // Generate a symbol's blocks on the pool, apply `transform` to each block on
+    // the worker and hand the results to `sink` in block order on the caller's thread
+    template <typename Transform, typename Sink>
+    void writeSymbol(size_t symbol, ThreadPool& pool, Transform transform, Sink sink) const;
+
+    SyntheticDataConfig config;
+    double drift[2];      // Per-bar log drift by regime
+    double volatility[2]; // Per-bar volatility by regime
+    double anchor;        // log(startPrice), the level the log price reverts to
+    double retention;     // Share of the log price's distance from `anchor` kept each bar
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// ---------------------  Thread Pool  -------------------------------------------
+//
+// Fixed-size pool of worker threads consuming a FIFO task queue. Tasks are
+// submitted as callables and their results (or exceptions) are returned
+// through std::future.
+class ThreadPool {
+public:
+    // threadCount == 0 uses the number of hardware threads
+    explicit ThreadPool(size_t threadCount = 0) {
+        if (threadCount == 0) threadCount = defaultThreadCount();
+        workers.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // Queue a task and return a future for its result
+    template <typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<F>> {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace([packaged]() { (*packaged)(); });
+        }
+        wakeup.notify_one();
+        return result;
+    }
+
+    // Run body(i) for every i in [0, count) and wait for completion.
+    // Once all iterations have finished, the first exception thrown is rethrown.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body) {
+        std::vector<std::future<void>> pending;
+        pending.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            pending.push_back(submit([&body, i]() { body(i); }));
+        }
+        for (auto& task : pending) task.wait();
+        for (auto& task : pending) task.get();
+    }
+
+    static size_t defaultThreadCount() {
+        return std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+private:
+    void workerLoop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeup.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+};
@@ -0,0 +1,128 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct TimeSeriesData {
+    double open;
+    double high;
+    double low;
+    double close;
+    int64_t volume;
+
+    // Convert to a market data format suitable for portfolio updates
+    std::unordered_map<std::string, double> toMarketData() const {
+        return {
+            {"Open", open},
+            {"High", high},
+            {"Low", low},
+            {"Close", close}
+        };
+    }
+};
+
+// Column-oriented block of bars. Timestamps are seconds since the epoch
+// (see TimeUtils.h); every column has the same length.
+struct BarColumns {
+    std::vector<int64_t> timestamps;
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<int64_t> volume;
+
+    size_t size() const { return timestamps.size(); }
+    bool empty() const { return timestamps.empty(); }
+
+    void reserve(size_t count) {
+        timestamps.reserve(count);
+        open.reserve(count);
+        high.reserve(count);
+        low.reserve(count);
+        close.reserve(count);
+        volume.reserve(count);
+    }
+
+    void resize(size_t count) {
+        timestamps.resize(count);
+        open.resize(count);
+        high.resize(count);
+        low.resize(count);
+        close.resize(count);
+        volume.resize(count);
+    }
+
+    void clear() {
+        timestamps.clear();
+        open.clear();
+        high.clear();
+        low.clear();
+        close.clear();
+        volume.clear();
+    }
+
+    void push_back(int64_t timestamp, const TimeSeriesData& bar) {
+        timestamps.push_back(timestamp);
+        open.push_back(bar.open);
+        high.push_back(bar.high);
+        low.push_back(bar.low);
+        close.push_back(bar.close);
+        volume.push_back(bar.volume);
+    }
+
+    // Row view of a single bar
+    TimeSeriesData at(size_t index) const {
+        return { open[index], high[index], low[index], close[index], volume[index] };
+    }
+};
+
+// Zero-copy view of a contiguous range of bars in a BarColumns. The view
+// points into the columns' storage, so it is invalidated when they change
+// (for example when more data is loaded into the DataModule that owns them).
+//
+// A view may carry adjustment factors (see CorporateActions.h). The column
+// pointers always address the raw values; at() and code that honors the
+// factors (the resampler, CorporateActions::materialize) scale them.
+struct BarView {
+    const int64_t* timestamps = nullptr;
+    const double* open = nullptr;
+    const double* high = nullptr;
+    const double* low = nullptr;
+    const double* close = nullptr;
+    const int64_t* volume = nullptr;
+    size_t count = 0;
+    double priceFactor = 1.0;   // Applied to open/high/low/close
+    double volumeFactor = 1.0;  // Applied to volume
+
+    BarView() = default;
+    BarView(const BarColumns& bars) : BarView(bars, 0, bars.size()) {}
+    BarView(const BarColumns& bars, size_t first, size_t length)
+        : timestamps(bars.timestamps.data() + first), open(bars.open.data() + first),
+          high(bars.high.data() + first), low(bars.low.data() + first), close(bars.close.data() + first),
+          volume(bars.volume.data() + first), count(length) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Bars [first, first + length) of this view
+    BarView subview(size_t first, size_t length) const {
+        BarView view = *this;
+        view.timestamps += first;
+        view.open += first;
+        view.high += first;
+        view.low += first;
+        view.close += first;
+        view.volume += first;
+        view.count = length;
+        return view;
+    }
+
+    // Row view of a single bar, adjusted by the view's factors
+    TimeSeriesData at(size_t index) const {
+        const int64_t rawVolume = volume[index];
+        return { open[index] * priceFactor, high[index] * priceFactor, low[index] * priceFactor, close[index] * priceFactor,
+            volumeFactor == 1.0 ? rawVolume : std::llround(static_cast<double>(rawVolume) * volumeFactor) };
+    }
+};
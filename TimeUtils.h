@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// ---------------------  Time Utilities  -------------------------------------------
+//
+// Timestamps are handled as seconds since 1970-01-01 00:00:00 in the exchange's
+// local time (no time zone conversion). Text form is "YYYY-MM-DD HH:MM:SS",
+// matching the date column of the CSV datasets.
+namespace TimeUtils {
+
+constexpr int64_t SecondsPerMinute = 60;
+constexpr int64_t SecondsPerDay = 86400;
+
+// Days since 1970-01-01 for a civil date (Howard Hinnant's algorithm)
+inline int64_t daysFromCivil(int year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(year - era * 400);
+    const unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// Civil date for a day count since 1970-01-01
+inline void civilFromDays(int64_t days, int& year, unsigned& month, unsigned& day) {
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<int>(yoe + era * 400 + (month <= 2));
+}
+
+// Day of week for a day count since 1970-01-01 (0 = Monday ... 6 = Sunday)
+inline int weekday(int64_t days) {
+    int64_t w = (days + 3) % 7;
+    return static_cast<int>(w < 0 ? w + 7 : w);
+}
+
+// Floor division of a timestamp into whole days
+inline int64_t dayOf(int64_t epochSeconds) {
+    int64_t days = epochSeconds / SecondsPerDay;
+    return (epochSeconds % SecondsPerDay < 0) ? days - 1 : days;
+}
+
+// Write "YYYY-MM-DD HH:MM:SS" (19 characters, not null-terminated) and return the end pointer
+inline char* formatTimestamp(int64_t epochSeconds, char* out) {
+    const int64_t days = dayOf(epochSeconds);
+    int64_t secondOfDay = epochSeconds - days * SecondsPerDay;
+    int year;
+    unsigned month, day;
+    civilFromDays(days, year, month, day);
+
+    auto put2 = [](char* p, unsigned value) {
+        p[0] = static_cast<char>('0' + value / 10);
+        p[1] = static_cast<char>('0' + value % 10);
+    };
+    const unsigned y = static_cast<unsigned>(year);
+    out[0] = static_cast<char>('0' + (y / 1000) % 10);
+    out[1] = static_cast<char>('0' + (y / 100) % 10);
+    put2(out + 2, y % 100);
+    out[4] = '-';
+    put2(out + 5, month);
+    out[7] = '-';
+    put2(out + 8, day);
+    out[10] = ' ';
+    put2(out + 11, static_cast<unsigned>(secondOfDay / 3600));
+    out[13] = ':';
+    put2(out + 14, static_cast<unsigned>(secondOfDay / 60 % 60));
+    out[16] = ':';
+    put2(out + 17, static_cast<unsigned>(secondOfDay % 60));
+    return out + 19;
+}
+
+inline std::string toString(int64_t epochSeconds) {
+    char buffer[19];
+    formatTimestamp(epochSeconds, buffer);
+    return std::string(buffer, sizeof(buffer));
+}
+
+// Parse "YYYY-MM-DD", "YYYY-MM-DD HH:MM" or "YYYY-MM-DD HH:MM:SS" ('T' is also
+// accepted as the separator). Returns false if the text is not a valid timestamp.
+inline bool parseTimestamp(const char* first, const char* last, int64_t& epochSeconds) {
+    auto digits = [](const char* p, int count, unsigned& value) {
+        value = 0;
+        for (int i = 0; i < count; ++i) {
+            if (p[i] < '0' || p[i] > '9') return false;
+            value = value * 10 + static_cast<unsigned>(p[i] - '0');
+        }
+        return true;
+    };
+
+    const auto length = last - first;
+    unsigned year, month, day, hour = 0, minute = 0, second = 0;
+    if (length < 10 || first[4] != '-' || first[7] != '-') return false;
+    if (!digits(first, 4, year) || !digits(first + 5, 2, month) || !digits(first + 8, 2, day)) return false;
+    if (length > 10) {
+        if (length < 16 || (first[10] != ' ' && first[10] != 'T') || first[13] != ':') return false;
+        if (!digits(first + 11, 2, hour) || !digits(first + 14, 2, minute)) return false;
+        if (length > 16) {
+            if (length != 19 || first[16] != ':' || !digits(first + 17, 2, second)) return false;
+        }
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) return false;
+
+    epochSeconds = daysFromCivil(static_cast<int>(year), month, day) * SecondsPerDay
+        + hour * 3600 + minute * 60 + second;
+    return true;
+}
+
+inline bool parseTimestamp(const std::string& text, int64_t& epochSeconds) {
+    return parseTimestamp(text.data(), text.data() + text.size(), epochSeconds);
+}
+
+} // namespace TimeUtils
@@ -0,0 +1,299 @@
+#include "TradeLedger.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char JournalMagic[8] = { 'B', 'T', 'T', 'R', 'A', 'D', 'E', 'S' };
+constexpr uint32_t JournalVersion = 1;
+
+size_t journalBytes(size_t records) {
+    return sizeof(TradeJournalHeader) + records * sizeof(TradeRecord);
+}
+
+} // namespace
+
+// ---------------------  MappedFile  -------------------------------------------
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::open(const std::string& filePath, bool writeAccess, size_t bytes) {
+    close();
+    path = filePath;
+    writable = writeAccess;
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, nullptr,
+        writable ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) throw std::runtime_error("Failed to open file: " + path);
+    file = handle;
+    if (!writable) {
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(handle, &fileSize);
+        bytes = static_cast<size_t>(fileSize.QuadPart);
+    }
+#else
+    descriptor = writable ? ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) : ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) throw std::runtime_error("Failed to open file: " + path);
+    if (!writable) {
+        struct stat status;
+        if (fstat(descriptor, &status) != 0) {
+            ::close(descriptor);
+            descriptor = -1;
+            throw std::runtime_error("Failed to read file size: " + path);
+        }
+        bytes = static_cast<size_t>(status.st_size);
+    }
+#endif
+    opened = true;
+    try {
+        if (writable) resize(bytes);
+        else {
+            length = bytes;
+            map();
+        }
+    }
+    catch (...) {
+        close();
+        throw;
+    }
+}
+
+void MappedFile::resize(size_t bytes) {
+    if (!writable) throw std::logic_error("Cannot resize a read-only mapping.");
+    unmap();
+#ifdef _WIN32
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(bytes);
+    if (!SetFilePointerEx(file, position, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+        throw std::runtime_error("Failed to resize file: " + path);
+    }
+#else
+    if (ftruncate(descriptor, static_cast<off_t>(bytes)) != 0) throw std::runtime_error("Failed to resize file: " + path);
+#endif
+    length = bytes;
+    map();
+}
+
+void MappedFile::map() {
+    if (length == 0) return;
+#ifdef _WIN32
+    mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) throw std::runtime_error("Failed to map file: " + path);
+    address = static_cast<char*>(MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, length));
+    if (!address) throw std::runtime_error("Failed to map file: " + path);
+#else
+    void* mapped = mmap(nullptr, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, descriptor, 0);
+    if (mapped == MAP_FAILED) throw std::runtime_error("Failed to map file: " + path);
+    address = static_cast<char*>(mapped);
+#endif
+}
+
+void MappedFile::unmap() {
+#ifdef _WIN32
+    if (address) UnmapViewOfFile(address);
+    if (mapping) CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    if (address) munmap(address, length);
+#endif
+    address = nullptr;
+}
+
+void MappedFile::sync() {
+    if (!address || !writable) return;
+#ifdef _WIN32
+    FlushViewOfFile(address, length);
+#else
+    msync(address, length, MS_SYNC);
+#endif
+}
+
+void MappedFile::close() {
+    if (!opened) return;
+    unmap();
+#ifdef _WIN32
+    CloseHandle(file);
+    file = nullptr;
+#else
+    ::close(descriptor);
+    descriptor = -1;
+#endif
+    opened = false;
+    length = 0;
+}
+
+// ---------------------  TradeJournalWriter  -------------------------------------------
+
+TradeJournalWriter::TradeJournalWriter(const std::string& path, size_t initialCapacity)
+    : capacity(std::max<size_t>(initialCapacity, 1)) {
+    file.open(path, true, journalBytes(capacity));
+    TradeJournalHeader& h = header();
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, JournalMagic, sizeof(h.magic));
+    h.version = JournalVersion;
+    h.recordBytes = sizeof(TradeRecord);
+}
+
+TradeJournalWriter::~TradeJournalWriter() {
+    try {
+        close();
+    }
+    catch (...) {
+        // Destructors must not throw; the file keeps its provisional size
+    }
+}
+
+void TradeJournalWriter::setSymbol(uint16_t id, const std::string& symbol) {
+    if (id >= TradeJournalHeader::MaxSymbols) throw std::runtime_error("Too many symbols for a trade journal.");
+    TradeJournalHeader& h = header();
+    std::memset(h.symbols[id], 0, TradeJournalHeader::SymbolBytes);
+    std::memcpy(h.symbols[id], symbol.data(), std::min(symbol.size(), TradeJournalHeader::SymbolBytes - 1));
+    h.symbolCount = std::max<uint32_t>(h.symbolCount, id + 1u);
+}
+
+void TradeJournalWriter::append(const TradeRecord& record) {
+    if (!file.isOpen()) throw std::logic_error("Trade journal is closed.");
+    size_t count = static_cast<size_t>(header().count);
+    if (count == capacity) {
+        capacity *= 2;
+        file.resize(journalBytes(capacity));
+    }
+    std::memcpy(file.data() + journalBytes(count), &record, sizeof(TradeRecord));
+    header().count = count + 1; // Publish only once the record is in place
+}
+
+size_t TradeJournalWriter::size() const {
+    return file.isOpen() ? static_cast<size_t>(header().count) : 0;
+}
+
+void TradeJournalWriter::flush() {
+    file.sync();
+}
+
+void TradeJournalWriter::close() {
+    if (!file.isOpen()) return;
+    file.resize(journalBytes(static_cast<size_t>(header().count)));
+    file.sync();
+    file.close();
+}
+
+// ---------------------  TradeJournalReader  -------------------------------------------
+
+TradeJournalReader::TradeJournalReader(const std::string& path) {
+    file.open(path, false);
+    if (file.size() < sizeof(TradeJournalHeader)) throw std::runtime_error("Not a trade journal: " + path);
+    const auto& h = *reinterpret_cast<const TradeJournalHeader*>(file.data());
+    if (std::memcmp(h.magic, JournalMagic, sizeof(JournalMagic)) != 0) throw std::runtime_error("Not a trade journal: " + path);
+    if (h.version != JournalVersion || h.recordBytes != sizeof(TradeRecord)) {
+        throw std::runtime_error("Unsupported trade journal version: " + path);
+    }
+    // A journal left by a crashed run is longer than its count; never read past the file
+    count = static_cast<size_t>(std::min<uint64_t>(h.count, (file.size() - sizeof(TradeJournalHeader)) / sizeof(TradeRecord)));
+    records = reinterpret_cast<const TradeRecord*>(file.data() + sizeof(TradeJournalHeader));
+}
+
+std::string TradeJournalReader::symbol(uint16_t id) const {
+    const auto& h = *reinterpret_cast<const TradeJournalHeader*>(file.data());
+    if (id >= h.symbolCount || id >= TradeJournalHeader::MaxSymbols) return std::string();
+    const char* name = h.symbols[id];
+    return std::string(name, strnlen(name, TradeJournalHeader::SymbolBytes));
+}
+
+// ---------------------  TradeLedger  -------------------------------------------
+
+TradeLedger::TradeLedger(std::pmr::memory_resource* resource)
+    : records(resource), symbols(resource), ids(resource) {}
+
+void TradeLedger::record(int64_t timestamp, const std::string& symbol, TradeSide side, int quantity, double price, double cashAfter) {
+    TradeRecord entry;
+    entry.timestamp = timestamp;
+    entry.price = price;
+    entry.cashAfter = cashAfter;
+    entry.quantity = quantity;
+    entry.symbolId = intern(symbol);
+    entry.side = side;
+    entry.reserved = 0;
+    records.push_back(entry);
+    if (journal) journal->append(entry);
+}
+
+void TradeLedger::attachJournal(TradeJournalWriter* target) {
+    journal = target;
+    if (!journal) return;
+    for (size_t id = 0; id < symbols.size(); ++id) {
+        journal->setSymbol(static_cast<uint16_t>(id), std::string(symbols[id]));
+    }
+}
+
+void TradeLedger::saveState(SnapshotWriter& out) const {
+    out.writeVector(records);
+    saveSymbols(out);
+}
+
+void TradeLedger::loadState(SnapshotReader& in) {
+    in.readVector(records);
+    loadSymbols(in);
+}
+
+void TradeLedger::saveSymbols(SnapshotWriter& out) const {
+    out.write<uint64_t>(symbols.size());
+    for (const std::pmr::string& name : symbols) out.writeString(name);
+}
+
+void TradeLedger::loadSymbols(SnapshotReader& in) {
+    symbols.clear();
+    ids.clear();
+    lastId = 0;
+    const uint64_t count = in.read<uint64_t>();
+    if (count > std::numeric_limits<uint16_t>::max() + 1ull) throw std::runtime_error("Corrupt trade ledger snapshot.");
+    for (uint64_t id = 0; id < count; ++id) {
+        std::pmr::string name(in.readString(), symbols.get_allocator());
+        ids.emplace(name, static_cast<uint16_t>(id));
+        symbols.push_back(std::move(name));
+        if (journal) journal->setSymbol(static_cast<uint16_t>(id), std::string(symbols.back()));
+    }
+}
+
+void TradeLedger::prependRecords(const std::vector<std::pair<const TradeLedger*, size_t>>& prefixes) {
+    size_t total = records.size();
+    for (const auto& [prefix, count] : prefixes) total += count;
+    std::pmr::vector<TradeRecord> joined(records.get_allocator());
+    joined.reserve(std::max(total, records.capacity()));
+    for (const auto& [prefix, count] : prefixes) joined.insert(joined.end(), prefix->begin(), prefix->begin() + count);
+    joined.insert(joined.end(), records.begin(), records.end());
+    records = std::move(joined);
+}
+
+// Id of `symbol`, adding it on first use. Runs usually trade one symbol, so
+// the last id is checked before the hash lookup.
+uint16_t TradeLedger::intern(const std::string& symbol) {
+    if (lastId < symbols.size() && std::string_view(symbols[lastId]) == symbol) return lastId;
+
+    std::pmr::string key(symbol, symbols.get_allocator());
+    auto it = ids.find(key);
+    if (it != ids.end()) return lastId = it->second;
+
+    if (symbols.size() > std::numeric_limits<uint16_t>::max()) throw std::runtime_error("Too many symbols in trade ledger.");
+    const uint16_t id = static_cast<uint16_t>(symbols.size());
+    symbols.push_back(key);
+    ids.emplace(std::move(key), id);
+    if (journal) journal->setSymbol(id, symbol);
+    return lastId = id;
+}
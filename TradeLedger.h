@@ -0,0 +1,196 @@
+#pragma once
+#include "Snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ---------------------  Trade Ledger  -------------------------------------------
+//
+// Append-only record of every fill in a run. Records are fixed-size (32 bytes)
+// and live in one contiguous array allocated from the run's memory resource,
+// so trade analytics are a linear scan and a sweep's ledgers come out of its
+// RunArena. Symbols are interned into 16-bit ids.
+//
+// A TradeJournalWriter can be attached to mirror the fills into a
+// memory-mapped file, so a run's trades can be inspected afterward (with
+// TradeJournalReader) without rerunning it. File layout (little-endian):
+//
+//   TradeJournalHeader (4096 bytes, including the symbol table)
+//   repeated: TradeRecord
+//
+// The header's record count is updated with every append, so a journal is
+// readable up to the last fill even if the process dies mid-run.
+
+enum class TradeSide : uint8_t { Buy = 0, Sell = 1 };
+
+struct TradeRecord {
+    int64_t timestamp;  // Bar time of the fill (epoch seconds, see TimeUtils.h)
+    double price;       // Fill price per share
+    double cashAfter;   // Cash balance after the fill
+    int32_t quantity;   // Shares filled (positive)
+    uint16_t symbolId;  // See TradeLedger::symbol()
+    TradeSide side;
+    uint8_t reserved;
+};
+static_assert(sizeof(TradeRecord) == 32, "TradeRecord must be 32 bytes");
+
+struct TradeJournalHeader {
+    static constexpr size_t MaxSymbols = 254;
+    static constexpr size_t SymbolBytes = 16;
+
+    char magic[8];           // "BTTRADES"
+    uint32_t version;        // Format version (currently 1)
+    uint32_t recordBytes;    // sizeof(TradeRecord)
+    uint64_t count;          // Records in the file
+    uint32_t symbolCount;
+    uint32_t reserved;
+    char symbols[MaxSymbols][SymbolBytes]; // Null-padded names by symbol id
+};
+static_assert(sizeof(TradeJournalHeader) == 4096, "TradeJournalHeader must be 4096 bytes");
+
+// Read/write mapping of a whole file (POSIX mmap or a Win32 file mapping)
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map an existing file read-only, or create (truncating) a writable one
+    // of `bytes` bytes. Throws std::runtime_error on failure.
+    void open(const std::string& path, bool writable, size_t bytes = 0);
+
+    // Grow or shrink a writable file and remap it; data() may move
+    void resize(size_t bytes);
+
+    // Write dirty pages back to the file
+    void sync();
+
+    void close();
+
+    char* data() const { return address; }
+    size_t size() const { return length; }
+    bool isOpen() const { return opened; }
+
+private:
+    void map();
+    void unmap();
+
+    std::string path;
+    bool opened = false;
+    bool writable = false;
+    char* address = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#else
+    int descriptor = -1;
+#endif
+};
+
+class TradeJournalWriter {
+public:
+    static constexpr size_t DefaultCapacity = 65536;
+
+    // Create (or truncate) the journal with room for `capacity` records; it
+    // doubles whenever it fills up. Throws std::runtime_error on failure.
+    explicit TradeJournalWriter(const std::string& path, size_t capacity = DefaultCapacity);
+    ~TradeJournalWriter();
+
+    TradeJournalWriter(const TradeJournalWriter&) = delete;
+    TradeJournalWriter& operator=(const TradeJournalWriter&) = delete;
+
+    // Name symbol `id` (at most 15 characters; ids up to MaxSymbols - 1)
+    void setSymbol(uint16_t id, const std::string& symbol);
+
+    void append(const TradeRecord& record);
+
+    size_t size() const;
+
+    // Write the mapped pages back to disk
+    void flush();
+
+    // Trim the file to its records and unmap it (also done by the destructor)
+    void close();
+
+private:
+    TradeJournalHeader& header() const { return *reinterpret_cast<TradeJournalHeader*>(file.data()); }
+
+    MappedFile file;
+    size_t capacity;
+};
+
+class TradeJournalReader {
+public:
+    // Throws std::runtime_error if the file is missing or not a trade journal
+    explicit TradeJournalReader(const std::string& path);
+
+    size_t size() const { return count; }
+    const TradeRecord& operator[](size_t index) const { return records[index]; }
+    const TradeRecord* begin() const { return records; }
+    const TradeRecord* end() const { return records + count; }
+
+    // Name of symbol `id` (empty if unknown)
+    std::string symbol(uint16_t id) const;
+
+private:
+    MappedFile file;
+    const TradeRecord* records = nullptr;
+    size_t count = 0;
+};
+
+class TradeLedger {
+public:
+    explicit TradeLedger(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Preallocate room for `fills` records
+    void reserve(size_t fills) { records.reserve(fills); }
+
+    // Append one fill (and mirror it to the journal, if attached)
+    void record(int64_t timestamp, const std::string& symbol, TradeSide side, int quantity, double price, double cashAfter);
+
+    // Mirror subsequent fills to `journal` (null detaches). Symbols already
+    // interned are written to the journal's symbol table.
+    void attachJournal(TradeJournalWriter* journal);
+
+    size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+    const TradeRecord& operator[](size_t index) const { return records[index]; }
+    const TradeRecord* begin() const { return records.data(); }
+    const TradeRecord* end() const { return records.data() + records.size(); }
+
+    // Name of symbol `id`
+    const std::pmr::string& symbol(uint16_t id) const { return symbols[id]; }
+    size_t symbolCount() const { return symbols.size(); }
+
+    // Forget all records (interned symbols are kept)
+    void clear() { records.clear(); }
+
+    // Records and symbols for a checkpoint (an attached journal is not part of it)
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+
+    // Symbols alone, for a ledger that continues another's ids without its records
+    void saveSymbols(SnapshotWriter& out) const;
+    void loadSymbols(SnapshotReader& in);
+
+    // Put the first `count` records of each of `prefixes` (oldest first) in
+    // front of this ledger's. Their symbol ids must mean the same here, as
+    // they do for a ledger loaded from their symbols (see loadSymbols).
+    void prependRecords(const std::vector<std::pair<const TradeLedger*, size_t>>& prefixes);
+
+private:
+    uint16_t intern(const std::string& symbol);
+
+    std::pmr::vector<TradeRecord> records;
+    std::pmr::vector<std::pmr::string> symbols;
+    std::pmr::unordered_map<std::pmr::string, uint16_t> ids;
+    uint16_t lastId = 0; // Most recently interned or looked-up symbol, checked first
+    TradeJournalWriter* journal = nullptr;
+};
@@ -0,0 +1,94 @@
+#include "TradeMatcher.h"
+#include <algorithm>
+
+// ---------------------  RoundTripMatcher  -------------------------------------------
+
+void RoundTripMatcher::add(const TradeRecord& fill) {
+    if (fill.symbolId >= books.size()) books.resize(fill.symbolId + size_t(1));
+    Book& book = books[fill.symbolId];
+    const int8_t direction = fill.side == TradeSide::Buy ? 1 : -1;
+    int64_t remaining = fill.quantity;
+
+    // Close lots of the opposite direction, oldest (FIFO) or newest (LIFO) first
+    while (remaining > 0 && book.direction == -direction && !book.lots.empty()) {
+        Lot& lot = matching == LotMatching::FIFO ? book.lots.front() : book.lots.back();
+        const int64_t quantity = std::min(remaining, lot.quantity);
+
+        RoundTrip trip;
+        trip.entryTime = lot.time;
+        trip.exitTime = fill.timestamp;
+        trip.entryPrice = lot.price;
+        trip.exitPrice = fill.price;
+        trip.quantity = static_cast<int32_t>(quantity);
+        trip.symbolId = fill.symbolId;
+        trip.direction = book.direction;
+        trip.pnl = (fill.price - lot.price) * static_cast<double>(quantity) * book.direction;
+        trips.push_back(trip);
+
+        lot.quantity -= quantity;
+        remaining -= quantity;
+        if (lot.quantity == 0) {
+            if (matching == LotMatching::FIFO) book.lots.pop_front();
+            else book.lots.pop_back();
+        }
+    }
+    if (book.lots.empty()) book.direction = 0;
+
+    // Whatever is left opens (or adds to) a position in the fill's direction
+    if (remaining > 0) {
+        book.direction = direction;
+        book.lots.push_back({ fill.timestamp, fill.price, remaining });
+    }
+}
+
+int64_t RoundTripMatcher::openQuantity(uint16_t symbolId) const {
+    if (symbolId >= books.size()) return 0;
+    int64_t total = 0;
+    for (const Lot& lot : books[symbolId].lots) total += lot.quantity;
+    return total * books[symbolId].direction;
+}
+
+void RoundTripMatcher::annotateExcursions(std::vector<RoundTrip>& trips, const std::vector<BarView>& bars, uint16_t symbolId) {
+    struct Extreme {
+        int64_t time;
+        double price;
+    };
+    // Highs strictly decreasing and lows strictly increasing from bottom to top,
+    // so the extreme since time t is the first entry at or after t
+    std::vector<Extreme> highs, lows;
+    size_t next = 0;
+
+    auto answerUpTo = [&](int64_t limit, bool all) {
+        for (; next < trips.size() && (all || trips[next].exitTime < limit); ++next) {
+            RoundTrip& trip = trips[next];
+            if (trip.symbolId != symbolId) continue;
+            auto since = [&](const std::vector<Extreme>& stack) {
+                return std::lower_bound(stack.begin(), stack.end(), trip.entryTime,
+                    [](const Extreme& e, int64_t time) { return e.time < time; });
+            };
+            auto high = since(highs);
+            auto low = since(lows);
+            if (high == highs.end() || high->time > trip.exitTime) continue; // No bar while open
+            const double up = (high->price - trip.entryPrice) * trip.quantity;
+            const double down = (trip.entryPrice - low->price) * trip.quantity;
+            trip.mfe = std::max(0.0, trip.direction > 0 ? up : down);
+            trip.mae = std::max(0.0, trip.direction > 0 ? down : up);
+        }
+    };
+
+    for (const BarView& segment : bars) {
+        for (size_t i = 0; i < segment.size(); ++i) {
+            const int64_t time = segment.timestamps[i];
+            answerUpTo(time, false);
+            if (next == trips.size()) return;
+
+            const double high = segment.high[i] * segment.priceFactor;
+            const double low = segment.low[i] * segment.priceFactor;
+            while (!highs.empty() && highs.back().price <= high) highs.pop_back();
+            highs.push_back({ time, high });
+            while (!lows.empty() && lows.back().price >= low) lows.pop_back();
+            lows.push_back({ time, low });
+        }
+    }
+    answerUpTo(0, true);
+}
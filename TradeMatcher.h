@@ -0,0 +1,89 @@
+#pragma once
+#include "TimeSeries.h"
+#include "TradeLedger.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// ---------------------  Round-Trip Matching  -------------------------------------------
+//
+// Turns a run's fills (see TradeLedger.h) into round trips: each fill that
+// reduces a position is matched against the open lots of that symbol, first
+// in first out or last in first out, and every lot (or part of a lot) it
+// closes becomes one RoundTrip. A fill beyond the open position opens a lot
+// in the other direction, so short round trips come out the same way.
+//
+// Matching is linear in fills: every fill adds at most one lot, and every
+// lot is removed exactly once. Trips are produced in exit order.
+
+enum class LotMatching { FIFO, LIFO };
+
+struct RoundTrip {
+    int64_t entryTime;   // Epoch seconds
+    int64_t exitTime;
+    double entryPrice;
+    double exitPrice;
+    double pnl;          // (exit - entry) * quantity, sign-flipped for shorts
+    double mae = 0.0;    // Maximum adverse excursion while open, in currency (>= 0)
+    double mfe = 0.0;    // Maximum favorable excursion while open, in currency (>= 0)
+    int32_t quantity;    // Shares (positive)
+    uint16_t symbolId;   // As in the ledger
+    int8_t direction;    // +1 long, -1 short
+
+    // P&L relative to the capital committed at entry
+    double returnOnEntry() const { return pnl / (entryPrice * quantity); }
+    int64_t holdingSeconds() const { return exitTime - entryTime; }
+};
+
+class RoundTripMatcher {
+public:
+    explicit RoundTripMatcher(LotMatching matching = LotMatching::FIFO) : matching(matching) {}
+
+    // Match one fill against the open lots of its symbol
+    void add(const TradeRecord& fill);
+
+    // Match every fill of a ledger (or journal) in order
+    template <typename Fills>
+    void addAll(const Fills& fills) {
+        for (const TradeRecord& fill : fills) add(fill);
+    }
+
+    // Round trips closed so far, in exit order
+    const std::vector<RoundTrip>& getTrips() const { return trips; }
+
+    // Shares still open for `symbolId` (negative for a net short)
+    int64_t openQuantity(uint16_t symbolId) const;
+
+    // Round trips of a whole ledger
+    template <typename Fills>
+    static std::vector<RoundTrip> match(const Fills& fills, LotMatching matching = LotMatching::FIFO) {
+        RoundTripMatcher matcher(matching);
+        matcher.addAll(fills);
+        return std::move(matcher.trips);
+    }
+
+    // Fill in mae/mfe of the trips of `symbolId` from the bars they were open
+    // over (entry and exit bars included). `bars` are in time order, such as
+    // DataModule::adjusted(); `trips` must be in exit order, as produced. One
+    // pass over the bars with monotonic stacks of highs and lows: each trip is
+    // answered by a binary search when the scan reaches its exit.
+    static void annotateExcursions(std::vector<RoundTrip>& trips, const std::vector<BarView>& bars, uint16_t symbolId = 0);
+
+private:
+    struct Lot {
+        int64_t time;
+        double price;
+        int64_t quantity; // Remaining shares, positive
+    };
+
+    struct Book {
+        std::deque<Lot> lots; // Open lots, oldest first, all in `direction`
+        int8_t direction = 0; // +1 long, -1 short, 0 flat
+    };
+
+    LotMatching matching;
+    std::vector<Book> books; // By symbol id
+    std::vector<RoundTrip> trips;
+};
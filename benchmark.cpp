@@ -0,0 +1,638 @@
+#include "DataModule.h"
+#include "BacktestingEngine.h"
+#include "portfolio.h"
+#include "metrics.h"
+#include "strategies.h"
+#include "SyntheticData.h"
+#include "RunArena.h"
+#include "Resampler.h"
+#include "BarFile.h"
+#include "BarSource.h"
+#include "FixedPoint.h"
+#include "ThreadPool.h"
+#include "json/json.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ---------------------  Benchmark Harness  -------------------------------------------
+//
+// Measures the hot paths of the backtester and emits machine-readable JSON so
+// results can be compared between versions:
+//   load      - DataModule::loadTimeSeriesCSV / loadTimeSeriesBinary / loadDirectoryCSV
+//               throughput (bars/s, MB/s), plain and compressed
+//   engine    - BacktestingEngine::runBacktest throughput (bars/s), in memory, streamed and
+//               with pre-trade risk checks and over tick-stored bars (also their price column
+//               bytes against double columns); a window grid run one by one and as a prefix-sharing sweep;
+//               the sequential run against runPipelined at several batch sizes (also per-bar latency)
+//   resample  - Resampler::resample to 5m / 1h / 1d (ns per input bar)
+//   portfolio - Portfolio::buy / Portfolio::sell cost per trade (ns)
+//   metrics   - every Metrics function (ns per element)
+//
+// Usage:
+//   benchmark [--dataset <csv>] [--bars <n>[,<n>...]] [--repeat <r>]
+//             [--label <text>] [--out <file.json>] [--keep-synthetic]
+//
+// By default the suite runs on datasets/spy_2024.csv and one synthetic
+// dataset of 1M bars produced by SyntheticDataGenerator. Larger synthetic sizes (up to 100M bars) are opt-in
+// via --bars since they need several GB of disk and memory.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchmarkOptions {
+    std::string dataset = "./datasets/spy_2024.csv";
+    std::vector<size_t> syntheticBars = { 1000000 };
+    int repeat = 3;
+    std::string label;
+    std::string outPath;
+    bool keepSynthetic = false;
+};
+
+// Discards everything written to it; used to keep per-bar logging out of the timings
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int ch) override { return ch; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+// Redirects std::cout and std::cerr to a null buffer for the lifetime of the object
+class ScopedSilence {
+public:
+    ScopedSilence() : previousOut(std::cout.rdbuf(&sink)), previousErr(std::cerr.rdbuf(&sink)) {}
+    ~ScopedSilence() {
+        std::cout.rdbuf(previousOut);
+        std::cerr.rdbuf(previousErr);
+    }
+
+private:
+    NullBuffer sink;
+    std::streambuf* previousOut;
+    std::streambuf* previousErr;
+};
+
+// Prevents the optimizer from discarding a benchmarked result: the empty asm
+// claims to read the value, so it must be computed and stored
+template <typename T>
+void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+    (void)sink;
+#endif
+}
+
+// Run a callable `repeat` times and return the wall time of each run in seconds
+std::vector<double> timeRuns(int repeat, const std::function<void()>& body) {
+    std::vector<double> samples;
+    samples.reserve(repeat);
+    for (int i = 0; i < repeat; ++i) {
+        auto start = Clock::now();
+        body();
+        samples.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    return samples;
+}
+
+double median(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    size_t mid = samples.size() / 2;
+    return samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2.0;
+}
+
+// Build one JSON result record from a set of timing samples.
+// `items` is the number of units processed per run (bars, trades, elements).
+Json::Value makeResult(const std::string& group, const std::string& name, const std::string& dataset,
+                       size_t items, const std::vector<double>& samples) {
+    double best = *std::min_element(samples.begin(), samples.end());
+    double med = median(samples);
+
+    Json::Value result;
+    result["group"] = group;
+    result["name"] = name;
+    result["dataset"] = dataset;
+    result["items"] = Json::UInt64(items);
+    result["runs"] = Json::UInt64(samples.size());
+    result["best_seconds"] = best;
+    result["median_seconds"] = med;
+    result["items_per_second"] = med > 0.0 ? items / med : 0.0;
+    result["ns_per_item"] = items > 0 ? med * 1e9 / items : 0.0;
+    return result;
+}
+
+void printResult(const Json::Value& result) {
+    std::cerr << "  " << result["group"].asString() << "/" << result["name"].asString()
+        << " [" << result["dataset"].asString() << "]: "
+        << result["items_per_second"].asDouble() << " items/s, "
+        << result["ns_per_item"].asDouble() << " ns/item" << std::endl;
+}
+
+// ---------------------  Benchmarks  -------------------------------------------
+
+void benchmarkLoad(const std::string& path, const std::string& dataset, int repeat, Json::Value& results,
+                   const std::string& name = "loadTimeSeriesCSV") {
+    size_t bars = 0;
+    auto samples = timeRuns(repeat, [&]() {
+        DataModule dataModule;
+        if (!dataModule.loadTimeSeriesCSV(path)) throw std::runtime_error("Failed to load " + path);
+        bars = dataModule.size();
+    });
+
+    Json::Value result = makeResult("load", name, dataset, bars, samples);
+    double megabytes = std::filesystem::file_size(path) / (1024.0 * 1024.0);
+    result["megabytes_per_second"] = megabytes / result["median_seconds"].asDouble();
+    printResult(result);
+    results.append(result);
+}
+
+void benchmarkBinaryLoad(const std::string& path, const std::string& dataset, int repeat, Json::Value& results,
+                         const std::string& name = "loadTimeSeriesBinary") {
+    size_t bars = 0;
+    auto samples = timeRuns(repeat, [&]() {
+        DataModule dataModule;
+        if (!dataModule.loadTimeSeriesBinary(path)) throw std::runtime_error("Failed to load " + path);
+        bars = dataModule.size();
+    });
+
+    Json::Value result = makeResult("load", name, dataset, bars, samples);
+    double megabytes = std::filesystem::file_size(path) / (1024.0 * 1024.0);
+    result["megabytes_per_second"] = megabytes / result["median_seconds"].asDouble();
+    printResult(result);
+    results.append(result);
+}
+
+// Split a CSV into `parts` files (each with the header) under `directory`
+void splitCSV(const std::string& path, const std::string& directory, size_t parts) {
+    std::ifstream in(path);
+    std::string header, line;
+    std::getline(in, header);
+    std::vector<std::string> lines;
+    while (std::getline(in, line)) lines.push_back(std::move(line));
+
+    std::filesystem::create_directories(directory);
+    const size_t perPart = (lines.size() + parts - 1) / parts;
+    for (size_t part = 0; part < parts; ++part) {
+        std::ofstream out((std::filesystem::path(directory) / ("part" + std::to_string(1000 + part) + ".csv")).string());
+        out << header << '\n';
+        for (size_t i = part * perPart; i < std::min(lines.size(), (part + 1) * perPart); ++i) out << lines[i] << '\n';
+    }
+}
+
+// Multi-file load of the same dataset split into parts, single-threaded and on all cores
+void benchmarkDirectoryLoad(const std::string& path, const std::string& dataset, int repeat, Json::Value& results) {
+    const std::string directory = (std::filesystem::path(path).parent_path() / "parts").string();
+    splitCSV(path, directory, 16);
+
+    std::vector<size_t> threadCounts = { 1 };
+    if (ThreadPool::defaultThreadCount() > 1) threadCounts.push_back(ThreadPool::defaultThreadCount());
+    for (size_t threads : threadCounts) {
+        size_t bars = 0;
+        auto samples = timeRuns(repeat, [&]() {
+            DataModule dataModule;
+            for (const auto& file : dataModule.loadDirectoryCSV(directory, "*.csv", threads)) {
+                if (!file.ok()) throw std::runtime_error(file.error);
+            }
+            bars = dataModule.size();
+        });
+
+        Json::Value result = makeResult("load", "loadDirectoryCSV_" + std::to_string(threads) + "t", dataset, bars, samples);
+        result["threads"] = Json::UInt64(threads);
+        printResult(result);
+        results.append(result);
+    }
+    std::filesystem::remove_all(directory);
+}
+
+void benchmarkEngine(DataModule& dataModule, const std::string& dataset, int repeat, Json::Value& results) {
+    // Heap-backed run, then the same run with per-run state in a RunArena that
+    // is reset between repetitions as a sweep worker would
+    RunArena arena;
+    for (bool useArena : { false, true }) {
+        auto samples = timeRuns(repeat, [&]() {
+            std::pmr::memory_resource* resource = useArena ? arena.resource() : std::pmr::get_default_resource();
+            {
+                ScopedSilence silence;
+                Portfolio portfolio(resource);
+                portfolio.setCash(100000.0);
+                MovingAverageStrategy strategy(5, 20, portfolio, resource);
+                BacktestingEngine engine;
+                engine.runBacktest(dataModule, strategy, portfolio);
+                doNotOptimize(portfolio.getEquityCurve().back());
+            }
+            if (useArena) arena.reset();
+        });
+
+        Json::Value result = makeResult("engine", useArena ? "runBacktest_arena" : "runBacktest", dataset,
+            dataModule.size(), samples);
+        printResult(result);
+        results.append(result);
+    }
+}
+
+// The plain run with every pre-trade risk check enabled, to track their overhead
+void benchmarkRiskEngine(DataModule& dataModule, const std::string& dataset, int repeat, Json::Value& results) {
+    RiskLimits limits;
+    limits.maxPosition = 1000000;
+    limits.maxGrossExposure = 1e12;
+    limits.maxNetExposure = 1e12;
+    limits.maxOrders = 1000;
+    limits.orderWindowSeconds = 1;
+    limits.maxDrawdown = 0.99;
+    limits.maxSessionLoss = 0.99;
+
+    auto samples = timeRuns(repeat, [&]() {
+        ScopedSilence silence;
+        RiskEngine risk(limits);
+        Portfolio portfolio;
+        portfolio.setCash(100000.0);
+        portfolio.setRiskEngine(&risk);
+        MovingAverageStrategy strategy(5, 20, portfolio);
+        BacktestingEngine engine;
+        engine.runBacktest(dataModule, strategy, portfolio);
+        doNotOptimize(portfolio.getEquityCurve().back());
+    });
+
+    Json::Value result = makeResult("engine", "runBacktest_risk", dataset, dataModule.size(), samples);
+    printResult(result);
+    results.append(result);
+}
+
+// The plain run over the bars held as TickBars at a 0.01 tick, expanded chunk by
+// chunk. The record also carries the memory of the price columns in both forms.
+void benchmarkTickBars(DataModule& dataModule, const std::string& dataset, int repeat, Json::Value& results) {
+    const TickBars ticks(dataModule.view(), FixedPoint::TickSize(0.01));
+
+    auto samples = timeRuns(repeat, [&]() {
+        ScopedSilence silence;
+        Portfolio portfolio;
+        portfolio.setCash(100000.0);
+        MovingAverageStrategy strategy(5, 20, portfolio);
+        BacktestingEngine engine;
+        engine.runBacktest(ticks, strategy, portfolio);
+        doNotOptimize(portfolio.getEquityCurve().back());
+    });
+
+    Json::Value result = makeResult("engine", "runBacktest_ticks", dataset, ticks.size(), samples);
+    result["compact"] = ticks.isCompact();
+    result["price_bytes"] = Json::UInt64(ticks.priceBytes());
+    result["double_price_bytes"] = Json::UInt64(4 * ticks.size() * sizeof(double));
+    printResult(result);
+    std::cerr << "    price columns: " << ticks.priceBytes() << " bytes as ticks, "
+        << 4 * ticks.size() * sizeof(double) << " bytes as doubles" << std::endl;
+    results.append(result);
+}
+
+// Moving average variants run one by one, then as one prefix-sharing sweep.
+// "grid" is a typical crossover grid, whose variants diverge within a few
+// hundred bars, so the sweep gains little or nothing. In "warmup" every long
+// window covers most of the data, so the variants share a long warm-up.
+// What the sweep saves there is mostly the per-bar logging (formatted here,
+// then discarded), which runs once for the shared bars.
+void benchmarkSweep(DataModule& dataModule, const std::string& dataset, int repeat, Json::Value& results) {
+    auto makeVariant = [](size_t shortWindow, size_t longWindow) -> StrategyFactory {
+        return [=](Portfolio& portfolio) {
+            return std::unique_ptr<Strategy>(new MovingAverageStrategy(shortWindow, longWindow, portfolio));
+        };
+    };
+    std::vector<StrategyFactory> grid, warmup;
+    for (size_t longWindow : { 50, 100, 200, 400, 800 }) {
+        for (size_t shortWindow : { 5, 10, 20, 40 }) grid.push_back(makeVariant(shortWindow, longWindow));
+    }
+    const size_t firstLong = std::max<size_t>(dataModule.size() * 2 / 3, 160);
+    for (size_t step = 0; step < 4; ++step) {
+        const size_t longWindow = firstLong + step * (firstLong / 40);
+        for (size_t divisor : { 20, 40, 80, 160 }) warmup.push_back(makeVariant(longWindow / divisor, longWindow));
+    }
+    Portfolio prototype;
+    prototype.setCash(100000.0);
+
+    for (const auto& [name, variants] : { std::make_pair("grid", &grid), std::make_pair("warmup", &warmup) }) {
+        for (bool shared : { false, true }) {
+            auto samples = timeRuns(repeat, [&]() {
+                ScopedSilence silence;
+                BacktestingEngine engine;
+                if (shared) {
+                    std::vector<SweepRun> runs = engine.runSweep(dataModule, prototype, *variants);
+                    doNotOptimize(runs.back().portfolio->getEquityCurve().back());
+                    return;
+                }
+                for (const StrategyFactory& variant : *variants) {
+                    Portfolio portfolio;
+                    portfolio.setCash(100000.0);
+                    std::unique_ptr<Strategy> strategy = variant(portfolio);
+                    engine.runBacktest(dataModule, *strategy, portfolio);
+                    doNotOptimize(portfolio.getEquityCurve().back());
+                }
+            });
+
+            Json::Value result = makeResult("engine", std::string(shared ? "runSweep_" : "runBacktest_") + name, dataset,
+                dataModule.size() * variants->size(), samples);
+            result["variants"] = Json::UInt64(variants->size());
+            printResult(result);
+            results.append(result);
+        }
+    }
+}
+
+// The sequential run against the pipelined one (decode, strategy and metrics
+// stages on their own threads) at several batch sizes. Latency is the time
+// from a bar being decoded to its equity reaching the metrics stage; for the
+// sequential run every stage happens at once, so it is the time per bar.
+void benchmarkPipeline(DataModule& dataModule, const std::string& dataset, int repeat, Json::Value& results) {
+    const std::vector<BarView> bars = dataModule.adjusted();
+    auto samples = timeRuns(repeat, [&]() {
+        ScopedSilence silence;
+        Portfolio portfolio;
+        portfolio.setCash(100000.0);
+        MovingAverageStrategy strategy(5, 20, portfolio);
+        BacktestingEngine engine;
+        engine.runBacktest(bars, strategy, portfolio);
+        doNotOptimize(portfolio.getEquityCurve().back());
+    });
+    Json::Value sequential = makeResult("pipeline", "runBacktest_sequential", dataset, dataModule.size(), samples);
+    sequential["latency_ns_per_bar"] = sequential["ns_per_item"];
+    printResult(sequential);
+    results.append(sequential);
+
+    for (size_t batchBars : { 16, 256, 4096 }) {
+        std::vector<double> latencies;
+        samples = timeRuns(repeat, [&]() {
+            ScopedSilence silence;
+            Portfolio portfolio;
+            portfolio.setCash(100000.0);
+            MovingAverageStrategy strategy(5, 20, portfolio);
+            BacktestingEngine engine;
+            engine.setPipelining(batchBars);
+            const PipelineStats stats = engine.runPipelined(bars, strategy, portfolio);
+            latencies.push_back(stats.meanLatencySeconds);
+            doNotOptimize(stats.metrics.front().getLastEquity());
+        });
+        Json::Value result = makeResult("pipeline", "runPipelined_batch" + std::to_string(batchBars), dataset,
+            dataModule.size(), samples);
+        result["batch_bars"] = Json::UInt64(batchBars);
+        result["latency_ns_per_bar"] = median(latencies) * 1e9;
+        printResult(result);
+        std::cerr << "    latency " << result["latency_ns_per_bar"].asDouble() << " ns/bar" << std::endl;
+        results.append(result);
+    }
+}
+
+// Streaming runBacktest with a background read-ahead thread over CSV and binary sources
+void benchmarkStreaming(const std::string& csvPath, const std::string& binaryPath, const std::string& dataset,
+                        int repeat, Json::Value& results) {
+    const size_t bars = BarFileReader(binaryPath).getHeader().barCount;
+    for (bool binary : { false, true }) {
+        auto samples = timeRuns(repeat, [&]() {
+            ScopedSilence silence;
+            std::unique_ptr<BarSource> inner;
+            if (binary) inner = std::make_unique<BinaryStreamSource>(binaryPath);
+            else inner = std::make_unique<CSVStreamSource>(csvPath);
+            ReadAheadSource source(std::move(inner));
+
+            Portfolio portfolio;
+            portfolio.setCash(100000.0);
+            portfolio.setEquitySampling(EquitySampling::SessionClose);
+            MovingAverageStrategy strategy(5, 20, portfolio);
+            BacktestingEngine engine;
+            engine.runBacktest(source, strategy, portfolio);
+            doNotOptimize(portfolio.getCash());
+        });
+
+        Json::Value result = makeResult("engine", binary ? "runBacktest_stream_binary" : "runBacktest_stream_csv",
+            dataset, bars, samples);
+        printResult(result);
+        results.append(result);
+    }
+}
+
+void benchmarkPortfolio(int repeat, Json::Value& results) {
+    const size_t trades = 1000000;
+    std::vector<double> buySamples, sellSamples;
+
+    for (int r = 0; r < repeat; ++r) {
+        Portfolio portfolio;
+        portfolio.setCash(1e15);
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < trades; ++i) {
+            portfolio.buy("SPY", 10, 100.0 + (i % 100) * 0.01);
+        }
+        auto middle = Clock::now();
+        for (size_t i = 0; i < trades; ++i) {
+            portfolio.sell("SPY", 10, 100.0 + (i % 100) * 0.01);
+        }
+        auto end = Clock::now();
+
+        doNotOptimize(portfolio.getCash());
+        buySamples.push_back(std::chrono::duration<double>(middle - start).count());
+        sellSamples.push_back(std::chrono::duration<double>(end - middle).count());
+    }
+
+    for (auto& [name, samples] : { std::make_pair("buy", buySamples), std::make_pair("sell", sellSamples) }) {
+        Json::Value result = makeResult("portfolio", name, "synthetic", trades, samples);
+        printResult(result);
+        results.append(result);
+    }
+}
+
+void benchmarkMetrics(size_t size, int repeat, Json::Value& results) {
+    std::mt19937_64 rng(42);
+    std::normal_distribution<double> step(0.0002, 0.01);
+    std::vector<double> returns(size), equityCurve(size + 1);
+    equityCurve[0] = 100000.0;
+    for (size_t i = 0; i < size; ++i) {
+        returns[i] = step(rng);
+        equityCurve[i + 1] = equityCurve[i] * (1.0 + returns[i]);
+    }
+
+    const std::string dataset = "synthetic-" + std::to_string(size);
+    auto run = [&](const std::string& name, size_t items, const std::function<double()>& body) {
+        auto samples = timeRuns(repeat, [&]() { doNotOptimize(body()); });
+        Json::Value result = makeResult("metrics", name, dataset, items, samples);
+        printResult(result);
+        results.append(result);
+    };
+
+    run("calculateSharpeRatio", size, [&]() { return Metrics::calculateSharpeRatio(returns); });
+    run("calculateMaxDrawdown", size + 1, [&]() { return Metrics::calculateMaxDrawdown(equityCurve); });
+    run("calculateTotalReturn", size + 1, [&]() { return Metrics::calculateTotalReturn(equityCurve); });
+    run("calculateAnnualizedReturn", size + 1, [&]() { return Metrics::calculateAnnualizedReturn(equityCurve, 252); });
+    run("calculateWinRate", size, [&]() { return Metrics::calculateWinRate(returns); });
+    run("calculateProfitFactor", size, [&]() { return Metrics::calculateProfitFactor(returns); });
+    run("calculateAverageTradeReturn", size, [&]() { return Metrics::calculateAverageTradeReturn(returns); });
+    run("calculateSortinoRatio", size, [&]() { return Metrics::calculateSortinoRatio(returns); });
+    run("calculateCalmarRatio", size + 1, [&]() { return Metrics::calculateCalmarRatio(equityCurve, 252); });
+    run("calculateExpectancy", size, [&]() { return Metrics::calculateExpectancy(returns); });
+    run("calculateRollingReturns", size + 1, [&]() { return Metrics::calculateRollingReturns(equityCurve, 390).back(); });
+}
+
+// Batch resampling of the loaded bars into coarser timeframes (ns per input bar)
+void benchmarkResample(const DataModule& dataModule, const std::string& dataset, int repeat, Json::Value& results) {
+    for (const char* interval : { "5m", "1h", "1d" }) {
+        const int64_t seconds = Resampler::parseInterval(interval);
+        auto samples = timeRuns(repeat, [&]() {
+            BarColumns resampled = Resampler::resample(dataModule.view(), seconds);
+            doNotOptimize(resampled.size());
+        });
+
+        Json::Value result = makeResult("resample", std::string("resample_") + interval, dataset, dataModule.size(), samples);
+        printResult(result);
+        results.append(result);
+    }
+}
+
+// Load + engine benchmarks for one CSV dataset
+void benchmarkDataset(const std::string& path, const std::string& dataset, int repeat, Json::Value& results) {
+    benchmarkLoad(path, dataset, repeat, results);
+
+    DataModule dataModule;
+    {
+        ScopedSilence silence;
+        if (!dataModule.loadTimeSeriesCSV(path)) throw std::runtime_error("Failed to load " + path);
+    }
+    benchmarkEngine(dataModule, dataset, repeat, results);
+    benchmarkRiskEngine(dataModule, dataset, repeat, results);
+    benchmarkTickBars(dataModule, dataset, repeat, results);
+    benchmarkSweep(dataModule, dataset, repeat, results);
+    benchmarkPipeline(dataModule, dataset, repeat, results);
+    benchmarkResample(dataModule, dataset, repeat, results);
+}
+
+std::vector<size_t> parseSizes(const std::string& text) {
+    std::vector<size_t> sizes;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) sizes.push_back(std::stoull(item));
+    }
+    return sizes;
+}
+
+BenchmarkOptions parseOptions(int argc, char** argv) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--dataset") options.dataset = value();
+        else if (arg == "--bars") options.syntheticBars = parseSizes(value());
+        else if (arg == "--repeat") options.repeat = std::max(1, std::stoi(value()));
+        else if (arg == "--label") options.label = value();
+        else if (arg == "--out") options.outPath = value();
+        else if (arg == "--keep-synthetic") options.keepSynthetic = true;
+        else throw std::invalid_argument("Unknown argument: " + arg);
+    }
+    return options;
+}
+
+std::string compilerName() {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_VER);
+#else
+    return "unknown";
+#endif
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    Json::Value root;
+    root["schema_version"] = 1;
+    root["label"] = options.label;
+    root["compiler"] = compilerName();
+#ifdef NDEBUG
+    root["assertions"] = false;
+#else
+    root["assertions"] = true;
+#endif
+    root["repeat"] = options.repeat;
+    Json::Value& results = root["results"] = Json::Value(Json::arrayValue);
+
+    try {
+        std::cerr << "Running benchmarks..." << std::endl;
+
+        if (std::filesystem::exists(options.dataset)) {
+            benchmarkDataset(options.dataset, std::filesystem::path(options.dataset).filename().string(), options.repeat, results);
+        }
+        else {
+            std::cerr << "Dataset not found, skipping: " << options.dataset << std::endl;
+        }
+
+        for (size_t bars : options.syntheticBars) {
+            const std::string dataset = "synthetic-" + std::to_string(bars);
+            const std::string directory = (std::filesystem::temp_directory_path() / ("backtester_" + dataset)).string();
+
+            SyntheticDataConfig config;
+            config.barsPerSymbol = bars;
+            config.seed = 12345;
+            SyntheticDataGenerator generator(config);
+            std::cerr << "Generating " << dataset << " -> " << directory << std::endl;
+            const std::string path = generator.writeCSV(directory).front();
+            const std::string binaryPath = generator.writeBinary(directory).front();
+
+            benchmarkDataset(path, dataset, options.repeat, results);
+            benchmarkBinaryLoad(binaryPath, dataset, options.repeat, results);
+            benchmarkDirectoryLoad(path, dataset, options.repeat, results);
+            benchmarkStreaming(path, binaryPath, dataset, options.repeat, results);
+
+            // Compressed variants go to a subdirectory since the binary file name is the same
+            const std::string compressedDirectory = (std::filesystem::path(directory) / "compressed").string();
+            const std::string gzipPath = generator.writeCSV(compressedDirectory, true).front();
+            const std::string compressedBinaryPath = generator.writeBinary(compressedDirectory, BarCompression::Delta).front();
+            benchmarkLoad(gzipPath, dataset, options.repeat, results, "loadTimeSeriesCSV_gzip");
+            benchmarkBinaryLoad(compressedBinaryPath, dataset, options.repeat, results, "loadTimeSeriesBinary_delta");
+            if (!options.keepSynthetic) std::filesystem::remove_all(directory);
+        }
+
+        benchmarkPortfolio(options.repeat, results);
+        for (size_t bars : options.syntheticBars) {
+            benchmarkMetrics(bars, options.repeat, results);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "  ";
+    if (options.outPath.empty()) {
+        std::cout << Json::writeString(writer, root) << std::endl;
+    }
+    else {
+        std::ofstream out(options.outPath);
+        if (!out) {
+            std::cerr << "Failed to open output file: " << options.outPath << std::endl;
+            return 1;
+        }
+        out << Json::writeString(writer, root) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+# Merge raw PGO profiles after the training run.
+# GCC and MSVC consume their profiles directly; Clang needs the .profraw
+# files merged into a single .profdata with llvm-profdata.
+if(NOT COMPILER_ID MATCHES "Clang")
+    return()
+endif()
+
+find_program(LLVM_PROFDATA NAMES llvm-profdata)
+if(NOT LLVM_PROFDATA)
+    message(FATAL_ERROR "llvm-profdata not found; cannot merge Clang PGO profiles")
+endif()
+
+file(GLOB _raw_profiles "${PGO_DIR}/*.profraw")
+if(NOT _raw_profiles)
+    message(FATAL_ERROR "No .profraw files found in ${PGO_DIR}; was the GENERATE build used?")
+endif()
+
+execute_process(
+    COMMAND ${LLVM_PROFDATA} merge -output=${PGO_DIR}/merged.profdata ${_raw_profiles}
+    RESULT_VARIABLE _result
+)
+if(NOT _result EQUAL 0)
+    message(FATAL_ERROR "llvm-profdata merge failed")
+endif()
@@ -1,12 +1,15 @@
 #include "DataModule.h"
 #include "BacktestingEngine.h"
-#include "Portfolio.h"
-#include "Metrics.h"
-#include "Strategies.h"
+#include "portfolio.h"
+#include "metrics.h"
+#include "strategies.h"
+#include "Profiler.h"
+#include "BatchRunner.h"
 #include <iostream>
+#include <string>
 #include <vector>
 
-void displayPerformanceMetrics(const Portfolio& portfolio, const std::vector<double>& equityCurve) {
+void displayPerformanceMetrics(const Portfolio& portfolio, SeriesView equityCurve, const std::vector<BarView>& bars) {
     // Ensure the equity curve has enough data for analysis
     if (equityCurve.empty()) {
         std::cerr << "Equity curve is empty. Check your backtest or data inputs." << std::endl;
@@ -14,39 +17,73 @@ void displayPerformanceMetrics(const Portfolio& portfolio, const std::vector<dou
     }
 
     try {
-        // Calculate metrics
-        double sharpeRatio = Metrics::calculateSharpeRatio(portfolio.getReturns());
-        double maxDrawdown = Metrics::calculateMaxDrawdown(equityCurve);
-        double totalReturn = Metrics::calculateTotalReturn(equityCurve);
-        double annualizedReturn = Metrics::calculateAnnualizedReturn(equityCurve, 252); // 252 trading days in a year
-		double winRate = Metrics::calculateWinRate(portfolio.getReturns());
-		double profitFactor = Metrics::calculateProfitFactor(portfolio.getReturns());
-		double averageTradeReturn = Metrics::calculateAverageTradeReturn(portfolio.getReturns());
-		double sortinoRatio = Metrics::calculateSortinoRatio(portfolio.getReturns());
-		double calmarRatio = Metrics::calculateCalmarRatio(equityCurve, 252);
-		double expectancy = Metrics::calculateExpectancy(portfolio.getReturns());
+        BT_PROFILE_SCOPE(Metrics);
+
+        // Calculate metrics, with the trade-level ones from the fills matched into round trips (FIFO)
+        std::vector<RoundTrip> trips = RoundTripMatcher::match(portfolio.getTrades());
+        RoundTripMatcher::annotateExcursions(trips, bars);
+        const MetricSummary metrics = Metrics::summarize(equityCurve, portfolio.getReturns(), trips, 252); // 252 trading days in a year
+        const TradeStats& trades = metrics.trades;
 
         // Display metrics
         std::cout << "\n";
         std::cout << "\nPerformance Metrics:" << std::endl;
         std::cout << "---------------------" << std::endl;
-        std::cout << "Total Return: " << totalReturn * 100 << "%" << std::endl;
-        std::cout << "Win Rate: " << winRate * 100 << "%" << std::endl;
-        std::cout << "Average Trade Return: " << averageTradeReturn << std::endl;
-        std::cout << "Annualized Return: " << annualizedReturn * 100 << "%" << std::endl;
-		std::cout << "Profit Factor: " << profitFactor << std::endl;
-        std::cout << "Maximum Drawdown: " << maxDrawdown * 100 << "%" << std::endl;
-        std::cout << "Sharpe Ratio: " << sharpeRatio << std::endl;
-		std::cout << "Sortino Ratio: " << sortinoRatio << std::endl;
-		std::cout << "Calmar Ratio: " << calmarRatio << std::endl;
-		std::cout << "Expectancy: " << expectancy << std::endl;
+        std::cout << "Total Return: " << metrics.totalReturn * 100 << "%" << std::endl;
+        std::cout << "Win Rate: " << metrics.winRate * 100 << "%" << std::endl;
+        std::cout << "Average Trade Return: " << metrics.averageTradeReturn << std::endl;
+        std::cout << "Annualized Return: " << metrics.annualizedReturn * 100 << "%" << std::endl;
+		std::cout << "Profit Factor: " << metrics.profitFactor << std::endl;
+        std::cout << "Maximum Drawdown: " << metrics.maxDrawdown * 100 << "%" << std::endl;
+        std::cout << "Sharpe Ratio: " << metrics.sharpeRatio << std::endl;
+		std::cout << "Sortino Ratio: " << metrics.sortinoRatio << std::endl;
+		std::cout << "Calmar Ratio: " << metrics.calmarRatio << std::endl;
+		std::cout << "Expectancy: " << metrics.expectancy << std::endl;
+
+        std::cout << "\nTrade Metrics (" << trades.trades << " round trips, FIFO):" << std::endl;
+        std::cout << "---------------------" << std::endl;
+        std::cout << "Win Rate: " << trades.winRate * 100 << "%" << std::endl;
+        std::cout << "Profit Factor: " << trades.profitFactor << std::endl;
+        std::cout << "Expectancy: " << trades.expectancy << std::endl;
+        std::cout << "Average Trade Return: " << trades.averageReturn * 100 << "%" << std::endl;
+        std::cout << "Average Holding Period: " << trades.averageHoldingSeconds / 60 << " minutes" << std::endl;
+        std::cout << "Average MAE: " << trades.averageMAE << std::endl;
+        std::cout << "Average MFE: " << trades.averageMFE << std::endl;
     }
     catch (const std::exception& e) {
         std::cerr << "Error calculating metrics: " << e.what() << std::endl;
     }
 }
 
-int main() {
+// Run a batch job described by a JSON configuration (see BatchConfig.h)
+int runBatch(const std::string& configPath) {
+    try {
+        BatchRunner runner(BatchConfig::load(configPath));
+        std::cerr << "Running " << runner.getConfig().runCount() << " backtests from " << configPath << std::endl;
+        const size_t failures = runner.run(std::cout);
+        if (!runner.getConfig().cacheDirectory.empty()) {
+            std::cerr << runner.getCachedRuns() << " run(s) taken from the result cache." << std::endl;
+        }
+        if (failures > 0) {
+            std::cerr << failures << " run(s) failed." << std::endl;
+            return 1;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Batch failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // With --config <file.json>, run the batch job it describes instead of the example backtest
+    if (argc == 3 && std::string(argv[1]) == "--config") return runBatch(argv[2]);
+    if (argc != 1) {
+        std::cerr << "Usage: backtester [--config <file.json>]" << std::endl;
+        return 2;
+    }
+
     // Initialize DataModule and load data
     DataModule dataModule;
     const std::string filePath = "./datasets/spy_2024.csv";
@@ -54,6 +91,8 @@ int main() {
         std::cerr << "Failed to load data from file: " << filePath << std::endl;
         return 1;
     }
+    const ValidationReport& validation = dataModule.getValidationReport();
+    if (!validation.clean() || validation.gaps > 0) validation.print(std::cerr, filePath);
 
     // Set up Portfolio
     Portfolio portfolio;
@@ -75,10 +114,13 @@ int main() {
     }
 
     // Generate the equity curve from portfolio value over time
-    std::vector<double> equityCurve = portfolio.getEquityCurve();
+    const std::pmr::vector<double>& equityCurve = portfolio.getEquityCurve();
 
     // Display performance metrics
-    displayPerformanceMetrics(portfolio, equityCurve);
+    displayPerformanceMetrics(portfolio, equityCurve, dataModule.adjusted());
+
+    // Print where the time went (no-op unless built with instrumentation)
+    BT_PROFILE_REPORT(std::cout);
 
     return 0;
 }
@@ -1,11 +1,11 @@
-#include "Metrics.h"
+#include "metrics.h"
 #include <algorithm>
 #include <numeric>
 #include <cmath>
 #include <stdexcept>
 
 // Calculate Sharpe Ratio
-double Metrics::calculateSharpeRatio(const std::vector<double>& returns, double riskFreeRate) {
+double Metrics::calculateSharpeRatio(SeriesView returns, double riskFreeRate) {
     if (returns.empty()) throw std::invalid_argument("Returns vector cannot be empty.");
     double meanReturn = std::accumulate(returns.begin(), returns.end(), 0.0) / returns.size();
     double variance = 0.0;
@@ -16,7 +16,7 @@ double Metrics::calculateSharpeRatio(const std::vector<double>& returns, double
 }
 
 // Calculate Maximum Drawdown
-double Metrics::calculateMaxDrawdown(const std::vector<double>& equityCurve) {
+double Metrics::calculateMaxDrawdown(SeriesView equityCurve) {
     if (equityCurve.empty()) throw std::invalid_argument("Equity curve cannot be empty.");
     double maxDrawdown = 0.0, peak = equityCurve[0];
     for (double value : equityCurve) {
@@ -28,27 +28,27 @@ double Metrics::calculateMaxDrawdown(const std::vector<double>& equityCurve) {
 }
 
 // Calculate Total Return
-double Metrics::calculateTotalReturn(const std::vector<double>& equityCurve) {
+double Metrics::calculateTotalReturn(SeriesView equityCurve) {
     if (equityCurve.size() < 2) throw std::invalid_argument("Equity curve must have at least two values.");
     return (equityCurve.back() - equityCurve.front()) / equityCurve.front();
 }
 
 // Calculate Annualized Return
-double Metrics::calculateAnnualizedReturn(const std::vector<double>& equityCurve, int periodsPerYear) {
+double Metrics::calculateAnnualizedReturn(SeriesView equityCurve, int periodsPerYear) {
     double totalReturn = calculateTotalReturn(equityCurve);
     double years = static_cast<double>(equityCurve.size()) / periodsPerYear;
     return std::pow(1.0 + totalReturn, 1.0 / years) - 1.0;
 }
 
 // Calculate Win Rate
-double Metrics::calculateWinRate(const std::vector<double>& returns) {
+double Metrics::calculateWinRate(SeriesView returns) {
     if (returns.empty()) throw std::invalid_argument("Returns vector cannot be empty.");
     int wins = std::count_if(returns.begin(), returns.end(), [](double r) { return r > 0.0; });
     return static_cast<double>(wins) / returns.size();
 }
 
 // Calculate Profit Factor
-double Metrics::calculateProfitFactor(const std::vector<double>& returns) {
+double Metrics::calculateProfitFactor(SeriesView returns) {
     if (returns.empty()) throw std::invalid_argument("Returns vector cannot be empty.");
     double grossProfit = 0.0, grossLoss = 0.0;
     for (double r : returns) {
@@ -59,13 +59,13 @@ double Metrics::calculateProfitFactor(const std::vector<double>& returns) {
 }
 
 // Calculate Average Trade Return
-double Metrics::calculateAverageTradeReturn(const std::vector<double>& returns) {
+double Metrics::calculateAverageTradeReturn(SeriesView returns) {
     if (returns.empty()) throw std::invalid_argument("Returns vector cannot be empty.");
     return std::accumulate(returns.begin(), returns.end(), 0.0) / returns.size();
 }
 
 // Calculate Sortino Ratio
-double Metrics::calculateSortinoRatio(const std::vector<double>& returns, double riskFreeRate) {
+double Metrics::calculateSortinoRatio(SeriesView returns, double riskFreeRate) {
     if (returns.empty()) throw std::invalid_argument("Returns vector cannot be empty.");
     double meanReturn = std::accumulate(returns.begin(), returns.end(), 0.0) / returns.size();
     double downsideVariance = 0.0;
@@ -77,14 +77,14 @@ double Metrics::calculateSortinoRatio(const std::vector<double>& returns, double
 }
 
 // Calculate Calmar Ratio
-double Metrics::calculateCalmarRatio(const std::vector<double>& equityCurve, int periodsPerYear) {
+double Metrics::calculateCalmarRatio(SeriesView equityCurve, int periodsPerYear) {
     double annualizedReturn = calculateAnnualizedReturn(equityCurve, periodsPerYear);
     double maxDrawdown = calculateMaxDrawdown(equityCurve);
     return maxDrawdown == 0.0 ? 0.0 : annualizedReturn / maxDrawdown;
 }
 
 // Calculate Expectancy
-double Metrics::calculateExpectancy(const std::vector<double>& returns) {
+double Metrics::calculateExpectancy(SeriesView returns) {
     if (returns.empty()) throw std::invalid_argument("Returns vector cannot be empty.");
     double wins = 0.0, losses = 0.0, winCount = 0, lossCount = 0;
     for (double r : returns) {
@@ -104,8 +104,62 @@ double Metrics::calculateExpectancy(const std::vector<double>& returns) {
     return (winRate * avgWin) + (lossRate * avgLoss);
 }
 
+// Trade-level statistics in one pass over the round trips
+TradeStats Metrics::calculateTradeStats(const std::vector<RoundTrip>& trips) {
+    TradeStats stats;
+    stats.trades = trips.size();
+    if (trips.empty()) return stats;
+
+    double returns = 0.0, holding = 0.0, mae = 0.0, mfe = 0.0;
+    for (const RoundTrip& trip : trips) {
+        if (trip.pnl > 0.0) {
+            ++stats.wins;
+            stats.grossProfit += trip.pnl;
+        }
+        else if (trip.pnl < 0.0) {
+            ++stats.losses;
+            stats.grossLoss -= trip.pnl;
+        }
+        returns += trip.returnOnEntry();
+        holding += static_cast<double>(trip.holdingSeconds());
+        stats.maxHoldingSeconds = std::max(stats.maxHoldingSeconds, trip.holdingSeconds());
+        mae += trip.mae;
+        mfe += trip.mfe;
+    }
+
+    const double count = static_cast<double>(trips.size());
+    stats.winRate = stats.wins / count;
+    stats.netProfit = stats.grossProfit - stats.grossLoss;
+    stats.profitFactor = stats.grossLoss == 0.0 ? 0.0 : stats.grossProfit / stats.grossLoss;
+    stats.expectancy = stats.netProfit / count;
+    stats.averageWin = stats.wins > 0 ? stats.grossProfit / stats.wins : 0.0;
+    stats.averageLoss = stats.losses > 0 ? stats.grossLoss / stats.losses : 0.0;
+    stats.averageReturn = returns / count;
+    stats.averageHoldingSeconds = holding / count;
+    stats.averageMAE = mae / count;
+    stats.averageMFE = mfe / count;
+    return stats;
+}
+
+MetricSummary Metrics::summarize(SeriesView equityCurve, SeriesView returns, const std::vector<RoundTrip>& trips,
+                                 int periodsPerYear) {
+    MetricSummary summary;
+    summary.sharpeRatio = calculateSharpeRatio(returns);
+    summary.maxDrawdown = calculateMaxDrawdown(equityCurve);
+    summary.totalReturn = calculateTotalReturn(equityCurve);
+    summary.annualizedReturn = calculateAnnualizedReturn(equityCurve, periodsPerYear);
+    summary.winRate = calculateWinRate(returns);
+    summary.profitFactor = calculateProfitFactor(returns);
+    summary.averageTradeReturn = calculateAverageTradeReturn(returns);
+    summary.sortinoRatio = calculateSortinoRatio(returns);
+    summary.calmarRatio = calculateCalmarRatio(equityCurve, periodsPerYear);
+    summary.expectancy = calculateExpectancy(returns);
+    summary.trades = calculateTradeStats(trips);
+    return summary;
+}
+
 // Calculate Rolling Returns
-std::vector<double> Metrics::calculateRollingReturns(const std::vector<double>& equityCurve, int windowSize) {
+std::vector<double> Metrics::calculateRollingReturns(SeriesView equityCurve, int windowSize) {
     if (equityCurve.size() < windowSize) throw std::invalid_argument("Equity curve size must be greater than or equal to the window size.");
     std::vector<double> rollingReturns;
     for (size_t i = 0; i <= equityCurve.size() - windowSize; ++i) {
@@ -115,3 +169,35 @@ std::vector<double> Metrics::calculateRollingReturns(const std::vector<double>&
     }
     return rollingReturns;
 }
+
+// ---------------------  Running Metrics  -------------------------------------------
+
+void RunningMetrics::add(double equity) {
+    if (count == 0) {
+        first = peak = equity;
+    }
+    else {
+        const double r = (equity - last) / last;
+        const double delta = r - meanReturn;
+        meanReturn += delta / static_cast<double>(count);
+        squaredDeviations += delta * (r - meanReturn);
+        if (r < 0.0) downsideSquares += r * r;
+    }
+    last = equity;
+    ++count;
+    if (equity > peak) peak = equity;
+    const double drawdown = (peak - equity) / peak;
+    if (drawdown > maxDrawdown) maxDrawdown = drawdown;
+}
+
+double RunningMetrics::getSharpeRatio() const {
+    if (count < 2) return 0.0;
+    const double stdDev = std::sqrt(squaredDeviations / static_cast<double>(count - 1));
+    return stdDev == 0.0 ? 0.0 : meanReturn / stdDev;
+}
+
+double RunningMetrics::getSortinoRatio() const {
+    if (count < 2) return 0.0;
+    const double downsideDeviation = std::sqrt(downsideSquares / static_cast<double>(count - 1));
+    return downsideDeviation == 0.0 ? 0.0 : meanReturn / downsideDeviation;
+}
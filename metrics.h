@@ -1,39 +1,140 @@
 #pragma once
+#include "TradeMatcher.h"
+#include <cstddef>
 #include <vector>
 #include <string>
 
+// Read-only view over a contiguous series of doubles. Lets the metrics take
+// std::vector and std::pmr::vector (arena-backed portfolios) without copying.
+class SeriesView {
+public:
+    SeriesView(const double* data, size_t size) : first(data), count(size) {}
+
+    template <typename Allocator>
+    SeriesView(const std::vector<double, Allocator>& values) : first(values.data()), count(values.size()) {}
+
+    const double* begin() const { return first; }
+    const double* end() const { return first + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    double operator[](size_t index) const { return first[index]; }
+    double front() const { return first[0]; }
+    double back() const { return first[count - 1]; }
+
+private:
+    const double* first;
+    size_t count;
+};
+
+// Trade-level statistics over round trips (see TradeMatcher.h)
+struct TradeStats {
+    size_t trades = 0;
+    size_t wins = 0;                   // Trips with pnl > 0
+    size_t losses = 0;                 // Trips with pnl < 0
+    double winRate = 0.0;              // wins / trades
+    double grossProfit = 0.0;          // Sum of winning pnl
+    double grossLoss = 0.0;            // Sum of losing pnl, as a positive amount
+    double netProfit = 0.0;
+    double profitFactor = 0.0;         // grossProfit / grossLoss (0 without losses)
+    double expectancy = 0.0;           // Average pnl per trade
+    double averageWin = 0.0;
+    double averageLoss = 0.0;          // Positive amount
+    double averageReturn = 0.0;        // Average RoundTrip::returnOnEntry()
+    double averageHoldingSeconds = 0.0;
+    int64_t maxHoldingSeconds = 0;
+    double averageMAE = 0.0;
+    double averageMFE = 0.0;
+};
+
+// Every metric of one run (see Metrics::summarize)
+struct MetricSummary {
+    double totalReturn = 0.0;
+    double annualizedReturn = 0.0;
+    double maxDrawdown = 0.0;
+    double sharpeRatio = 0.0;
+    double sortinoRatio = 0.0;
+    double calmarRatio = 0.0;
+    double winRate = 0.0;              // Per period of the returns series
+    double profitFactor = 0.0;
+    double averageTradeReturn = 0.0;
+    double expectancy = 0.0;
+    TradeStats trades;                 // Per round trip
+};
+
 class Metrics {
 public:
+    // The return-series metrics below treat every period of `returns` as one
+    // observation; calculateTradeStats works on actual round trips.
+
     // Calculate Sharpe Ratio
-    static double calculateSharpeRatio(const std::vector<double>& returns, double riskFreeRate = 0.0);
+    static double calculateSharpeRatio(SeriesView returns, double riskFreeRate = 0.0);
 
     // Calculate Maximum Drawdown
-    static double calculateMaxDrawdown(const std::vector<double>& equityCurve);
+    static double calculateMaxDrawdown(SeriesView equityCurve);
 
     // Calculate Total Return
-    static double calculateTotalReturn(const std::vector<double>& equityCurve);
+    static double calculateTotalReturn(SeriesView equityCurve);
 
     // Calculate Annualized Return
-    static double calculateAnnualizedReturn(const std::vector<double>& equityCurve, int periodsPerYear);
+    static double calculateAnnualizedReturn(SeriesView equityCurve, int periodsPerYear);
 
     // Calculate Win Rate
-    static double calculateWinRate(const std::vector<double>& returns);
+    static double calculateWinRate(SeriesView returns);
 
     // Calculate Profit Factor
-    static double calculateProfitFactor(const std::vector<double>& returns);
+    static double calculateProfitFactor(SeriesView returns);
 
     // Calculate Average Trade Return
-    static double calculateAverageTradeReturn(const std::vector<double>& returns);
+    static double calculateAverageTradeReturn(SeriesView returns);
 
     // Calculate Sortino Ratio
-    static double calculateSortinoRatio(const std::vector<double>& returns, double riskFreeRate = 0.0);
+    static double calculateSortinoRatio(SeriesView returns, double riskFreeRate = 0.0);
 
     // Calculate Calmar Ratio
-    static double calculateCalmarRatio(const std::vector<double>& equityCurve, int periodsPerYear);
+    static double calculateCalmarRatio(SeriesView equityCurve, int periodsPerYear);
 
     // Calculate Expectancy
-    static double calculateExpectancy(const std::vector<double>& returns);
+    static double calculateExpectancy(SeriesView returns);
+
+    // Win rate, profit factor, expectancy, holding period and MAE/MFE of round
+    // trips, in one pass
+    static TradeStats calculateTradeStats(const std::vector<RoundTrip>& trips);
+
+    // All of the above for one run. Throws std::invalid_argument for fewer
+    // than two equity points or no returns, like the metrics it calls.
+    static MetricSummary summarize(SeriesView equityCurve, SeriesView returns, const std::vector<RoundTrip>& trips,
+                                   int periodsPerYear = 252);
 
     // Helper function to calculate rolling returns
-    static std::vector<double> calculateRollingReturns(const std::vector<double>& equityCurve, int windowSize);
+    static std::vector<double> calculateRollingReturns(SeriesView equityCurve, int windowSize);
+};
+
+// Metrics of an equity series kept up to date one value at a time, for a
+// consumer that sees the equity as it is produced (see
+// BacktestingEngine::runPipelined). Returns are taken between consecutive
+// values as in Portfolio's returns series; their moments are accumulated
+// with Welford's method, so the ratios can differ from the two-pass
+// functions above in the last digits.
+class RunningMetrics {
+public:
+    void add(double equity);
+
+    size_t size() const { return count; }
+    double getLastEquity() const { return last; }
+    double getMaxDrawdown() const { return maxDrawdown; }
+
+    // 0 until there are two values, like the ratios below
+    double getTotalReturn() const { return count < 2 ? 0.0 : (last - first) / first; }
+    double getSharpeRatio() const;
+    double getSortinoRatio() const;
+
+private:
+    size_t count = 0;
+    double first = 0.0;
+    double last = 0.0;
+    double peak = 0.0;
+    double maxDrawdown = 0.0;
+    double meanReturn = 0.0;
+    double squaredDeviations = 0.0;   // Sum of squared deviations from meanReturn
+    double downsideSquares = 0.0;     // Sum of squared negative returns
 };
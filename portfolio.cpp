@@ -1,9 +1,16 @@
-#include "Portfolio.h"
+#include "portfolio.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdlib>
 #include <iomanip>
+#include <limits>
 #include <stdexcept>
 
 // Constructor
-Portfolio::Portfolio() : cash(0.0) {}
+Portfolio::Portfolio(std::pmr::memory_resource* resource)
+    : cash(0.0), positions(resource), avgCostBasis(resource), equityCurve(resource), returns(resource),
+      totalCost(resource), tickSizes(resource), instrumentCurrency(resource), currencies(1, resource),
+      trades(resource) {}
 
 // Destructor
 Portfolio::~Portfolio() {}
@@ -12,114 +19,810 @@ Portfolio::~Portfolio() {}
 void Portfolio::setCash(double amount) {
     if (amount < 0) throw std::invalid_argument("Cash amount cannot be negative.");
     cash = amount;
+    if (fixedPoint) {
+        cashMicros = FixedPoint::toMoney(amount);
+        cash = FixedPoint::toDouble(cashMicros);
+    }
+}
+
+// Switch to exact fixed-point accounting
+void Portfolio::setFixedPoint(bool enabled, FixedPoint::TickSize tick) {
+    if (!positions.empty()) throw std::logic_error("Cannot change the accounting mode with open positions.");
+    if (enabled && (!instrumentCurrency.empty() || foreignCashValue != 0)) {
+        throw std::logic_error("Fixed-point accounting supports the base currency only.");
+    }
+    fixedPoint = enabled;
+    defaultTick = tick;
+    if (fixedPoint) {
+        cashMicros = FixedPoint::toMoney(cash);
+        cash = FixedPoint::toDouble(cashMicros);
+    }
+}
+
+void Portfolio::setTickSize(const std::string& symbol, FixedPoint::TickSize tick) {
+    tickSizes.insert_or_assign(symbol, tick);
+    auto it = positions.find(symbol);
+    if (fixedPoint && it != positions.end()) {
+        Position& position = it->second;
+        positionsMicros -= position.exactValue;
+        position.tick = tick;
+        position.exactValue = tick.value(tick.toTicks(position.mark), position.quantity);
+        positionsMicros += position.exactValue;
+    }
+}
+
+const FixedPoint::TickSize& Portfolio::tickSizeOf(const std::string& symbol) const {
+    if (tickSizes.empty()) return defaultTick;
+    auto it = tickSizes.find(symbol);
+    return it == tickSizes.end() ? defaultTick : it->second;
+}
+
+// ---------------------  Currencies  -------------------------------------------
+
+void Portfolio::setBaseCurrency(const std::string& currency) {
+    if (!positions.empty() || fx.size() > 1) throw std::logic_error("Cannot change the base currency once other currencies are in use.");
+    fx = FxRateTable(currency);
+}
+
+uint16_t Portfolio::registerCurrency(const std::string& currency) {
+    const uint16_t id = fx.intern(currency);
+    if (currencies.size() < fx.size()) currencies.resize(fx.size());
+    return id;
+}
+
+void Portfolio::setInstrumentCurrency(const std::string& symbol, const std::string& currency) {
+    if (positions.count(symbol)) throw std::logic_error("Cannot change the currency of an open position.");
+    const uint16_t id = registerCurrency(currency);
+    if (id != 0 && fixedPoint) throw std::logic_error("Fixed-point accounting supports the base currency only.");
+    if (id == 0) instrumentCurrency.erase(symbol);
+    else instrumentCurrency.insert_or_assign(symbol, id);
+}
+
+// Most runs trade in the base currency only, so the map is usually empty
+uint16_t Portfolio::currencyOf(const std::string& symbol) const {
+    if (instrumentCurrency.empty()) return 0;
+    auto it = instrumentCurrency.find(symbol);
+    if (it == instrumentCurrency.end()) return 0;
+    if (!fx.hasRate(it->second)) throw std::runtime_error("No FX rate for currency: " + fx.code(it->second));
+    return it->second;
+}
+
+void Portfolio::addCash(uint16_t currency, double amount) {
+    if (currency == 0) {
+        cash += amount;
+        return;
+    }
+    currencies[currency].cash += amount;
+    foreignCashValue += amount * fx.rate(currency);
+}
+
+void Portfolio::setCash(const std::string& currency, double amount) {
+    if (amount < 0) throw std::invalid_argument("Cash amount cannot be negative.");
+    const int known = fx.find(currency);
+    if (known == 0) {
+        setCash(amount);
+        return;
+    }
+    if (fixedPoint) throw std::logic_error("Fixed-point accounting supports the base currency only.");
+    const uint16_t id = registerCurrency(currency);
+    addCash(id, amount - currencies[id].cash);
+}
+
+double Portfolio::getCash(const std::string& currency) const {
+    const int id = fx.find(currency);
+    return id < 0 ? 0.0 : cashIn(static_cast<uint16_t>(id));
+}
+
+// The per-currency books make a rate change an O(1) update of the base totals
+void Portfolio::setFxRate(const std::string& currency, double rate) {
+    const uint16_t id = registerCurrency(currency);
+    const double previous = fx.rate(id);
+    fx.setRate(id, rate);
+    const double change = rate - previous;
+    const CurrencyBook& book = currencies[id];
+    longValue += book.longValue * change;
+    shortValue += book.shortValue * change;
+    foreignCashValue += book.cash * change;
+}
+
+bool Portfolio::updateFxRate(const std::string& pair, double price) {
+    std::optional<FxQuote> quote = fx.quote(pair, price);
+    if (!quote) return false;
+    setFxRate(quote->currency, quote->rate);
+    return true;
+}
+
+void Portfolio::exchange(const std::string& from, const std::string& to, double amount) {
+    if (amount <= 0) throw std::invalid_argument("Exchange amount must be positive.");
+    if (fixedPoint) throw std::logic_error("Fixed-point accounting supports the base currency only.");
+    const uint16_t source = registerCurrency(from);
+    const uint16_t target = registerCurrency(to);
+    if (!fx.hasRate(source) || !fx.hasRate(target)) throw std::runtime_error("No FX rate for " + from + "/" + to);
+    if (amount > cashIn(source)) throw std::runtime_error("Insufficient " + from + " cash to exchange.");
+    addCash(source, -amount);
+    addCash(target, fx.convert(amount, source, target));
+}
+
+// Switch to a margin account
+void Portfolio::setMarginAccount(const MarginSettings& settings) {
+    if (!positions.empty()) throw std::logic_error("Cannot change the account type with open positions.");
+    if (!(settings.initialMargin > 0 && settings.initialMargin <= 1)) {
+        throw std::invalid_argument("Initial margin must be in (0, 1].");
+    }
+    if (!(settings.maintenanceMargin > 0 && settings.maintenanceMargin <= settings.initialMargin)) {
+        throw std::invalid_argument("Maintenance margin must be positive and at most the initial margin.");
+    }
+    if (!(settings.maxLeverage > 0)) throw std::invalid_argument("Maximum leverage must be positive.");
+    margin = settings;
+    marginAccount = true;
+}
+
+// Gross exposure / equity (infinite once equity is gone while exposed)
+double Portfolio::getLeverage() const {
+    const double gross = getGrossExposure();
+    if (gross == 0) return 0.0;
+    const double equity = getEquity();
+    return equity > 0 ? gross / equity : std::numeric_limits<double>::infinity();
+}
+
+bool Portfolio::isMarginCall() const {
+    const double gross = getGrossExposure();
+    return marginAccount && gross > 0 && getEquity() < margin.maintenanceMargin * gross;
+}
+
+// Whether an order would pass the account's checks, without trading
+bool Portfolio::canTrade(const std::string& symbol, int signedQuantity, double price) const {
+    if (signedQuantity == 0 || price <= 0) return false;
+    price = fillPrice(signedQuantity > 0, std::abs(signedQuantity), price);
+    if (price <= 0) return false;
+    auto it = positions.find(symbol);
+    const int held = it == positions.end() ? 0 : it->second.quantity;
+    int64_t ticks = 0;
+    if (fixedPoint) {
+        const FixedPoint::TickSize& tick = tickSizeOf(symbol);
+        ticks = tick.toTicks(price);
+        price = tick.toPrice(ticks);
+    }
+
+    if (!marginAccount) {
+        if (signedQuantity < 0) return held >= -signedQuantity;
+        if (fixedPoint) return tickSizeOf(symbol).value(ticks, signedQuantity) <= cashMicros;
+        return signedQuantity * price <= cashIn(currencyOf(symbol));
+    }
+    if (static_cast<int64_t>(held) + signedQuantity < 0 && !margin.allowShort) return false;
+    return riskViolation(project(symbol, signedQuantity, price)) == nullptr;
+}
+
+// Set a position's quantity and mark, moving its contribution to the exposure
+// totals of its currency and, at the cached rate, of the base currency
+void Portfolio::moveExposure(Position& position, int quantity, double mark) {
+    CurrencyBook& book = currencies[position.currency];
+    const double rate = fx.rate(position.currency);
+    const double previous = position.quantity * position.mark;
+    if (position.quantity > 0) {
+        book.longValue -= previous;
+        longValue -= previous * rate;
+    }
+    else {
+        book.shortValue += previous;
+        shortValue += previous * rate;
+    }
+    position.quantity = quantity;
+    position.mark = mark;
+    if (fixedPoint) {
+        const FixedPoint::Money exact = position.tick.value(position.tick.toTicks(mark), quantity);
+        positionsMicros += exact - position.exactValue;
+        position.exactValue = exact;
+    }
+    const double value = quantity * mark;
+    if (quantity > 0) {
+        book.longValue += value;
+        longValue += value * rate;
+    }
+    else {
+        book.shortValue -= value;
+        shortValue -= value * rate;
+    }
+}
+
+// Exposure and equity if the order filled at `price`. The symbol is re-marked
+// at the fill price first, so the order itself never changes equity; only
+// the other positions' running totals are used, hence O(1).
+OrderImpact Portfolio::project(const std::string& symbol, int signedQuantity, double price) const {
+    auto it = positions.find(symbol);
+    const int held = it == positions.end() ? 0 : it->second.quantity;
+    const double rate = fx.rate(it == positions.end() ? currencyOf(symbol) : it->second.currency);
+    const double mark = it == positions.end() ? 0.0 : it->second.mark * rate;
+    const double before = held;
+    const double after = before + signedQuantity;
+    price *= rate; // Everything below is in the base currency
+
+    OrderImpact impact;
+    impact.time = currentTime;
+    impact.held = held;
+    impact.after = static_cast<int>(std::clamp<int64_t>(int64_t(held) + signedQuantity,
+        -std::numeric_limits<int>::max(), std::numeric_limits<int>::max()));
+    impact.equity = getEquity() + before * (price - mark);
+    impact.grossBefore = longValue + shortValue + std::abs(before) * (price - mark);
+    impact.grossAfter = impact.grossBefore + (std::abs(after) - std::abs(before)) * price;
+    impact.netBefore = longValue - shortValue + before * (price - mark);
+    impact.netAfter = impact.netBefore + signedQuantity * price;
+    return impact;
+}
+
+// Orders that do not add gross exposure are always allowed, so a margin call
+// can be worked off by closing positions
+const char* Portfolio::riskViolation(const OrderImpact& impact) const {
+    if (impact.grossAfter <= impact.grossBefore) return nullptr;
+    if (impact.equity <= 0) return "Insufficient equity to add exposure.";
+    if (margin.initialMargin * impact.grossAfter > impact.equity) return "Insufficient margin to complete order.";
+    if (impact.grossAfter > margin.maxLeverage * impact.equity) return "Order would exceed the leverage limit.";
+    return nullptr;
+}
+
+RiskCheck Portfolio::checkRisk(const std::string& symbol, int signedQuantity, double price) const {
+    if (!risk) return RiskCheck::Passed;
+    return risk->check(symbol, project(symbol, signedQuantity, price));
+}
+
+void Portfolio::setCostModel(const CostModel& model) {
+    if (!(model.commissionPerShare >= 0 && model.commissionPerOrder >= 0 && model.slippageBps >= 0)) {
+        throw std::invalid_argument("Costs cannot be negative.");
+    }
+    costs = model;
+}
+
+// Orders that pass count towards the order rate whether or not they then fill
+void Portfolio::screen(const std::string& symbol, int signedQuantity, double price) {
+    const RiskCheck result = risk->check(symbol, project(symbol, signedQuantity, price));
+    if (result != RiskCheck::Passed) {
+        risk->onReject(result);
+        throw RiskViolation(result);
+    }
+    risk->onOrder(currentTime);
 }
 
 // Buy shares of a symbol
 void Portfolio::buy(const std::string& symbol, int quantity, double price) {
+    BT_COUNT(Orders, 1);
     if (quantity <= 0 || price <= 0) throw std::invalid_argument("Quantity and price must be positive.");
+    price = fillPrice(true, quantity, price);
+    if (risk) screen(symbol, quantity, price);
+    if (marginAccount) {
+        tradeOnMargin(symbol, quantity, price);
+        return;
+    }
+    if (fixedPoint) {
+        buyFixed(symbol, quantity, price);
+        return;
+    }
+    const uint16_t currency = currencyOf(symbol);
     double cost = quantity * price;
-    if (cost > cash) throw std::runtime_error("Insufficient cash to complete purchase.");
+    if (cost > cashIn(currency)) throw std::runtime_error("Insufficient cash to complete purchase.");
 
-    cash -= cost;
-    positions[symbol] += quantity;
+    addCash(currency, -cost);
+    Position& position = positions[symbol];
+    position.currency = currency;
+    moveExposure(position, position.quantity + quantity, price);
+    trades.record(currentTime, symbol, TradeSide::Buy, quantity, price, cashIn(currency));
+    BT_COUNT(Fills, 1);
 
     // Update average cost basis
     if (avgCostBasis.find(symbol) == avgCostBasis.end()) {
         avgCostBasis[symbol] = price;
+        BT_COUNT(Allocations, 2); // New position and cost basis map nodes
     }
     else {
-        double totalCost = avgCostBasis[symbol] * (positions[symbol] - quantity) + cost;
-        avgCostBasis[symbol] = totalCost / positions[symbol];
+        double totalCost = avgCostBasis[symbol] * (position.quantity - quantity) + cost;
+        avgCostBasis[symbol] = totalCost / position.quantity;
     }
 }
 
 // Sell shares of a symbol
 void Portfolio::sell(const std::string& symbol, int quantity, double price) {
+    BT_COUNT(Orders, 1);
     if (quantity <= 0 || price <= 0) throw std::invalid_argument("Quantity and price must be positive.");
-    if (positions.find(symbol) == positions.end() || positions[symbol] < quantity) {
+    price = fillPrice(false, quantity, price);
+    if (price <= 0) throw std::invalid_argument("Costs exceed the sale price.");
+    if (risk) screen(symbol, -quantity, price);
+    if (marginAccount) {
+        tradeOnMargin(symbol, -quantity, price);
+        return;
+    }
+    auto it = positions.find(symbol);
+    if (it == positions.end() || it->second.quantity < quantity) {
         throw std::runtime_error("Insufficient shares to sell.");
     }
+    if (fixedPoint) {
+        sellFixed(symbol, quantity, price);
+        return;
+    }
 
     double revenue = quantity * price;
-    cash += revenue;
-    positions[symbol] -= quantity;
+    Position& position = it->second;
+    addCash(position.currency, revenue);
+    moveExposure(position, position.quantity - quantity, price);
+    trades.record(currentTime, symbol, TradeSide::Sell, quantity, price, cashIn(position.currency));
+    BT_COUNT(Fills, 1);
 
     // If all shares are sold, remove the symbol from positions and avgCostBasis
-    if (positions[symbol] == 0) {
+    if (position.quantity == 0) {
+        positions.erase(it);
+        avgCostBasis.erase(symbol);
+    }
+}
+
+// Fixed-point buy: the cost is exact and accumulates into the position's total cost
+void Portfolio::buyFixed(const std::string& symbol, int quantity, double price) {
+    const FixedPoint::TickSize& tick = tickSizeOf(symbol);
+    const int64_t ticks = tick.toTicks(price);
+    const FixedPoint::Money cost = tick.value(ticks, quantity);
+    if (cost > cashMicros) throw std::runtime_error("Insufficient cash to complete purchase.");
+
+    cashMicros -= cost;
+    cash = FixedPoint::toDouble(cashMicros);
+    Position& position = positions[symbol];
+    position.tick = tick;
+    moveExposure(position, position.quantity + quantity, tick.toPrice(ticks));
+    trades.record(currentTime, symbol, TradeSide::Buy, quantity, position.mark, cash);
+    BT_COUNT(Fills, 1);
+
+    if (avgCostBasis.find(symbol) == avgCostBasis.end()) BT_COUNT(Allocations, 3); // Position, cost and basis nodes
+    const FixedPoint::Money basis = totalCost[symbol] += cost;
+    avgCostBasis[symbol] = FixedPoint::toDouble(basis) / position.quantity;
+}
+
+// Fixed-point sell: the sold shares take their proportional share of the total cost
+void Portfolio::sellFixed(const std::string& symbol, int quantity, double price) {
+    const FixedPoint::TickSize& tick = tickSizeOf(symbol);
+    const int64_t ticks = tick.toTicks(price);
+    cashMicros += tick.value(ticks, quantity);
+    cash = FixedPoint::toDouble(cashMicros);
+    trades.record(currentTime, symbol, TradeSide::Sell, quantity, tick.toPrice(ticks), cash);
+    Position& position = positions[symbol];
+    FixedPoint::Money& basis = totalCost[symbol];
+    basis -= shareOfCost(basis, quantity, position.quantity);
+    moveExposure(position, position.quantity - quantity, tick.toPrice(ticks));
+    BT_COUNT(Fills, 1);
+
+    if (position.quantity == 0) {
         positions.erase(symbol);
         avgCostBasis.erase(symbol);
+        totalCost.erase(symbol);
+    }
+    else {
+        avgCostBasis[symbol] = FixedPoint::toDouble(basis) / position.quantity;
+    }
+}
+
+// Margin account fill of `signedQuantity` shares (negative sells). The cost
+// basis is the average entry price of the open position, long or short:
+// adding to it averages, reducing it keeps the basis, and crossing through
+// flat starts a new position at the fill price.
+void Portfolio::tradeOnMargin(const std::string& symbol, int signedQuantity, double price) {
+    auto it = positions.find(symbol);
+    const int held = it == positions.end() ? 0 : it->second.quantity;
+    const int64_t wide = static_cast<int64_t>(held) + signedQuantity;
+    if (wide > std::numeric_limits<int>::max() || wide < -std::numeric_limits<int>::max()) {
+        throw std::invalid_argument("Position size out of range.");
+    }
+    const int after = static_cast<int>(wide);
+    if (after < 0 && !margin.allowShort) throw std::runtime_error("Insufficient shares to sell.");
+    const uint16_t currency = it == positions.end() ? currencyOf(symbol) : it->second.currency;
+
+    const int quantity = std::abs(signedQuantity);
+    int64_t ticks = 0;
+    if (fixedPoint) {
+        const FixedPoint::TickSize& tick = tickSizeOf(symbol);
+        ticks = tick.toTicks(price);
+        price = tick.toPrice(ticks);
+    }
+    if (const char* violation = riskViolation(project(symbol, signedQuantity, price))) throw std::runtime_error(violation);
+
+    FixedPoint::Money value = 0;
+    if (fixedPoint) {
+        value = tickSizeOf(symbol).value(ticks, quantity);
+        cashMicros += signedQuantity > 0 ? -value : value;
+        cash = FixedPoint::toDouble(cashMicros);
+    }
+    else {
+        addCash(currency, -signedQuantity * price);
+    }
+
+    if (it == positions.end()) {
+        it = positions.try_emplace(symbol).first;
+        it->second.currency = currency;
+        if (fixedPoint) it->second.tick = tickSizeOf(symbol);
+        BT_COUNT(Allocations, fixedPoint ? 3 : 2); // Position, basis (and cost) nodes
+    }
+    moveExposure(it->second, after, price);
+    trades.record(currentTime, symbol, signedQuantity > 0 ? TradeSide::Buy : TradeSide::Sell, quantity, price, cashIn(currency));
+    BT_COUNT(Fills, 1);
+
+    if (after == 0) {
+        positions.erase(it);
+        avgCostBasis.erase(symbol);
+        totalCost.erase(symbol);
+        return;
+    }
+    const bool crossed = held != 0 && (held > 0) != (after > 0);
+    const bool adding = held == 0 || (!crossed && std::abs(after) > std::abs(held));
+    if (fixedPoint) {
+        FixedPoint::Money& basis = totalCost[symbol]; // Cost of the open shares, long or short
+        if (crossed) basis = tickSizeOf(symbol).value(ticks, std::abs(after));
+        else if (adding) basis += value;
+        else basis -= shareOfCost(basis, quantity, std::abs(held));
+        avgCostBasis[symbol] = FixedPoint::toDouble(basis) / std::abs(after);
+    }
+    else if (crossed || held == 0) {
+        avgCostBasis[symbol] = price;
+    }
+    else if (adding) {
+        double& basis = avgCostBasis[symbol];
+        basis = (basis * std::abs(held) + price * quantity) / std::abs(after);
     }
 }
 
 // Print the current portfolio holdings
 void Portfolio::printPortfolio() const {
-    std::cout << "\nPortfolio Holdings:" << std::endl;
-    std::cout << "-------------------" << std::endl;
-    for (const auto& [symbol, quantity] : positions) {
-        std::cout << symbol << ": " << quantity << " shares, Avg Cost: $"
+    if (!log) return;
+    *log << "\nPortfolio Holdings:" << std::endl;
+    *log << "-------------------" << std::endl;
+    for (const auto& [symbol, position] : positions) {
+        *log << symbol << ": " << position.quantity << " shares, Avg Cost: $"
             << std::fixed << std::setprecision(2) << avgCostBasis.at(symbol) << std::endl;
     }
-    std::cout << "Cash: $" << std::fixed << std::setprecision(2) << cash << std::endl;
+    *log << "Cash: $" << std::fixed << std::setprecision(2) << cash << std::endl;
+    for (size_t id = 1; id < currencies.size(); ++id) {
+        if (currencies[id].cash == 0) continue;
+        *log << "Cash (" << fx.code(static_cast<uint16_t>(id)) << "): " << std::fixed << std::setprecision(2)
+            << currencies[id].cash << std::endl;
+    }
 }
 
-// Get the total net worth of the portfolio (cash + value of positions)
+// Get the total net worth of the portfolio (cash + value of positions at their latest marks)
 double Portfolio::getNetWorth() const {
-    double netWorth = cash;
-    for (const auto& [symbol, quantity] : positions) {
-        // Assuming latest prices are known and managed elsewhere
-        // Replace 'currentPrice' with actual price from data source
-        double currentPrice = 0.0; // Placeholder
-        netWorth += quantity * currentPrice;
-    }
-    return netWorth;
+    return getEquity();
 }
 
-// Get the position (number of shares) for a specific symbol
+// Get the position (number of shares, negative for a short) for a specific symbol
 int Portfolio::getPosition(const std::string& symbol) const {
-    if (positions.find(symbol) == positions.end()) return 0;
-    return positions.at(symbol);
+    auto it = positions.find(symbol);
+    return it == positions.end() ? 0 : it->second.quantity;
+}
+
+// Choose which net worth points are stored
+void Portfolio::setEquitySampling(EquitySampling mode, size_t interval) {
+    if (mode == EquitySampling::EveryNth && interval == 0) throw std::invalid_argument("Sampling interval must be positive.");
+    sampling = mode;
+    samplingInterval = mode == EquitySampling::EveryNth ? interval : 1;
 }
 
-void Portfolio::updateNetWorth(const std::unordered_map<std::string, double>& currentPrices) {
-    // Calculate total value starting with cash
-    double totalValue = cash;
+// Pre-size the equity curve and returns for the expected number of recorded points
+void Portfolio::reserveHistory(size_t bars, size_t sessions) {
+    size_t points = bars;
+    if (sampling == EquitySampling::EveryNth) points = bars / samplingInterval + 2;
+    else if (sampling == EquitySampling::SessionClose) points = sessions + 1;
 
-    // Iterate through all positions to calculate their market value
-    for (const auto& [symbol, quantity] : positions) {
+    equityCurve.reserve(equityCurve.size() + points);
+    returns.reserve(returns.size() + points);
+}
+
+void Portfolio::updateNetWorth(const std::unordered_map<std::string, double>& currentPrices, bool sessionClose) {
+    // Take the latest price of every position; symbols without one keep their last mark
+    for (auto& [symbol, position] : positions) {
         auto it = currentPrices.find(symbol);
         if (it != currentPrices.end()) {
-            double currentPrice = it->second; // Get the latest price for the symbol
-            totalValue += quantity * currentPrice;
+            markPosition(position, it->second);
         }
         else {
             std::cerr << "Warning: No current price available for symbol: " << symbol << std::endl;
         }
     }
+    recordUpdate(markedNetWorth(), sessionClose);
+}
 
-    // Add the current net worth to the equity curve
-    equityCurve.push_back(totalValue);
+void Portfolio::updateNetWorth(const std::string& symbol, double price, bool sessionClose) {
+    auto it = positions.find(symbol);
+    if (it != positions.end()) {
+        markPosition(it->second, price);
+    }
+    recordUpdate(markedNetWorth(), sessionClose);
+}
 
-    // Calculate returns if there is more than one data point in the equity curve
-    if (equityCurve.size() > 1) {
-        double lastReturn = (equityCurve.back() - equityCurve[equityCurve.size() - 2]) / equityCurve[equityCurve.size() - 2];
-        returns.push_back(lastReturn);
+// Re-mark one position, applying the change in its value to the running totals
+void Portfolio::markPosition(Position& position, double price) {
+    if (fixedPoint) price = position.tick.toPrice(position.tick.toTicks(price));
+    moveExposure(position, position.quantity, price);
+}
+
+// Full re-sum of the running totals, for when they cannot be carried forward
+// (a loaded snapshot stores only the marks). Marks and fills adjust them in O(1).
+void Portfolio::revalue() {
+    longValue = 0.0;
+    shortValue = 0.0;
+    foreignCashValue = 0.0;
+    positionsMicros = 0;
+    for (size_t id = 0; id < currencies.size(); ++id) {
+        CurrencyBook& book = currencies[id];
+        book.longValue = 0.0;
+        book.shortValue = 0.0;
+        foreignCashValue += book.cash * fx.rate(static_cast<uint16_t>(id));
+    }
+
+    for (auto& [symbol, position] : positions) {
+        const int quantity = position.quantity;
+        CurrencyBook& book = currencies[position.currency];
+        if (quantity > 0) book.longValue += quantity * position.mark;
+        else book.shortValue -= quantity * position.mark;
+        if (fixedPoint) {
+            position.tick = tickSizeOf(symbol);
+            position.exactValue = position.tick.value(position.tick.toTicks(position.mark), quantity);
+            positionsMicros += position.exactValue;
+        }
+    }
+    for (size_t id = 0; id < currencies.size(); ++id) {
+        const double rate = fx.rate(static_cast<uint16_t>(id));
+        longValue += currencies[id].longValue * rate;
+        shortValue += currencies[id].shortValue * rate;
+    }
+}
+
+// Feed the risk engine and the equity curve with a new net worth
+void Portfolio::recordUpdate(double totalValue, bool sessionClose) {
+    if (risk) risk->onEquity(getEquity(), sessionClose);
+
+    // Add the current net worth to the equity curve if the sampling policy keeps this bar
+    bool keep = sampling == EquitySampling::Full
+        || (sampling == EquitySampling::EveryNth && barsSeen % samplingInterval == 0)
+        || (sampling == EquitySampling::SessionClose && sessionClose);
+    ++barsSeen;
+    if (keep) {
+        recordNetWorth(totalValue);
+        hasPending = false;
+    }
+    else {
+        pendingNetWorth = totalValue;
+        hasPending = true;
     }
 
     // Log the updated net worth (optional)
-    std::cout << "Updated Net Worth: $" << std::fixed << std::setprecision(2) << totalValue << std::endl;
+    if (log) *log << "Updated Net Worth: $" << std::fixed << std::setprecision(2) << totalValue << std::endl;
+}
+
+// Record the final net worth if the sampling policy skipped it
+void Portfolio::closeHistory() {
+    if (hasPending) {
+        recordNetWorth(pendingNetWorth);
+        hasPending = false;
+    }
+}
+
+// Append a point to the equity curve and its return to the returns series
+void Portfolio::recordNetWorth(double netWorth) {
+    BT_COUNT(Allocations, equityCurve.size() == equityCurve.capacity());
+    equityCurve.push_back(netWorth);
+
+    // Calculate returns if there is an earlier data point (possibly before a fork)
+    if (hasRecorded) {
+        double lastReturn = (netWorth - lastRecorded) / lastRecorded;
+        BT_COUNT(Allocations, returns.size() == returns.capacity());
+        returns.push_back(lastReturn);
+    }
+    lastRecorded = netWorth;
+    hasRecorded = true;
 }
 
 
 // Get the equity curve (historical net worth values)
-const std::vector<double>& Portfolio::getEquityCurve() const {
+const std::pmr::vector<double>& Portfolio::getEquityCurve() const {
     return equityCurve;
 }
 
 // Get the returns over time
-const std::vector<double>& Portfolio::getReturns() const {
+const std::pmr::vector<double>& Portfolio::getReturns() const {
     return returns;
 }
 
+// ---------------------  Checkpoints  -------------------------------------------
+
+// Settings structs are written field by field, so their padding bytes never
+// reach a checkpoint or its checksum
+namespace {
+
+void writeSettings(SnapshotWriter& out, const MarginSettings& margin, const CostModel& costs) {
+    out.write(margin.allowShort);
+    out.write(margin.initialMargin);
+    out.write(margin.maintenanceMargin);
+    out.write(margin.maxLeverage);
+    out.write(costs.commissionPerShare);
+    out.write(costs.commissionPerOrder);
+    out.write(costs.slippageBps);
+}
+
+void readSettings(SnapshotReader& in, MarginSettings& margin, CostModel& costs) {
+    in.read(margin.allowShort);
+    in.read(margin.initialMargin);
+    in.read(margin.maintenanceMargin);
+    in.read(margin.maxLeverage);
+    in.read(costs.commissionPerShare);
+    in.read(costs.commissionPerOrder);
+    in.read(costs.slippageBps);
+}
+
+FixedPoint::TickSize readTick(SnapshotReader& in) {
+    return FixedPoint::TickSize(FixedPoint::toDouble(in.read<int64_t>()));
+}
+
+} // namespace
+
+void Portfolio::saveState(SnapshotWriter& out) const {
+    writeState(out, true);
+}
+
+void Portfolio::loadState(SnapshotReader& in) {
+    readState(in, true);
+}
+
+void Portfolio::saveBook(SnapshotWriter& out) const {
+    writeState(out, false);
+}
+
+void Portfolio::loadBook(SnapshotReader& in) {
+    readState(in, false);
+}
+
+void Portfolio::prependHistory(const std::vector<std::pair<const Portfolio*, HistoryMark>>& prefixes) {
+    auto prepend = [&](std::pmr::vector<double>& series, const std::pmr::vector<double> Portfolio::*member,
+                       size_t HistoryMark::*length) {
+        size_t total = series.size();
+        for (const auto& [prefix, mark] : prefixes) total += mark.*length;
+        std::pmr::vector<double> joined(series.get_allocator());
+        joined.reserve(std::max(total, series.capacity()));
+        for (const auto& [prefix, mark] : prefixes) {
+            const std::pmr::vector<double>& source = prefix->*member;
+            joined.insert(joined.end(), source.begin(), source.begin() + mark.*length);
+        }
+        joined.insert(joined.end(), series.begin(), series.end());
+        series = std::move(joined);
+    };
+    prepend(equityCurve, &Portfolio::equityCurve, &HistoryMark::equityPoints);
+    prepend(returns, &Portfolio::returns, &HistoryMark::returns);
+
+    std::vector<std::pair<const TradeLedger*, size_t>> fills;
+    for (const auto& [prefix, mark] : prefixes) fills.emplace_back(&prefix->trades, mark.fills);
+    trades.prependRecords(fills);
+}
+
+void Portfolio::writeState(SnapshotWriter& out, bool history) const {
+    out.write(cash);
+    out.write<uint64_t>(positions.size());
+    for (const auto& [symbol, position] : positions) {
+        out.writeString(symbol);
+        out.write(position.quantity);
+        out.write(position.mark);
+        out.write(position.currency);
+        auto basis = avgCostBasis.find(symbol);
+        out.write(basis == avgCostBasis.end() ? 0.0 : basis->second);
+        auto cost = totalCost.find(symbol);
+        out.write<FixedPoint::Money>(cost == totalCost.end() ? 0 : cost->second);
+    }
+    if (history) {
+        out.writeVector(equityCurve);
+        out.writeVector(returns);
+    }
+    else {
+        out.write(hasRecorded);
+        out.write(lastRecorded);
+    }
+    out.write(sampling);
+    out.write<uint64_t>(samplingInterval);
+    out.write<uint64_t>(barsSeen);
+    out.write(pendingNetWorth);
+    out.write(hasPending);
+
+    out.write(fixedPoint);
+    out.write(cashMicros);
+    out.write(defaultTick.micros());
+    out.write<uint64_t>(tickSizes.size());
+    for (const auto& [symbol, tick] : tickSizes) {
+        out.writeString(symbol);
+        out.write(tick.micros());
+    }
+
+    out.write(marginAccount);
+    writeSettings(out, margin, costs);
+    fx.saveState(out);
+    out.write<uint64_t>(instrumentCurrency.size());
+    for (const auto& [symbol, currency] : instrumentCurrency) {
+        out.writeString(symbol);
+        out.write(currency);
+    }
+    out.writeVector(currencies);
+
+    if (history) trades.saveState(out);
+    else trades.saveSymbols(out);
+    out.write(currentTime);
+    out.write(risk != nullptr);
+    if (risk) risk->saveState(out);
+}
+
+void Portfolio::readState(SnapshotReader& in, bool history) {
+    in.read(cash);
+    positions.clear();
+    avgCostBasis.clear();
+    totalCost.clear();
+    const uint64_t positionCount = in.read<uint64_t>();
+    for (uint64_t i = 0; i < positionCount; ++i) {
+        const std::string symbol = in.readString();
+        Position& position = positions[symbol];
+        in.read(position.quantity);
+        in.read(position.mark);
+        in.read(position.currency);
+        avgCostBasis[symbol] = in.read<double>();
+        const FixedPoint::Money cost = in.read<FixedPoint::Money>();
+        if (cost != 0) totalCost[symbol] = cost;
+    }
+    if (history) {
+        in.readVector(equityCurve);
+        in.readVector(returns);
+        hasRecorded = !equityCurve.empty();
+        lastRecorded = hasRecorded ? equityCurve.back() : 0.0;
+    }
+    else {
+        equityCurve.clear();
+        returns.clear();
+        in.read(hasRecorded);
+        in.read(lastRecorded);
+    }
+    in.read(sampling);
+    samplingInterval = static_cast<size_t>(in.read<uint64_t>());
+    barsSeen = static_cast<size_t>(in.read<uint64_t>());
+    in.read(pendingNetWorth);
+    in.read(hasPending);
+
+    in.read(fixedPoint);
+    in.read(cashMicros);
+    defaultTick = readTick(in);
+    tickSizes.clear();
+    const uint64_t tickCount = in.read<uint64_t>();
+    for (uint64_t i = 0; i < tickCount; ++i) {
+        const std::string symbol = in.readString();
+        tickSizes.insert_or_assign(symbol, readTick(in));
+    }
+
+    in.read(marginAccount);
+    readSettings(in, margin, costs);
+    fx.loadState(in);
+    instrumentCurrency.clear();
+    const uint64_t currencyCount = in.read<uint64_t>();
+    for (uint64_t i = 0; i < currencyCount; ++i) {
+        const std::string symbol = in.readString();
+        instrumentCurrency.insert_or_assign(symbol, in.read<uint16_t>());
+    }
+    in.readVector(currencies);
+    if (currencies.size() != fx.size()) throw std::runtime_error("Corrupt portfolio snapshot.");
+    for (const auto& [symbol, position] : positions) {
+        if (position.currency >= currencies.size()) throw std::runtime_error("Corrupt portfolio snapshot.");
+    }
+
+    if (history) {
+        trades.loadState(in);
+    }
+    else {
+        trades.clear();
+        trades.loadSymbols(in);
+    }
+    in.read(currentTime);
+    if (in.read<bool>()) {
+        if (risk) risk->loadState(in);
+        else RiskEngine().loadState(in); // Skip the saved state
+    }
+
+    // The running totals are derived from the marks
+    revalue();
+}
+
 // Get the average cost basis for a specific symbol
 double Portfolio::getAvgCostBasis(const std::string& symbol) const {
     if (avgCostBasis.find(symbol) == avgCostBasis.end()) {
@@ -1,52 +1,368 @@
 #pragma once
+#include "FixedPoint.h"
+#include "FxRates.h"
+#include "RiskEngine.h"
+#include "TradeLedger.h"
 #include <iostream>
+#include <memory_resource>
 #include <unordered_map>
 #include <vector>
 #include <string>
 
+// Which net worth points are kept in the equity curve
+enum class EquitySampling {
+    Full,         // Every bar
+    EveryNth,     // Every Nth bar (plus the final bar)
+    SessionClose  // Last bar of each session
+};
+
+// Margin account settings (see Portfolio::setMarginAccount)
+struct MarginSettings {
+    bool allowShort = true;           // Sells beyond the position open a short
+    double initialMargin = 0.5;       // Equity required per unit of gross exposure to add risk
+    double maintenanceMargin = 0.25;  // Equity per unit of gross exposure below which isMarginCall()
+    double maxLeverage = 2.0;         // Cap on gross exposure / equity for risk-increasing orders
+};
+
+// Trading costs charged on every fill (see Portfolio::setCostModel)
+struct CostModel {
+    double commissionPerShare = 0.0;
+    double commissionPerOrder = 0.0;  // Flat fee per fill
+    double slippageBps = 0.0;         // Price move against the order, in basis points
+
+    bool isFree() const { return commissionPerShare == 0.0 && commissionPerOrder == 0.0 && slippageBps == 0.0; }
+
+    // All-in price per share of a fill of `quantity` shares at `price`: moved
+    // against the order by the slippage, with the commissions spread over the
+    // shares (added for buys, deducted for sells)
+    double fillPrice(bool buying, int quantity, double price) const {
+        const double cost = price * slippageBps * 1e-4 + commissionPerShare + commissionPerOrder / quantity;
+        return buying ? price + cost : price - cost;
+    }
+};
+
 // ---------------------  Portfolio  -------------------------------------------
+//
+// All per-run containers allocate from the memory resource given at
+// construction, so a sweep can back them with a RunArena.
+//
+// In fixed-point mode (setFixedPoint) cash, cost basis and valuations are
+// exact micro-unit integers (see FixedPoint.h): fill and mark prices are
+// rounded to the symbol's tick, and the double accessors report the exact
+// amounts converted once.
+//
+// A margin account (setMarginAccount) may borrow cash and, if allowed, sell
+// short. Long and short exposure at the latest marks are kept as running
+// totals, adjusted by each fill and each mark (and re-summed only when a
+// snapshot is loaded), so exposure, leverage and margin checks are O(1) per
+// order and a bar's net worth update is O(1) however many positions are
+// open. In fixed-point mode the exact value of the positions is a running
+// total as well, each position caching its tick size and exact value.
+//
+// Instruments may be quoted in other currencies than the base currency
+// (setInstrumentCurrency). Their fills settle in a cash balance of that
+// currency, and they are valued in the base currency through the FX rate
+// table: a position keeps its currency id, so marking it costs one multiply
+// by the cached rate. Exposure is also kept per currency, so an FX update
+// re-values the totals in O(1) as well.
+//
+// A cost model (setCostModel) folds commissions and slippage into the fill
+// price, so cash, cost basis, the ledger and every check see the all-in price.
 class Portfolio {
 private:
-    double cash; // Available cash balance
-    std::unordered_map<std::string, int> positions; // Symbol -> Quantity
-    std::unordered_map<std::string, double> avgCostBasis; // Symbol -> Average cost basis per share
-    std::vector<double> equityCurve; // Tracks portfolio net worth over time
-    std::vector<double> returns; // Stores returns over time
+    struct Position {
+        int quantity = 0;       // Negative for a short
+        double mark = 0.0;      // Latest fill or valuation price, in the instrument's currency
+        uint16_t currency = 0;  // Id in `fx` (0 is the base currency)
+        FixedPoint::TickSize tick;      // Tick size of the symbol (fixed-point mode)
+        FixedPoint::Money exactValue = 0; // quantity * mark, exactly (fixed-point mode)
+    };
+
+    // Cash and exposure of one currency, in that currency
+    struct CurrencyBook {
+        double cash = 0.0;        // Unused for the base currency (see `cash`)
+        double longValue = 0.0;
+        double shortValue = 0.0;
+    };
+
+    double cash; // Available base currency cash (negative when borrowing on margin)
+    std::pmr::unordered_map<std::string, Position> positions; // Symbol -> Quantity and mark
+    std::pmr::unordered_map<std::string, double> avgCostBasis; // Symbol -> Average cost basis per share
+    std::pmr::vector<double> equityCurve; // Tracks portfolio net worth over time
+    std::pmr::vector<double> returns; // Stores returns over time
+    EquitySampling sampling = EquitySampling::Full; // Which points are recorded
+    size_t samplingInterval = 1; // N for EquitySampling::EveryNth
+    size_t barsSeen = 0; // Net worth updates since the start of the run
+    double lastRecorded = 0.0; // Latest equity point, which the next return is taken from
+    bool hasRecorded = false; // Whether any equity point was recorded (here or before a fork)
+    double pendingNetWorth = 0.0; // Latest net worth not yet recorded
+    bool hasPending = false; // Whether pendingNetWorth is unrecorded
+
+    bool fixedPoint = false; // Whether the exact members below are authoritative
+    FixedPoint::Money cashMicros = 0; // Cash in fixed-point mode (cash mirrors it)
+    std::pmr::unordered_map<std::string, FixedPoint::Money> totalCost; // Symbol -> Cost of the open position
+    std::pmr::unordered_map<std::string, FixedPoint::TickSize> tickSizes; // Symbols with their own tick size
+    FixedPoint::TickSize defaultTick; // Tick size of every other symbol
+    FixedPoint::Money positionsMicros = 0; // Sum of the positions' exact values (fixed-point mode)
+
+    bool marginAccount = false; // Whether `margin` applies
+    MarginSettings margin;
+    CostModel costs;
+    double longValue = 0.0;  // Sum of long positions at their marks (base currency)
+    double shortValue = 0.0; // Sum of short positions at their marks (base currency, positive)
+
+    FxRateTable fx; // Currencies and their rates to the base currency
+    std::pmr::unordered_map<std::string, uint16_t> instrumentCurrency; // Symbols not quoted in the base currency
+    std::pmr::vector<CurrencyBook> currencies; // By currency id
+    double foreignCashValue = 0.0; // Non-base cash balances in the base currency
+
+    RiskEngine* risk = nullptr; // Pre-trade checks, if any (not owned)
+    std::ostream* log = &std::cout; // Net worth log and holdings report (null: silent)
+
+    TradeLedger trades; // Every fill of the run
+    int64_t currentTime = 0; // Bar time stamped on fills (set by the engine)
+
+    // Append a point to the equity curve and its return to the returns series
+    void recordNetWorth(double netWorth);
+
+    // saveState / loadState, with or without the equity curve, returns and fills
+    void writeState(SnapshotWriter& out, bool history) const;
+    void readState(SnapshotReader& in, bool history);
+
+    const FixedPoint::TickSize& tickSizeOf(const std::string& symbol) const;
+    void buyFixed(const std::string& symbol, int quantity, double price);
+    void sellFixed(const std::string& symbol, int quantity, double price);
+
+    // cost * quantity / held without overflowing the product
+    static FixedPoint::Money shareOfCost(FixedPoint::Money cost, int quantity, int held) {
+        return cost / held * quantity + cost % held * quantity / held;
+    }
+
+    // Exposure and equity if `signedQuantity` (negative sells) filled at `price`
+    OrderImpact project(const std::string& symbol, int signedQuantity, double price) const;
+
+    // Why a projected order breaks the margin or leverage limits (null if it does not)
+    const char* riskViolation(const OrderImpact& impact) const;
+
+    // Run the risk engine's checks; throws RiskViolation for a rejected order
+    void screen(const std::string& symbol, int signedQuantity, double price);
+
+    // Set a position's quantity and mark, moving its contribution to the exposure totals
+    void moveExposure(Position& position, int quantity, double mark);
+
+    void tradeOnMargin(const std::string& symbol, int signedQuantity, double price);
+
+    // Currency id of a symbol; throws std::runtime_error while its rate is unknown
+    uint16_t currencyOf(const std::string& symbol) const;
+
+    // Cash balance of a currency
+    double cashIn(uint16_t currency) const { return currency == 0 ? cash : currencies[currency].cash; }
+    void addCash(uint16_t currency, double amount);
+
+    uint16_t registerCurrency(const std::string& currency);
+
+    // Recompute every running total from the marks (after loading a snapshot)
+    void revalue();
+
+    // Move a position's mark to `price` (its nearest tick in fixed-point mode)
+    void markPosition(Position& position, double price);
+
+    // Net worth at the latest marks, exact in fixed-point mode
+    double markedNetWorth() const {
+        return fixedPoint ? FixedPoint::toDouble(cashMicros + positionsMicros) : getEquity();
+    }
+
+    // Feed the risk engine and the equity curve with a new net worth
+    void recordUpdate(double totalValue, bool sessionClose);
 
 public:
-    Portfolio();
+    explicit Portfolio(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     ~Portfolio();
 
     // Set initial cash amount
     void setCash(double amount);
 
+    // Switch to exact fixed-point accounting with `defaultTick` for symbols
+    // without their own tick size. Call before setCash and the first trade;
+    // throws std::logic_error once positions are open.
+    void setFixedPoint(bool enabled, FixedPoint::TickSize defaultTick = FixedPoint::TickSize());
+
+    bool isFixedPoint() const { return fixedPoint; }
+
+    // Tick size used for `symbol` in fixed-point mode
+    void setTickSize(const std::string& symbol, FixedPoint::TickSize tick);
+    const FixedPoint::TickSize& getTickSize(const std::string& symbol) const { return tickSizeOf(symbol); }
+
+    // Exact cash in micro-units (fixed-point mode)
+    FixedPoint::Money getCashMicros() const { return cashMicros; }
+
+    // Turn this into a margin account: purchases may exceed cash, sells may
+    // open shorts (if allowed), and orders that add exposure must leave
+    // equity >= initialMargin * gross exposure and gross <= maxLeverage *
+    // equity. Call before the first trade; throws std::logic_error once
+    // positions are open and std::invalid_argument for inconsistent settings.
+    void setMarginAccount(const MarginSettings& settings);
+
+    bool isMarginAccount() const { return marginAccount; }
+    const MarginSettings& getMarginSettings() const { return margin; }
+
+    // Charge `model` on every later fill; throws std::invalid_argument for negative costs
+    void setCostModel(const CostModel& model);
+    const CostModel& getCostModel() const { return costs; }
+
+    // All-in price of a fill under the cost model (`price` itself without costs)
+    double fillPrice(bool buying, int quantity, double price) const {
+        return costs.isFree() ? price : costs.fillPrice(buying, quantity, price);
+    }
+
+    // Exposure at the latest marks, all O(1)
+    double getLongExposure() const { return longValue; }
+    double getShortExposure() const { return shortValue; }
+    double getGrossExposure() const { return longValue + shortValue; }
+    double getNetExposure() const { return longValue - shortValue; }
+
+    // Cash in every currency plus net exposure, in the base currency
+    double getEquity() const { return cash + foreignCashValue + longValue - shortValue; }
+
+    // Gross exposure / equity (0 when flat)
+    double getLeverage() const;
+
+    // Equity the current exposure ties up (initialMargin * gross exposure)
+    double getMarginUsed() const { return margin.initialMargin * getGrossExposure(); }
+
+    // Equity below the maintenance requirement
+    bool isMarginCall() const;
+
+    // Whether an order of `signedQuantity` shares (negative sells) at `price`
+    // would pass the account's checks (cash, shares, margin and leverage),
+    // without trading
+    bool canTrade(const std::string& symbol, int signedQuantity, double price) const;
+
+    // Screen every order through `engine` (null to remove it). Rejected orders
+    // throw RiskViolation before anything is filled, and each net worth update
+    // feeds the engine's drawdown kill switches. The engine must outlive its use.
+    void setRiskEngine(RiskEngine* engine) { risk = engine; }
+    RiskEngine* getRiskEngine() const { return risk; }
+
+    // Result of the risk engine's checks for an order, without trading
+    // (RiskCheck::Passed without an engine)
+    RiskCheck checkRisk(const std::string& symbol, int signedQuantity, double price) const;
+
+    // Currency valuations are reported in (default USD). Call before any
+    // other currency is used; throws std::logic_error afterwards.
+    void setBaseCurrency(const std::string& currency);
+    const std::string& getBaseCurrency() const { return fx.getBaseCurrency(); }
+
+    // Currency `symbol` is quoted and settled in. Call before trading it; throws
+    // std::logic_error with an open position, and in fixed-point mode for
+    // any currency but the base currency.
+    void setInstrumentCurrency(const std::string& symbol, const std::string& currency);
+
+    // Set the cash balance of a currency (the base currency is setCash(amount))
+    void setCash(const std::string& currency, double amount);
+
+    // Cash balance of a currency (0 for one never used)
+    double getCash(const std::string& currency) const;
+
+    // Base currency units per unit of `currency`
+    void setFxRate(const std::string& currency, double rate);
+
+    // Apply an FX bar (see FxRateTable::onBar); returns false for crosses not
+    // involving the base currency
+    bool updateFxRate(const std::string& pair, double price);
+
+    const FxRateTable& getFxRates() const { return fx; }
+
+    // Convert `amount` of cash from one currency to another at the current rate
+    void exchange(const std::string& from, const std::string& to, double amount);
+
     // Buy shares of a symbol
     void buy(const std::string& symbol, int quantity, double price);
 
     // Sell shares of a symbol
     void sell(const std::string& symbol, int quantity, double price);
 
+    // Time of the bar being processed (epoch seconds), stamped on the fills
+    // that follow; the engine sets it before handing each bar to the strategy
+    void setTime(int64_t epochSeconds) { currentTime = epochSeconds; }
+
+    // Every fill so far, in order
+    const TradeLedger& getTrades() const { return trades; }
+
+    // Mutable ledger, to reserve capacity or attach a journal
+    TradeLedger& getTrades() { return trades; }
+
     // Print the current portfolio holdings
     void printPortfolio() const;
 
-    // Get the total net worth of the portfolio (cash + positions value)
+    // Stream for the per-bar net worth log and printPortfolio (std::cout by
+    // default); null turns both off
+    void setLog(std::ostream* stream) { log = stream; }
+    std::ostream* getLog() const { return log; }
+
+    // Get the total net worth of the portfolio (cash + positions value at their latest marks)
     double getNetWorth() const;
 
-    // Get the current cash balance
+    // Get the current cash balance (base currency)
     double getCash() const { return cash; }
 
-    // Get the position (number of shares) for a specific symbol
+    // Get the position (number of shares, negative for a short) for a specific symbol
     int getPosition(const std::string& symbol) const;
 
-    // Update net worth based on the latest price data
-    void updateNetWorth(const std::unordered_map<std::string, double>& currentPrices);
+    // Choose which net worth points are stored (interval is N for EveryNth)
+    void setEquitySampling(EquitySampling mode, size_t interval = 1);
+
+    EquitySampling getEquitySampling() const { return sampling; }
+    size_t getEquitySamplingInterval() const { return samplingInterval; }
+
+    // Pre-size the equity curve and returns for a run of `bars` bars spanning
+    // `sessions` sessions, so updateNetWorth never reallocates
+    void reserveHistory(size_t bars, size_t sessions);
+
+    // Update net worth based on the latest price data. `sessionClose` marks the
+    // last bar of a session (used by EquitySampling::SessionClose).
+    void updateNetWorth(const std::unordered_map<std::string, double>& currentPrices, bool sessionClose = false);
+
+    // Update net worth when only `symbol` has a new price (a single-instrument
+    // bar); other positions keep their last marks
+    void updateNetWorth(const std::string& symbol, double price, bool sessionClose = false);
+
+    // Record the final net worth if the sampling policy skipped it; call at the end of a run
+    void closeHistory();
 
     // Get the equity curve (historical net worth values)
-    const std::vector<double>& getEquityCurve() const;
+    const std::pmr::vector<double>& getEquityCurve() const;
 
     // Get the returns over time
-    const std::vector<double>& getReturns() const;
+    const std::pmr::vector<double>& getReturns() const;
 
     // Get the average cost basis for a specific symbol
     double getAvgCostBasis(const std::string& symbol) const;
+
+    // Everything the portfolio accumulated (cash, positions, history, fills,
+    // settings and the attached risk engine's state) for a checkpoint.
+    // loadState replaces the current state; the attached risk engine and
+    // journal stay attached.
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+
+    // Length of the history (equity points, returns and fills) at some point of a run
+    struct HistoryMark {
+        size_t equityPoints = 0;
+        size_t returns = 0;
+        size_t fills = 0;
+    };
+
+    HistoryMark getHistoryMark() const { return HistoryMark{ equityCurve.size(), returns.size(), trades.size() }; }
+
+    // saveState without the equity curve, returns and fills: the state a fork
+    // continues this portfolio from, starting a history of its own (see
+    // BacktestingEngine::runSweep). loadBook replaces the current state.
+    void saveBook(SnapshotWriter& out) const;
+    void loadBook(SnapshotReader& in);
+
+    // Put the history a fork continues in front of its own: the first `mark`
+    // of each of `prefixes`, oldest first, where each portfolio was forked off
+    // the one before it at its mark
+    void prependHistory(const std::vector<std::pair<const Portfolio*, HistoryMark>>& prefixes);
 };
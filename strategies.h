@@ -1,10 +1,24 @@
 #pragma once
 #include "DataModule.h"
 #include "portfolio.h"
-#include <deque>
+#include <memory_resource>
 #include <numeric>
+#include <vector>
 #include <iostream>
 #include <stdexcept>
+#include <string>
+
+// Order a strategy places for a bar (see Strategy::decide)
+struct OrderIntent {
+    std::string symbol;
+    int quantity = 0;    // Shares, negative to sell; 0 for no order
+    double price = 0.0;
+
+    bool operator==(const OrderIntent& other) const {
+        return quantity == other.quantity && (quantity == 0 || (price == other.price && symbol == other.symbol));
+    }
+    bool operator!=(const OrderIntent& other) const { return !(*this == other); }
+};
 
 class Strategy {
 public:
@@ -14,82 +28,170 @@ public:
     virtual void onData(const std::string& timestamp, const TimeSeriesData& data) = 0;
     virtual void onStart() = 0;
     virtual void onEnd() = 0;
+
+    // State carried between bars, for checkpoints (see Checkpoint.h). The
+    // defaults throw std::logic_error, so a strategy that does not support
+    // checkpoints is never resumed with half its state.
+    virtual void saveState(SnapshotWriter&) const {
+        throw std::logic_error("This strategy does not support checkpoints.");
+    }
+    virtual void loadState(SnapshotReader&) {
+        throw std::logic_error("This strategy does not support checkpoints.");
+    }
+
+    // onData split in two, for prefix-sharing sweeps (see
+    // BacktestingEngine::runSweep): decide() folds the bar into the
+    // strategy's state and returns the order it would place, execute() places
+    // it, so onData(t, d) is execute(t, decide(t, d)). execute() must only act
+    // on the portfolio; a sweep calls it once for all variants that share a
+    // portfolio and agree on the order. The defaults throw std::logic_error.
+    virtual OrderIntent decide(const std::string&, const TimeSeriesData&) {
+        throw std::logic_error("This strategy does not support prefix sharing.");
+    }
+    virtual void execute(const std::string&, const OrderIntent&) {
+        throw std::logic_error("This strategy does not support prefix sharing.");
+    }
+
+    // Stream for the strategy's signal log (std::cout by default); null turns it off
+    void setLog(std::ostream* stream) { log = stream; }
+    std::ostream* getLog() const { return log; }
+
+protected:
+    std::ostream* log = &std::cout;
 };
 
 class MovingAverageStrategy : public Strategy {
 private:
-    std::deque<double> prices; // Stores recent closing prices
+    std::pmr::vector<double> prices; // Ring buffer of the last longWindow closing prices
+    size_t nextSlot = 0;       // Ring position the next price is written to
+    size_t priceCount = 0;     // Number of prices seen, capped at longWindow
     size_t shortWindow;        // Period for the short moving average
     size_t longWindow;         // Period for the long moving average
+    std::string symbol = "SPY"; // Instrument the signals trade
+    int quantity = 10;         // Shares per signal
     Portfolio& portfolio;      // Reference to the portfolio being managed
 
-    // Helper function to calculate the moving average
-    double calculateMovingAverage(const std::deque<double>& data, size_t windowSize) const {
-        return std::accumulate(data.end() - windowSize, data.end(), 0.0) / windowSize;
+    // Helper function to calculate the moving average of the most recent prices
+    double calculateMovingAverage(size_t windowSize) const {
+        // The newest windowSize prices end just before nextSlot and may wrap around
+        size_t start = (nextSlot + longWindow - windowSize) % longWindow;
+        if (start < nextSlot || nextSlot == 0) {
+            return std::accumulate(prices.begin() + start, prices.begin() + start + windowSize, 0.0) / windowSize;
+        }
+        double sum = std::accumulate(prices.begin() + start, prices.end(), 0.0);
+        return std::accumulate(prices.begin(), prices.begin() + nextSlot, sum) / windowSize;
     }
 
 public:
-    MovingAverageStrategy(size_t shortW, size_t longW, Portfolio& port)
-        : shortWindow(shortW), longWindow(longW), portfolio(port) {
+    // The price window is allocated once from `resource` (see RunArena)
+    MovingAverageStrategy(size_t shortW, size_t longW, Portfolio& port,
+                          std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : prices(resource), shortWindow(shortW), longWindow(longW), portfolio(port) {
         if (shortWindow <= 0 || longWindow <= 0 || shortWindow > longWindow) {
             throw std::invalid_argument("Invalid window sizes for moving averages");
         }
+        prices.resize(longWindow);
     }
 
+    // Instrument and shares traded on each signal (default 10 shares of SPY)
+    void setSymbol(const std::string& tradedSymbol) { symbol = tradedSymbol; }
+    void setQuantity(int shares) {
+        if (shares <= 0) throw std::invalid_argument("Quantity must be positive.");
+        quantity = shares;
+    }
+
+    const std::string& getSymbol() const { return symbol; }
+    int getQuantity() const { return quantity; }
+
     void onData(const std::string& timestamp, const TimeSeriesData& data) override {
-        prices.push_back(data.close);
+        execute(timestamp, decide(timestamp, data));
+    }
 
-        // Ensure the deque only keeps the required number of prices
-        if (prices.size() > longWindow) {
-            prices.pop_front();
+    OrderIntent decide(const std::string& timestamp, const TimeSeriesData& data) override {
+        // Overwrite the oldest price once the window is full
+        prices[nextSlot] = data.close;
+        nextSlot = (nextSlot + 1) % longWindow;
+        if (priceCount < longWindow) {
+            ++priceCount;
         }
 
         // Perform calculations only when we have enough data
-        if (prices.size() >= longWindow) {
-            double shortMA = calculateMovingAverage(prices, shortWindow);
-            double longMA = calculateMovingAverage(prices, longWindow);
+        if (priceCount >= longWindow) {
+            double shortMA = calculateMovingAverage(shortWindow);
+            double longMA = calculateMovingAverage(longWindow);
 
-            std::cout << timestamp << ": Short MA = " << shortMA << ", Long MA = " << longMA << std::endl;
+            if (log) *log << timestamp << ": Short MA = " << shortMA << ", Long MA = " << longMA << std::endl;
 
             // Generate buy or sell signals based on moving averages
             if (shortMA > longMA) {
-                executeBuySignal(timestamp, data.close);
+                return buySignal(timestamp, data.close);
             }
             else if (shortMA < longMA) {
-                executeSellSignal(timestamp, data.close);
+                return sellSignal(timestamp, data.close);
             }
         }
+        return OrderIntent();
+    }
+
+    void execute(const std::string& timestamp, const OrderIntent& order) override {
+        if (order.quantity == 0) return;
+        const bool buying = order.quantity > 0;
+        try {
+            if (buying) portfolio.buy(order.symbol, order.quantity, order.price);
+            else portfolio.sell(order.symbol, -order.quantity, order.price);
+            if (log) *log << timestamp << (buying ? ": Buy signal executed." : ": Sell signal executed.") << std::endl;
+        }
+        catch (const RiskViolation& e) {
+            if (log) *log << timestamp << (buying ? ": Buy signal blocked. " : ": Sell signal blocked. ") << e.what() << std::endl;
+        }
     }
 
     void onStart() override {
-        std::cout << "Starting backtest with Moving Average Strategy..." << std::endl;
+        if (log) *log << "Starting backtest with Moving Average Strategy..." << std::endl;
     }
 
     void onEnd() override {
-        std::cout << "Backtest complete." << std::endl;
+        if (log) *log << "Backtest complete." << std::endl;
         portfolio.printPortfolio();
     }
 
-private:
-    void executeBuySignal(const std::string& timestamp, double price) {
-        const int quantity = 10; // Number of shares to trade
-        if (portfolio.getCash() >= price * quantity) {
-            portfolio.buy("SPY", quantity, price);
-            std::cout << timestamp << ": Buy signal executed." << std::endl;
+    void saveState(SnapshotWriter& out) const override {
+        out.write<uint64_t>(shortWindow);
+        out.write<uint64_t>(longWindow);
+        out.write<uint64_t>(nextSlot);
+        out.write<uint64_t>(priceCount);
+        out.writeVector(prices);
+    }
+
+    // The windows must match the saved ones; the portfolio is restored separately
+    void loadState(SnapshotReader& in) override {
+        if (in.read<uint64_t>() != shortWindow || in.read<uint64_t>() != longWindow) {
+            throw std::runtime_error("Checkpoint was taken with different moving average windows.");
         }
-        else {
-            std::cout << timestamp << ": Buy signal skipped due to insufficient cash." << std::endl;
+        nextSlot = static_cast<size_t>(in.read<uint64_t>());
+        priceCount = static_cast<size_t>(in.read<uint64_t>());
+        in.readVector(prices);
+        if (prices.size() != longWindow || nextSlot >= longWindow || priceCount > longWindow) {
+            throw std::runtime_error("Corrupt strategy snapshot.");
         }
     }
 
-    void executeSellSignal(const std::string& timestamp, double price) {
-        const int quantity = 10; // Number of shares to trade
-        if (portfolio.getPosition("SPY") >= quantity) {
-            portfolio.sell("SPY", quantity, price);
-            std::cout << timestamp << ": Sell signal executed." << std::endl;
+private:
+    // Order for a buy signal, if there is the cash for it
+    OrderIntent buySignal(const std::string& timestamp, double price) const {
+        if (portfolio.getCash() >= portfolio.fillPrice(true, quantity, price) * quantity) {
+            return OrderIntent{ symbol, quantity, price };
         }
-        else {
-            std::cout << timestamp << ": Sell signal skipped due to insufficient shares." << std::endl;
+        if (log) *log << timestamp << ": Buy signal skipped due to insufficient cash." << std::endl;
+        return OrderIntent();
+    }
+
+    // Order for a sell signal, if there are the shares for it
+    OrderIntent sellSignal(const std::string& timestamp, double price) const {
+        if (portfolio.getPosition(symbol) >= quantity) {
+            return OrderIntent{ symbol, -quantity, price };
         }
+        if (log) *log << timestamp << ": Sell signal skipped due to insufficient shares." << std::endl;
+        return OrderIntent();
     }
 };
@@ -0,0 +1,81 @@
+#include "TestSupport.h"
+#include "BarSource.h"
+#include "DataModule.h"
+#include "SyntheticData.h"
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+using namespace Tests;
+
+namespace {
+
+// Hands out a few chunks of the test bars, then fails
+class FailingSource : public BarSource {
+public:
+    bool nextChunk(BarColumns& chunk) override {
+        if (served == 3) throw std::runtime_error("read failed");
+        chunk.clear();
+        const BarView bars(testBars(), served++ * 100, 100);
+        for (size_t i = 0; i < bars.size(); ++i) chunk.push_back(bars.timestamps[i], bars.at(i));
+        return true;
+    }
+
+private:
+    size_t served = 0;
+};
+
+void run(Portfolio& portfolio, const std::function<void(BacktestingEngine&, Strategy&, Portfolio&)>& body) {
+    portfolio.setLog(nullptr);
+    portfolio.setCash(100000.0);
+    MovingAverageStrategy strategy(5, 20, portfolio);
+    strategy.setLog(nullptr);
+    BacktestingEngine engine;
+    engine.setLog(nullptr);
+    body(engine, strategy, portfolio);
+}
+
+} // namespace
+
+// Streamed runs, with and without read-ahead, equal the in-memory run over the same bars
+BT_TEST(streaming) {
+    SyntheticDataConfig config;
+    config.barsPerSymbol = 30000;
+    config.model = PriceModel::RegimeSwitching;
+    config.threads = 1;
+    const std::string csv = SyntheticDataGenerator(config).writeCSV(scratchFile("stream-csv"), true).front();
+    DataModule dataModule;
+    expect(dataModule.loadTimeSeriesCSV(csv) && dataModule.size() == 30000, "the gzip CSV loads");
+    const std::string binary = scratchFile("stream.bin");
+    expect(dataModule.saveTimeSeriesBinary(binary, "SPY", BarCompression::Delta), "the binary file is written");
+
+    Portfolio memory, csvChunks, csvAhead, binaryAhead;
+    run(memory, [&](BacktestingEngine& engine, Strategy& strategy, Portfolio& portfolio) {
+        engine.runBacktest(dataModule.view(), strategy, portfolio);
+    });
+    run(csvChunks, [&](BacktestingEngine& engine, Strategy& strategy, Portfolio& portfolio) {
+        CSVStreamSource source(csv, 777);
+        engine.runBacktest(source, strategy, portfolio);
+    });
+    run(csvAhead, [&](BacktestingEngine& engine, Strategy& strategy, Portfolio& portfolio) {
+        ReadAheadSource source(std::make_unique<CSVStreamSource>(csv, 4096));
+        engine.runBacktest(source, strategy, portfolio);
+    });
+    run(binaryAhead, [&](BacktestingEngine& engine, Strategy& strategy, Portfolio& portfolio) {
+        ReadAheadSource source(std::make_unique<BinaryStreamSource>(binary));
+        expect(source.sizeHint() == 30000, "the binary source knows its size");
+        engine.runBacktest(source, strategy, portfolio);
+        expect(engine.getBarsProcessed() == 30000, "every bar is streamed");
+    });
+    expect(memory.getTrades().size() > 100, "the run trades");
+    expect(sameRun(memory, csvChunks), "small CSV chunks equal the in-memory run");
+    expect(sameRun(memory, csvAhead), "read-ahead CSV equals the in-memory run");
+    expect(sameRun(memory, binaryAhead), "read-ahead binary equals the in-memory run");
+
+    ReadAheadSource failing(std::make_unique<FailingSource>());
+    BarColumns chunk;
+    bool delivered = true;
+    for (int i = 0; i < 3; ++i) delivered = delivered && failing.nextChunk(chunk) && chunk.size() == 100;
+    expect(delivered, "chunks before the failure arrive");
+    expect(throws<std::runtime_error>([&]() { failing.nextChunk(chunk); }), "the source's error reaches the consumer");
+}
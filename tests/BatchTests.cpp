@@ -0,0 +1,127 @@
+#include "TestSupport.h"
+#include "BatchRunner.h"
+#include "DataModule.h"
+#include "TradeMatcher.h"
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Tests;
+
+namespace {
+
+class CollectingSink : public ResultSink {
+public:
+    void write(const RunResult& result) override { results.push_back(result); }
+    std::vector<RunResult> results;
+};
+
+BatchConfig loadConfig(const std::string& json) {
+    const std::string path = scratchFile("batch.json");
+    std::ofstream(path) << json;
+    return BatchConfig::load(path);
+}
+
+std::string jobJson(bool sharePrefix) {
+    return R"({
+        "portfolio": { "cash": 50000 },
+        "datasets": [ { "name": "test", "path": ")" + testCSV() + R"(", "symbol": "SPY" } ],
+        "strategies": [ { "type": "moving_average", "name": "ma",
+                          "parameters": { "shortWindow": [5, 10], "longWindow": { "from": 20, "to": 60, "step": 20 },
+                                          "quantity": 15 } } ],
+        "costModels": [ { "name": "free" }, { "name": "retail", "commissionPerShare": 0.005, "slippageBps": 1 } ],
+        "threads": 2,
+        "sharePrefix": )" + std::string(sharePrefix ? "true" : "false") + "\n}";
+}
+
+} // namespace
+
+// Parameters expand into their grid; invalid fields are named
+BT_TEST(batchConfig) {
+    const BatchConfig config = loadConfig(jobJson(false));
+    expect(config.cash == 50000.0 && config.threads == 2 && !config.sharePrefix, "job settings are read");
+    expect(config.datasets.size() == 1 && config.datasets[0].symbol == "SPY", "datasets are read");
+    expect(config.costModels.size() == 2 && config.costModels[1].model.commissionPerShare == 0.005
+        && config.costModels[1].model.slippageBps == 1.0, "cost models are read");
+    expect(config.strategies.size() == 1 && config.strategies[0].grid.size() == 6, "two short by three long windows");
+    expect(config.runCount() == 12, "every cell runs under every cost model");
+
+    bool complete = true;
+    for (double shortWindow : { 5.0, 10.0 }) {
+        for (double longWindow : { 20.0, 40.0, 60.0 }) {
+            bool found = false;
+            for (const ParameterSet& cell : config.strategies[0].grid) {
+                const ParameterSet resolved = BatchRunner::resolveParameters("moving_average", cell);
+                found = found || resolved == ParameterSet{ { "longWindow", longWindow }, { "quantity", 15.0 },
+                                                           { "shortWindow", shortWindow } };
+            }
+            complete = complete && found;
+        }
+    }
+    expect(complete, "the grid is the cartesian product of the parameters");
+
+    auto refused = [](const std::string& json) {
+        try {
+            loadConfig(json);
+        }
+        catch (const std::invalid_argument&) {
+            return true;
+        }
+        return false;
+    };
+    const std::string dataset = R"("datasets": [ { "name": "d", "path": "x.csv" } ])";
+    expect(refused(R"({ )" + dataset + R"( })"), "strategies are required");
+    expect(refused(R"({ )" + dataset + R"(, "strategies": [ { "type": "moving_average", "name": "ma",
+        "parameters": { "shortWindow": { "from": 5, "to": 10, "step": 0 } } } ] })"), "ranges need a positive step");
+    expect(refused(R"({ )" + dataset + R"(, "strategies": [ { "type": "moving_average", "name": "ma",
+        "parameters": { "shortWindow": [] } } ] })"), "empty lists are refused");
+    expect(throws<std::runtime_error>([]() { loadConfig("{ not json"); }), "malformed JSON is refused");
+    expect(throws<std::invalid_argument>([]() {
+        BatchRunner::makeStrategyFactory("moving_average", { { "shortWindow", 20 }, { "longWindow", 5 } }, "SPY");
+    }), "a short window above the long window is refused");
+    expect(throws<std::invalid_argument>([]() { BatchRunner::makeStrategyFactory("momentum", {}, "SPY"); }),
+        "unknown strategy types are refused");
+}
+
+// Every batch result equals a direct run of the same cell, with and without prefix sharing
+BT_TEST(batchRunner) {
+    DataModule dataModule;
+    expect(dataModule.loadTimeSeriesCSV(testCSV()), "the test bars load");
+    const BatchConfig config = loadConfig(jobJson(false));
+
+    for (bool sharePrefix : { false, true }) {
+        BatchConfig job = config;
+        job.sharePrefix = sharePrefix;
+        CollectingSink sink;
+        BatchRunner runner(job);
+        expect(runner.run({ &sink }) == 0, "no run fails");
+        expect(sink.results.size() == 12, "one result per run");
+
+        bool inOrder = true, matches = true;
+        for (size_t i = 0; i < sink.results.size(); ++i) {
+            const RunResult& result = sink.results[i];
+            inOrder = inOrder && result.costModel == (i < 6 ? "free" : "retail") && result.strategy == "ma";
+            const CostModel& costs = config.costModels[i < 6 ? 0 : 1].model;
+
+            Portfolio portfolio;
+            portfolio.setLog(nullptr);
+            portfolio.setCash(50000.0);
+            portfolio.setCostModel(costs);
+            std::unique_ptr<Strategy> strategy =
+                BatchRunner::makeStrategyFactory("moving_average", result.parameters, "SPY")(portfolio);
+            strategy->setLog(nullptr);
+            BacktestingEngine engine("SPY");
+            engine.setLog(nullptr);
+            engine.runBacktest(dataModule, *strategy, portfolio);
+            const MetricSummary metrics = Metrics::summarize(portfolio.getEquityCurve(), portfolio.getReturns(),
+                RoundTripMatcher::match(portfolio.getTrades()));
+            matches = matches && result.ok() && result.finalEquity == portfolio.getEquity()
+                && result.fills == portfolio.getTrades().size() && result.fills > 0
+                && result.metrics.totalReturn == metrics.totalReturn && result.metrics.sharpeRatio == metrics.sharpeRatio
+                && result.metrics.maxDrawdown == metrics.maxDrawdown && result.metrics.trades.trades == metrics.trades.trades;
+        }
+        expect(inOrder, "results arrive in job order");
+        expect(matches, sharePrefix ? "shared-prefix results equal direct runs" : "batch results equal direct runs");
+    }
+}
@@ -0,0 +1,59 @@
+#include "TestSupport.h"
+
+using namespace Tests;
+
+// A run resumed from a checkpoint ends bit-identical to an uninterrupted one,
+// and checkpoints of equal states are byte-identical
+BT_TEST(resume) {
+    const BarView all(testBars());
+    for (bool fixedPoint : { false, true }) {
+        RiskEngine riskA(testLimits());
+        Portfolio a;
+        configure(a, fixedPoint);
+        a.setRiskEngine(&riskA);
+        MovingAverageStrategy strategyA(5, 20, a);
+        strategyA.setLog(nullptr);
+        BacktestingEngine engineA;
+        engineA.setLog(nullptr);
+        engineA.runBacktest(all, strategyA, a);
+
+        // Interrupted after 14000 bars, with a checkpoint every 5000
+        const std::string path = scratchFile("resume.ckpt");
+        {
+            RiskEngine risk(testLimits());
+            Portfolio portfolio;
+            configure(portfolio, fixedPoint);
+            portfolio.setRiskEngine(&risk);
+            MovingAverageStrategy strategy(5, 20, portfolio);
+            strategy.setLog(nullptr);
+            BacktestingEngine engine;
+            engine.setLog(nullptr);
+            engine.setCheckpointing(path, 5000);
+            engine.runBacktest(all.subview(0, 14000), strategy, portfolio);
+        }
+
+        RiskEngine riskB(testLimits());
+        Portfolio b;
+        b.setLog(nullptr);
+        b.setRiskEngine(&riskB);
+        MovingAverageStrategy strategyB(5, 20, b);
+        strategyB.setLog(nullptr);
+        BacktestingEngine engineB;
+        engineB.setLog(nullptr);
+        engineB.resume(path, strategyB, b);
+        expect(Checkpoint::load(path).getBarsProcessed() == 10000, "checkpoint taken at bar 10000");
+        engineB.runBacktest(all, strategyB, b);
+
+        const std::string mode = fixedPoint ? " (fixed point)" : "";
+        expect(a.getTrades().size() > 100, "the run trades" + mode);
+        expect(sameRun(a, b), "resumed run matches the uninterrupted one" + mode);
+        expect(riskA.getAccepted() == riskB.getAccepted()
+               && riskA.getRejected(RiskCheck::OrderRate) == riskB.getRejected(RiskCheck::OrderRate),
+               "risk counters match" + mode);
+
+        const std::string pathA = scratchFile("a.ckpt"), pathB = scratchFile("b.ckpt");
+        Checkpoint::capture(all.size(), all.timestamps[all.size() - 1], strategyA, a).save(pathA);
+        Checkpoint::capture(all.size(), all.timestamps[all.size() - 1], strategyB, b).save(pathB);
+        expect(readFile(pathA) == readFile(pathB), "checkpoints of equal states are byte-identical" + mode);
+    }
+}
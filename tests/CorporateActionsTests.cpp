@@ -0,0 +1,105 @@
+#include "TestSupport.h"
+#include "CorporateActions.h"
+#include "DataModule.h"
+#include <cmath>
+#include <fstream>
+#include <functional>
+
+using namespace Tests;
+
+namespace {
+
+// Close of the last bar before `timestamp`
+double closeBefore(const BarColumns& bars, int64_t timestamp) {
+    size_t i = 0;
+    while (i < bars.size() && bars.timestamps[i] < timestamp) ++i;
+    return bars.close[i - 1];
+}
+
+bool near(double a, double b) {
+    return std::fabs(a - b) <= 1e-12 * std::fabs(b);
+}
+
+} // namespace
+
+// Back-adjusted views scale every bar by the actions after it, over the raw storage
+BT_TEST(corporateActions) {
+    DataModule dataModule;
+    expect(dataModule.loadTimeSeriesCSV(testCSV()), "the test bars load");
+    const BarColumns raw = dataModule.getBars();
+    const int64_t firstDay = dataModule.dayNumber(0) * 86400;
+    const int64_t early = firstDay + 5 * 86400, split = firstDay + 12 * 86400, late = firstDay + 26 * 86400;
+
+    CorporateActions actions;
+    actions.addDividend(late, 0.75);
+    actions.addSplit(split, 2.0);
+    actions.addDividend(early, 0.4);
+    expect(actions.getActions().size() == 3 && actions.getActions().front().exDate == early, "actions sort by ex-date");
+    dataModule.setCorporateActions(actions);
+
+    const double earlyFactor = 1.0 - 0.4 / closeBefore(raw, early);
+    const double lateFactor = 1.0 - 0.75 / closeBefore(raw, late);
+    const std::vector<BarView> segments = dataModule.adjusted();
+    expect(segments.size() == 4, "one segment per run of bars sharing a factor");
+    expect(segments.front().timestamps == dataModule.getBars().timestamps.data(), "segments view the raw storage");
+
+    BarColumns adjusted;
+    CorporateActions::materialize(segments, adjusted);
+    bool matches = adjusted.size() == raw.size();
+    for (size_t i = 0; matches && i < raw.size(); ++i) {
+        const int64_t t = raw.timestamps[i];
+        double price = 1.0, volume = 1.0;
+        if (t < late) price *= lateFactor;
+        if (t < split) price *= 0.5, volume *= 2.0;
+        if (t < early) price *= earlyFactor;
+        matches = adjusted.timestamps[i] == t && near(adjusted.open[i], raw.open[i] * price)
+            && near(adjusted.high[i], raw.high[i] * price) && near(adjusted.low[i], raw.low[i] * price)
+            && near(adjusted.close[i], raw.close[i] * price)
+            && adjusted.volume[i] == std::llround(static_cast<double>(raw.volume[i]) * volume);
+    }
+    expect(matches, "adjusted bars equal the raw bars times the later actions' factors");
+    expect(sameBars(dataModule.getBars(), raw), "raw bars are left as loaded");
+    expect(adjusted.close.back() == raw.close.back(), "bars after the last action keep their prices");
+
+    // The engine's run over the data module is the run over the adjusted columns
+    auto run = [](const std::function<void(BacktestingEngine&, Strategy&, Portfolio&)>& body, Portfolio& portfolio) {
+        portfolio.setLog(nullptr);
+        portfolio.setCash(100000.0);
+        MovingAverageStrategy strategy(5, 20, portfolio);
+        strategy.setLog(nullptr);
+        BacktestingEngine engine;
+        engine.setLog(nullptr);
+        body(engine, strategy, portfolio);
+    };
+    Portfolio viaModule, viaColumns;
+    run([&](BacktestingEngine& engine, Strategy& strategy, Portfolio& portfolio) {
+        engine.runBacktest(dataModule, strategy, portfolio);
+    }, viaModule);
+    run([&](BacktestingEngine& engine, Strategy& strategy, Portfolio& portfolio) {
+        engine.runBacktest(BarView(adjusted), strategy, portfolio);
+    }, viaColumns);
+    expect(sameRun(viaModule, viaColumns), "runs over adjusted views equal runs over adjusted columns");
+
+    CorporateActions tooLarge;
+    tooLarge.addDividend(late, closeBefore(raw, late) * 2.0);
+    expect(throws<std::invalid_argument>([&]() { dataModule.setCorporateActions(tooLarge); }),
+        "a dividend above the close is refused");
+}
+
+// The per-symbol table parses splits (plain and new:old) and dividends
+BT_TEST(corporateActionTable) {
+    const std::string path = scratchFile("actions.csv");
+    std::ofstream(path) << "symbol,date,type,value\nAAPL,2020-08-31,split,4\nSPY,2024-03-15,Dividend,1.5953\n"
+                           "AAPL,2014-06-09,split,7:1\nBRK,2021-01-04,split,3:2\n";
+    const CorporateActionTable table = CorporateActionTable::loadCSV(path);
+    expect(table.symbolCount() == 3, "one entry per symbol");
+    const auto& apple = table.forSymbol("AAPL").getActions();
+    expect(apple.size() == 2 && apple[0].value == 7.0 && apple[1].value == 4.0, "splits sort by ex-date");
+    expect(table.forSymbol("BRK").getActions()[0].value == 1.5, "new:old ratios are divided out");
+    const auto& spy = table.forSymbol("SPY").getActions();
+    expect(spy.size() == 1 && spy[0].type == CorporateActionType::Dividend && spy[0].value == 1.5953, "dividends");
+    expect(table.forSymbol("MSFT").empty(), "unknown symbols have no actions");
+
+    std::ofstream(path) << "SPY,2024-03-15,merger,1\n";
+    expect(throws<std::runtime_error>([&]() { CorporateActionTable::loadCSV(path); }), "unknown types are refused");
+}
@@ -0,0 +1,53 @@
+#include "TestSupport.h"
+#include "DataModule.h"
+#include "SyntheticData.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace Tests;
+
+// A directory of interleaved per-day files loads in parallel into the same bars as one serial load
+BT_TEST(directoryLoad) {
+    SyntheticDataConfig config;
+    config.barsPerSymbol = 20000;
+    config.threads = 1;
+    const std::string whole = SyntheticDataGenerator(config).writeCSV(scratchFile("loader-whole")).front();
+
+    // Deal the days out to four files, so every file spans the whole period
+    const std::string directory = scratchFile("loader-parts");
+    std::filesystem::create_directories(directory);
+    std::ofstream parts[4];
+    for (int i = 0; i < 4; ++i) parts[i].open(directory + "/part-" + std::to_string(i) + ".csv");
+    std::istringstream text(readFile(whole));
+    std::string line, header, day;
+    std::getline(text, header);
+    for (auto& part : parts) part << header << '\n';
+    int dayIndex = -1;
+    while (std::getline(text, line)) {
+        if (line.compare(0, 10, day) != 0) {
+            day = line.substr(0, 10);
+            ++dayIndex;
+        }
+        parts[dayIndex % 4] << line << '\n';
+    }
+    for (auto& part : parts) part.close();
+    std::ofstream(directory + "/part-4.csv") << header << "\nnot a bar\n";
+    std::ofstream(directory + "/notes.txt") << "skipped by the pattern\n";
+
+    DataModule serial, parallel;
+    expect(serial.loadTimeSeriesCSV(whole) && serial.size() == 20000, "the single file loads");
+    const std::vector<FileLoadResult> results = parallel.loadDirectoryCSV(directory, "part-*.csv", 4);
+    expect(results.size() == 5, "one result per matching file");
+    bool partsLoaded = true;
+    size_t rows = 0;
+    for (size_t i = 0; i < 4 && i < results.size(); ++i) {
+        partsLoaded = partsLoaded && results[i].ok() && results[i].rows > 0;
+        rows += results[i].rows;
+    }
+    expect(partsLoaded && rows == 20000, "the day files load without errors");
+    expect(results.size() == 5 && !results[4].ok() && results[4].malformedRows == 1 && results[4].rows == 0,
+        "the bad file reports its malformed row");
+    expect(sameBars(parallel.getBars(), serial.getBars()), "the merged series equals the serial load");
+    expect(parallel.dayCount() == serial.dayCount(), "the day index covers the merged series");
+}
@@ -0,0 +1,79 @@
+#include "TestSupport.h"
+#include "DataModule.h"
+#include "TimeUtils.h"
+
+using namespace Tests;
+
+namespace {
+
+// Whether `view` is exactly bars [first, first + count) of the module's storage
+bool isSlice(const BarView& view, const BarColumns& bars, size_t first, size_t count) {
+    return view.size() == count && (count == 0 || view.timestamps == bars.timestamps.data() + first);
+}
+
+// First bar at or after `timestamp`, by a linear scan
+size_t firstAtOrAfter(const BarColumns& bars, int64_t timestamp) {
+    size_t i = 0;
+    while (i < bars.size() && bars.timestamps[i] < timestamp) ++i;
+    return i;
+}
+
+} // namespace
+
+// Range, day, session and walk-forward queries return views of the stored bars matching a linear scan
+BT_TEST(rangeQueries) {
+    DataModule dataModule;
+    expect(dataModule.loadTimeSeriesCSV(testCSV()), "the test bars load");
+    const BarColumns& bars = dataModule.getBars();
+    const int64_t day = 86400;
+    const int64_t first = TimeUtils::daysFromCivil(2000, 1, 4) * day;
+
+    const size_t begin = firstAtOrAfter(bars, first + 600 * 60), end = firstAtOrAfter(bars, first + 2 * day);
+    expect(isSlice(dataModule.range(first + 600 * 60, first + 2 * day), bars, begin, end - begin),
+        "a timestamp range is a zero-copy slice");
+    const size_t dayTwo = firstAtOrAfter(bars, first), dayFour = firstAtOrAfter(bars, first + 2 * day);
+    expect(isSlice(dataModule.range("2000-01-04", "2000-01-06"), bars, dayTwo, dayFour - dayTwo),
+        "text bounds give the same range");
+    expect(dataModule.range(first + day, first).empty(), "an inverted range is empty");
+    expect(throws<std::invalid_argument>([&]() { dataModule.range("2000-13-45", "2000-01-06"); }),
+        "unparseable bounds are refused");
+
+    // Day table
+    size_t days = 0;
+    for (size_t i = 0; i < bars.size(); ++i) {
+        if (i == 0 || TimeUtils::dayOf(bars.timestamps[i]) != TimeUtils::dayOf(bars.timestamps[i - 1])) ++days;
+    }
+    expect(dataModule.dayCount() == days && days > 20, "one entry per day with bars");
+    expect(dataModule.dayNumber(1) == TimeUtils::daysFromCivil(2000, 1, 4), "days are numbered from the epoch");
+    expect(isSlice(dataModule.days(1, 2), bars, dayTwo, dayFour - dayTwo), "whole days come from the day table");
+
+    // 10:00 to 12:00 on every day of the range
+    const std::vector<BarView> sessions = dataModule.sessions(first, first + 10 * day, SessionWindow{ 600, 720 });
+    size_t expected = 0, seen = 0;
+    bool inWindow = true;
+    for (size_t i = 0; i < bars.size(); ++i) {
+        const int64_t minute = bars.timestamps[i] % day / 60;
+        if (bars.timestamps[i] >= first && bars.timestamps[i] < first + 10 * day && minute >= 600 && minute < 720) {
+            ++expected;
+        }
+    }
+    for (const BarView& session : sessions) {
+        for (size_t i = 0; i < session.size(); ++i) {
+            const int64_t minute = session.timestamps[i] % day / 60;
+            inWindow = inWindow && minute >= 600 && minute < 720
+                && TimeUtils::dayOf(session.timestamps[i]) == TimeUtils::dayOf(session.timestamps[0]);
+        }
+        seen += session.size();
+    }
+    expect(!sessions.empty() && seen == expected && inWindow, "session views hold exactly the window's bars");
+
+    // Five days of training, then two of testing, stepping by two
+    const std::vector<WalkForwardSplit> folds = dataModule.walkForward(5, 2);
+    bool foldsMatch = folds.size() == (days - 5) / 2;
+    for (size_t k = 0; foldsMatch && k < folds.size(); ++k) {
+        const BarView train = dataModule.days(2 * k, 5), test = dataModule.days(2 * k + 5, 2);
+        foldsMatch = folds[k].train.timestamps == train.timestamps && folds[k].train.size() == train.size()
+            && folds[k].test.timestamps == test.timestamps && folds[k].test.size() == test.size();
+    }
+    expect(foldsMatch, "walk-forward folds tile the days");
+}
@@ -0,0 +1,103 @@
+#include "TestSupport.h"
+#include "DataModule.h"
+#include "DataValidator.h"
+#include "TimeUtils.h"
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+using namespace Tests;
+
+namespace {
+
+// Copy of `bars` without rows [first, first + count)
+BarColumns without(const BarColumns& bars, size_t first, size_t count) {
+    BarColumns out;
+    for (size_t i = 0; i < bars.size(); ++i) {
+        if (i < first || i >= first + count) out.push_back(bars.timestamps[i], bars.at(i));
+    }
+    return out;
+}
+
+} // namespace
+
+// The vectorized counts match row-by-row counts, on odd and even rows alike
+BT_TEST(validatorCounts) {
+    BarColumns bars = testBars();
+    bars.high[11] = bars.low[11] - 0.5;                                 // high below low
+    bars.open[20] = bars.high[20] + 0.5;                                // open above high
+    bars.close[1001] = -bars.close[1001];                               // negative close (also an outlier)
+    bars.low[2002] = std::numeric_limits<double>::quiet_NaN();          // NaN low
+    bars.volume[3003] = -5;
+    bars.volume[3004] = -6;
+    bars.close[4000] = bars.high[4000] = bars.close[3999] * 1.5;        // a jump up, and back down on the next bar
+    bars.close[bars.size() - 1] = bars.high[bars.size() - 1] * 2.0;     // last row, on the scalar tail
+
+    size_t invalid = 0, inconsistent = 0, outliers = 0, negative = 0;
+    for (size_t i = 0; i < bars.size(); ++i) {
+        const double o = bars.open[i], h = bars.high[i], l = bars.low[i], c = bars.close[i];
+        invalid += !(o > 0 && h > 0 && l > 0 && c > 0);
+        inconsistent += h < l || o > h || o < l || c > h || c < l;
+        outliers += i > 0 && std::fabs(c - bars.close[i - 1]) > 0.25 * bars.close[i - 1];
+        negative += bars.volume[i] < 0;
+    }
+
+    ValidationReport report;
+    DataValidator().checkBars(BarView(bars), report);
+    expect(report.bars == bars.size() && report.barSeconds == 60, "every bar is checked at the inferred spacing");
+    expect(report.invalidPrices == invalid && invalid == 2, "non-positive and NaN prices");
+    expect(report.inconsistentOHLC == inconsistent && inconsistent >= 3, "OHLC outside [low, high]");
+    expect(report.outliers == outliers && outliers >= 5, "close-to-close moves above the limit");
+    expect(report.negativeVolumes == negative && negative == 2, "negative volumes");
+    expect(!report.clean() && report.examples.size() == 5, "a dirty series keeps a few examples");
+}
+
+// Intraday gaps are counted, and forward-filling closes them with flat bars
+BT_TEST(validatorGaps) {
+    const BarColumns& bars = testBars();
+    BarColumns gappy = without(without(bars, 200, 1), 100, 5);
+    expect(TimeUtils::dayOf(bars.timestamps[99]) == TimeUtils::dayOf(bars.timestamps[200]), "the gaps are intraday");
+
+    ValidationReport report;
+    const DataValidator validator;
+    validator.checkBars(BarView(gappy), report);
+    expect(report.gaps == 2 && report.missingBars == 6, "two gaps, six missing bars");
+    expect(!report.clean(), "unfilled gaps are reported");
+
+    const size_t filled = validator.forwardFill(gappy, report);
+    expect(filled == 6 && report.filledBars == 6 && report.clean(), "filled gaps leave the report clean");
+    expect(sameSeries(gappy.timestamps, bars.timestamps), "the filled series has every minute back");
+    expect(gappy.open[102] == bars.close[99] && gappy.high[102] == bars.close[99] && gappy.close[104] == bars.close[99]
+        && gappy.volume[100] == 0, "filled bars carry the previous close with no volume");
+
+    ValidationReport again;
+    validator.checkBars(BarView(gappy), again);
+    expect(again.gaps == 0 && again.clean(), "no gaps remain");
+}
+
+// A load summarizes malformed, out-of-order and duplicate rows in one report
+BT_TEST(validatorLoad) {
+    const std::string path = scratchFile("dirty.csv");
+    std::ofstream(path) << "date,open,high,low,close,volume\n"
+                           "2024-01-02 09:30:00,10,11,9,10.5,100\n"
+                           "2024-01-02 09:32:00,10.5,11,10,10.8,100\n"
+                           "2024-01-02 09:31:00,10.4,10.9,10.2,10.6,100\n"
+                           "2024-01-02 09:32:00,10.5,11,10,10.9,150\n"
+                           "2024-01-02 09:33:00,oops,11,10,10.9,150\n"
+                           "2024-01-02 09:36:00,10.9,11,10.8,11,120\n";
+
+    DataModule plain;
+    expect(plain.loadTimeSeriesCSV(path) && plain.size() == 4, "bad rows are dropped and duplicates merged");
+    const ValidationReport& report = plain.getValidationReport();
+    expect(report.malformedRows == 1 && report.nonMonotonic == 1 && report.duplicates == 1, "row issues are counted");
+    expect(report.gaps == 1 && report.missingBars == 3, "the gap after 09:32 is counted");
+    expect(plain.getBars().close[2] == 10.9 && plain.getBars().volume[2] == 150, "the later duplicate wins");
+
+    ValidationOptions options;
+    options.forwardFill = true;
+    options.barSeconds = 60;
+    DataModule filled;
+    filled.setValidationOptions(options);
+    expect(filled.loadTimeSeriesCSV(path) && filled.size() == 7, "forward-filling restores the missing minutes");
+    expect(filled.getValidationReport().filledBars == 3 && filled.getBars().close[4] == 10.9, "filled at the last close");
+}
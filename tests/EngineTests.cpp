@@ -0,0 +1,37 @@
+#include "TestSupport.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Tests;
+
+// The equity curve marks the open position at each bar's close
+BT_TEST(marking) {
+    const BarColumns& bars = testBars();
+    Portfolio portfolio;
+    portfolio.setLog(nullptr);
+    portfolio.setCash(100000.0);
+    MovingAverageStrategy strategy(5, 20, portfolio);
+    strategy.setLog(nullptr);
+    BacktestingEngine engine;
+    engine.setLog(nullptr);
+    engine.runBacktest(BarView(bars), strategy, portfolio);
+
+    const TradeLedger& trades = portfolio.getTrades();
+    const auto& equity = portfolio.getEquityCurve();
+    expect(trades.size() > 100, "the run trades");
+    expect(equity.size() == bars.size(), "one equity point per bar");
+
+    // Replay the fills bar by bar
+    double cash = 100000.0, worst = 0.0;
+    int shares = 0;
+    size_t next = 0;
+    for (size_t i = 0; i < bars.size() && i < equity.size(); ++i) {
+        for (; next < trades.size() && trades[next].timestamp == bars.timestamps[i]; ++next) {
+            shares += trades[next].side == TradeSide::Buy ? trades[next].quantity : -trades[next].quantity;
+            cash = trades[next].cashAfter;
+        }
+        worst = std::max(worst, std::fabs(equity[i] - (cash + shares * bars.close[i])));
+    }
+    expect(next == trades.size(), "every fill falls on a bar");
+    expect(worst < 1e-6, "net worth is cash plus the position at the close");
+}
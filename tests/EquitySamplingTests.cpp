@@ -0,0 +1,58 @@
+#include "TestSupport.h"
+#include "TimeUtils.h"
+#include <vector>
+
+using namespace Tests;
+
+namespace {
+
+void run(Portfolio& portfolio, EquitySampling sampling, size_t interval) {
+    portfolio.setLog(nullptr);
+    portfolio.setCash(100000.0);
+    portfolio.setEquitySampling(sampling, interval);
+    MovingAverageStrategy strategy(5, 20, portfolio);
+    strategy.setLog(nullptr);
+    BacktestingEngine engine;
+    engine.setLog(nullptr);
+    engine.runBacktest(BarView(testBars()), strategy, portfolio);
+}
+
+// Returns between consecutive kept points, as the portfolio computes them
+std::vector<double> returnsOf(const std::vector<double>& points) {
+    std::vector<double> out;
+    for (size_t i = 1; i < points.size(); ++i) out.push_back((points[i] - points[i - 1]) / points[i - 1]);
+    return out;
+}
+
+} // namespace
+
+// Sampled curves keep exactly the chosen points of the full curve, in pre-sized buffers
+BT_TEST(equitySampling) {
+    const BarColumns& bars = testBars();
+    Portfolio full, everyNth, sessions;
+    run(full, EquitySampling::Full, 1);
+    run(everyNth, EquitySampling::EveryNth, 7);
+    run(sessions, EquitySampling::SessionClose, 1);
+    const auto& curve = full.getEquityCurve();
+    expect(curve.size() == bars.size(), "the full curve has a point per bar");
+    expect(curve.capacity() == bars.size(), "the full curve never reallocates");
+
+    std::vector<double> nth;
+    for (size_t i = 0; i < curve.size(); i += 7) nth.push_back(curve[i]);
+    if ((curve.size() - 1) % 7 != 0) nth.push_back(curve.back());
+    expect(sameSeries(everyNth.getEquityCurve(), nth), "every 7th point, then the final one");
+    expect(sameSeries(everyNth.getReturns(), returnsOf(nth)), "returns run between kept points");
+    expect(everyNth.getEquityCurve().capacity() == bars.size() / 7 + 2, "the sampled curve is sized up front");
+
+    std::vector<double> closes;
+    for (size_t i = 0; i < bars.size(); ++i) {
+        if (i + 1 == bars.size() || TimeUtils::dayOf(bars.timestamps[i]) != TimeUtils::dayOf(bars.timestamps[i + 1])) {
+            closes.push_back(curve[i]);
+        }
+    }
+    expect(closes.size() > 20, "the bars span many sessions");
+    expect(sameSeries(sessions.getEquityCurve(), closes), "one point per session close");
+    expect(sameSeries(sessions.getReturns(), returnsOf(closes)), "returns run from close to close");
+    expect(sameTrades(sessions.getTrades(), full.getTrades()) && sessions.getCash() == full.getCash(),
+        "sampling does not change the trading");
+}
@@ -0,0 +1,94 @@
+#include "TestSupport.h"
+#include "BarSource.h"
+#include "FixedPoint.h"
+
+using namespace Tests;
+
+// Tick arithmetic is exact, and a fixed-point run's cash is the exact sum of its fills
+BT_TEST(fixedPoint) {
+    const FixedPoint::TickSize cent(0.01), eighth(0.125);
+    expect(cent.toTicks(472.53) == 47253 && cent.toPrice(47253) == 472.53, "prices round-trip through ticks");
+    expect(cent.value(47253, 3) == 1417590000, "a fill's value is ticks times tick micros");
+    expect(eighth.toTicks(10.3) == 82 && eighth.toPrice(82) == 10.25, "prices round to the nearest tick");
+    expect(throws<std::invalid_argument>([]() { FixedPoint::TickSize(0.0000005); }), "sub-micro ticks are refused");
+    expect(throws<std::invalid_argument>([]() { FixedPoint::TickSize(0.0); }), "zero ticks are refused");
+
+    const BarColumns& bars = testBars();
+    Portfolio portfolio;
+    portfolio.setLog(nullptr);
+    portfolio.setCash(100000.0);
+    portfolio.setFixedPoint(true);
+    MovingAverageStrategy strategy(5, 20, portfolio);
+    strategy.setLog(nullptr);
+    BacktestingEngine engine;
+    engine.setLog(nullptr);
+    engine.runBacktest(BarView(bars), strategy, portfolio);
+
+    // Replay the fills in micro-units
+    FixedPoint::Money cash = FixedPoint::toMoney(100000.0);
+    bool exactAfter = true;
+    const TradeLedger& trades = portfolio.getTrades();
+    for (size_t i = 0; i < trades.size(); ++i) {
+        const FixedPoint::Money value = cent.value(cent.toTicks(trades[i].price), trades[i].quantity);
+        cash += trades[i].side == TradeSide::Buy ? -value : value;
+        exactAfter = exactAfter && FixedPoint::toDouble(cash) == trades[i].cashAfter;
+    }
+    expect(trades.size() > 100, "the run trades");
+    expect(exactAfter, "each fill's cash is the exact running sum");
+    expect(FixedPoint::toDouble(cash) == portfolio.getCash(), "final cash is the exact sum of the fills");
+}
+
+// TickBars holds the prices as int32 ticks when they fit and expands them back exactly
+BT_TEST(tickBars) {
+    const BarColumns& bars = testBars();
+    const FixedPoint::TickSize cent(0.01);
+    const TickBars ticks(BarView(bars), cent);
+    expect(ticks.size() == bars.size() && ticks.isCompact(), "the series is stored compact");
+    expect(ticks.priceBytes() == 4 * bars.size() * sizeof(int32_t), "compact prices take half of double columns");
+
+    bool rounded = true;
+    const BarColumns expanded = ticks.toColumns();
+    for (size_t i = 0; i < bars.size(); ++i) {
+        rounded = rounded && expanded.timestamps[i] == bars.timestamps[i]
+            && expanded.close[i] == cent.toPrice(cent.toTicks(bars.close[i]))
+            && expanded.low[i] == cent.toPrice(cent.toTicks(bars.low[i]))
+            && ticks.at(i).close == cent.toTicks(bars.close[i]);
+    }
+    expect(rounded, "every price expands to its nearest tick");
+
+    // Prices beyond 21.4M units at a cent tick need int64 columns
+    BarColumns large;
+    large.push_back(bars.timestamps[0], TimeSeriesData{ 3.0e7, 3.1e7, 2.9e7, 3.05e7, 100 });
+    large.push_back(bars.timestamps[1], TimeSeriesData{ 3.05e7, 3.2e7, 3.0e7, 3.15e7, 200 });
+    const TickBars wide(BarView(large), cent);
+    expect(!wide.isCompact() && wide.priceBytes() == 4 * 2 * sizeof(int64_t), "large prices are stored wide");
+    expect(wide.bar(1).close == 3.15e7 && wide.at(1).volume == 200, "wide bars expand exactly");
+}
+
+// A run over TickBars equals a run over the expanded columns, whatever the chunk size
+BT_TEST(tickRun) {
+    const TickBars ticks(BarView(testBars()), FixedPoint::TickSize(0.01));
+    const BarColumns expanded = ticks.toColumns();
+
+    auto run = [&](int mode, Portfolio& portfolio) {
+        configure(portfolio, true);
+        MovingAverageStrategy strategy(5, 20, portfolio);
+        strategy.setLog(nullptr);
+        BacktestingEngine engine;
+        engine.setLog(nullptr);
+        if (mode == 0) engine.runBacktest(BarView(expanded), strategy, portfolio);
+        else if (mode == 1) engine.runBacktest(ticks, strategy, portfolio);
+        else {
+            TickBarSource source(ticks, 1000);
+            engine.runBacktest(source, strategy, portfolio);
+        }
+    };
+    Portfolio columns, whole, chunked;
+    run(0, columns);
+    run(1, whole);
+    run(2, chunked);
+    expect(columns.getTrades().size() > 100, "the run trades");
+    expect(sameRun(columns, whole), "the TickBars run equals the column run");
+    expect(sameRun(columns, chunked), "chunk boundaries do not change the run");
+    expect(throws<std::invalid_argument>([&]() { TickBarSource(ticks, 0); }), "empty chunks are refused");
+}
@@ -0,0 +1,65 @@
+#include "TestSupport.h"
+#include "FxRates.h"
+#include <cmath>
+#include <stdexcept>
+
+using namespace Tests;
+
+namespace {
+
+bool near(double a, double b) {
+    return std::fabs(a - b) <= 1e-9 * std::max(1.0, std::fabs(b));
+}
+
+} // namespace
+
+// FX bars set the non-base leg's rate, and conversions go through the base currency
+BT_TEST(fxRates) {
+    FxRateTable table("USD");
+    const uint16_t eur = table.intern("EUR"), jpy = table.intern("JPY");
+    expect(table.intern("EUR") == eur && table.find("GBP") == -1 && !table.hasRate(eur), "currencies are interned");
+    expect(table.onBar("EURUSD", 1.10) == eur && table.rate(eur) == 1.10, "EURUSD quotes dollars per euro");
+    expect(table.onBar("USD/JPY", 150.0) == jpy && near(table.rate(jpy), 1.0 / 150.0), "USD/JPY is inverted");
+    expect(table.onBar("EUR-JPY", 165.0) == -1 && table.rate(eur) == 1.10, "crosses without the base are ignored");
+    expect(near(table.convert(100.0, eur, jpy), 16500.0) && near(table.convert(16500.0, jpy, eur), 100.0),
+        "conversions between two foreign currencies");
+    expect(throws<std::invalid_argument>([&]() { table.onBar("EURUS", 1.1); }), "malformed pairs are refused");
+    expect(throws<std::invalid_argument>([&]() { table.setRate(0, 2.0); }), "the base rate is fixed at 1");
+}
+
+// Foreign fills settle in their currency and are valued at the latest rate
+BT_TEST(fxConversion) {
+    Portfolio portfolio;
+    portfolio.setLog(nullptr);
+    portfolio.setCash(50000.0);
+    portfolio.setInstrumentCurrency("SAP", "EUR");
+    portfolio.setCash("EUR", 10000.0);
+    expect(throws<std::runtime_error>([&]() { portfolio.buy("SAP", 10, 100.0); }), "no trading before the rate is known");
+
+    portfolio.setFxRate("EUR", 1.10);
+    expect(near(portfolio.getEquity(), 50000.0 + 11000.0), "foreign cash counts at the rate");
+    portfolio.buy("SAP", 10, 100.0);
+    expect(portfolio.getCash("EUR") == 9000.0 && portfolio.getCash() == 50000.0, "the fill settles in euros");
+    expect(near(portfolio.getEquity(), 61000.0) && near(portfolio.getLongExposure(), 1100.0),
+        "the position is valued in dollars");
+
+    expect(portfolio.updateFxRate("EURUSD", 1.20), "an FX bar updates the rate");
+    expect(near(portfolio.getEquity(), 50000.0 + 12000.0) && near(portfolio.getLongExposure(), 1200.0),
+        "a rate change re-values cash and positions");
+    portfolio.updateNetWorth("SAP", 110.0);
+    expect(near(portfolio.getEquity(), 50000.0 + 9000.0 * 1.2 + 1100.0 * 1.2), "a mark converts at the cached rate");
+    expect(near(portfolio.getEquityCurve().back(), portfolio.getEquity()), "the equity curve is in dollars");
+
+    portfolio.exchange("USD", "EUR", 1200.0);
+    expect(portfolio.getCash() == 48800.0 && near(portfolio.getCash("EUR"), 10000.0), "exchange at the current rate");
+    portfolio.sell("SAP", 10, 110.0);
+    expect(near(portfolio.getCash("EUR"), 11100.0) && near(portfolio.getLongExposure(), 0.0), "the sale settles in euros");
+    expect(throws<std::runtime_error>([&]() { portfolio.exchange("EUR", "USD", 20000.0); }), "no exchange beyond the balance");
+    expect(throws<std::logic_error>([&]() { portfolio.setBaseCurrency("EUR"); }), "the base is fixed once used");
+
+    Portfolio exact;
+    exact.setLog(nullptr);
+    exact.setFixedPoint(true);
+    expect(throws<std::logic_error>([&]() { exact.setInstrumentCurrency("SAP", "EUR"); }),
+        "fixed-point accounts stay in the base currency");
+}
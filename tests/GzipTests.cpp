@@ -0,0 +1,50 @@
+#include "TestSupport.h"
+#include "Gzip.h"
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Tests;
+
+// compress() output decodes to the input, alone and as concatenated members
+BT_TEST(gzip) {
+    std::mt19937 random(11);
+    std::vector<std::string> inputs{ "", "a", std::string(100000, 'x') };
+    std::string text;
+    for (int i = 0; i < 20000; ++i) text += "2024-01-02 09:3" + std::to_string(i % 10) + "," + std::to_string(random() % 50000) + "\n";
+    inputs.push_back(text);
+    std::string noise(300000, '\0');
+    for (char& c : noise) c = static_cast<char>(random());
+    inputs.push_back(noise);
+
+    auto decode = [](const std::string& compressed) {
+        std::istringstream in(compressed);
+        Gzip::Reader reader(in);
+        std::string out;
+        char buffer[4096];
+        while (size_t n = reader.read(buffer, sizeof(buffer))) out.append(buffer, n);
+        return out;
+    };
+
+    std::string members, joined;
+    for (const std::string& input : inputs) {
+        const std::string compressed = Gzip::compress(input.data(), input.size());
+        expect(decode(compressed) == input, "round trip of " + std::to_string(input.size()) + " bytes");
+        members += compressed;
+        joined += input;
+    }
+    expect(decode(members) == joined, "round trip of concatenated members");
+
+    std::string corrupt = Gzip::compress(text.data(), text.size());
+    corrupt[corrupt.size() / 2] ^= 0x20;
+    bool threw = false;
+    try {
+        decode(corrupt);
+    }
+    catch (const std::runtime_error&) {
+        threw = true;
+    }
+    expect(threw, "corrupt input is rejected");
+}
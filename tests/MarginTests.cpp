@@ -0,0 +1,107 @@
+#include "TestSupport.h"
+#include <cmath>
+#include <map>
+#include <random>
+#include <stdexcept>
+
+using namespace Tests;
+
+namespace {
+
+Portfolio marginAccount(bool allowShort) {
+    Portfolio portfolio;
+    portfolio.setLog(nullptr);
+    portfolio.setCash(10000.0);
+    portfolio.setMarginAccount(MarginSettings{ allowShort, 0.5, 0.25, 2.0 });
+    return portfolio;
+}
+
+} // namespace
+
+// Shorts, borrowing, margin and leverage limits and margin calls, on hand-worked numbers
+BT_TEST(margin) {
+    Portfolio portfolio = marginAccount(true);
+    portfolio.sell("AAPL", 100, 100.0);
+    expect(portfolio.getPosition("AAPL") == -100 && portfolio.getCash() == 20000.0, "a sell opens a short");
+    expect(portfolio.getShortExposure() == 10000.0 && portfolio.getEquity() == 10000.0, "the short is a liability");
+    expect(portfolio.getLeverage() == 1.0 && portfolio.getMarginUsed() == 5000.0, "leverage and margin used");
+
+    portfolio.buy("MSFT", 100, 100.0);
+    expect(portfolio.getGrossExposure() == 20000.0 && portfolio.getNetExposure() == 0.0, "gross and net exposure");
+    expect(!portfolio.canTrade("MSFT", 1, 100.0), "the margin is used up");
+    expect(throws<std::runtime_error>([&]() { portfolio.buy("MSFT", 1, 100.0); }), "orders beyond the margin fail");
+    expect(portfolio.getPosition("MSFT") == 100 && portfolio.getCash() == 10000.0, "a failed order changes nothing");
+
+    portfolio.sell("MSFT", 50, 100.0);
+    portfolio.updateNetWorth("AAPL", 130.0);
+    expect(portfolio.getEquity() == 7000.0 && !portfolio.isMarginCall(), "a rising short loses equity");
+    portfolio.updateNetWorth("AAPL", 180.0);
+    expect(portfolio.getEquity() == 2000.0 && portfolio.getGrossExposure() == 23000.0, "marks move the totals");
+    expect(portfolio.isMarginCall() && portfolio.getLeverage() == 11.5, "equity below maintenance is a margin call");
+    expect(!portfolio.canTrade("MSFT", 1, 100.0), "nothing adds exposure during a call");
+
+    portfolio.buy("AAPL", 100, 180.0);
+    expect(portfolio.getPosition("AAPL") == 0 && portfolio.getCash() == -3000.0, "covering borrows cash");
+    expect(portfolio.getEquity() == 2000.0 && !portfolio.isMarginCall(), "closing exposure works off the call");
+
+    portfolio.sell("MSFT", 60, 110.0);
+    expect(portfolio.getPosition("MSFT") == -10 && portfolio.getAvgCostBasis("MSFT") == 110.0,
+        "selling through flat opens a short at the fill price");
+
+    // Account types and settings
+    Portfolio longOnly = marginAccount(false);
+    longOnly.buy("SPY", 10, 100.0);
+    expect(throws<std::runtime_error>([&]() { longOnly.sell("SPY", 11, 100.0); }), "shorts need allowShort");
+    expect(throws<std::logic_error>([&]() { longOnly.setMarginAccount(MarginSettings()); }),
+        "the account type is fixed once positions are open");
+    Portfolio cashAccount;
+    cashAccount.setLog(nullptr);
+    cashAccount.setCash(1000.0);
+    expect(throws<std::runtime_error>([&]() { cashAccount.buy("SPY", 11, 100.0); }), "cash accounts cannot borrow");
+    expect(throws<std::runtime_error>([&]() { cashAccount.sell("SPY", 1, 100.0); }), "cash accounts cannot short");
+    expect(throws<std::invalid_argument>([&]() { cashAccount.setMarginAccount(MarginSettings{ true, 0.3, 0.4, 2.0 }); }),
+        "maintenance above initial margin is refused");
+}
+
+// The running exposure totals equal a full re-sum after many fills and marks
+BT_TEST(marginTotals) {
+    Portfolio portfolio;
+    portfolio.setLog(nullptr);
+    portfolio.setCash(1e9);
+    portfolio.setMarginAccount(MarginSettings{ true, 0.1, 0.05, 10.0 });
+
+    std::mt19937_64 random(7);
+    std::map<std::string, std::pair<int, double>> book; // Symbol -> quantity, mark
+    double cash = 1e9;
+    for (int i = 0; i < 20000; ++i) {
+        const std::string symbol = "S" + std::to_string(random() % 300);
+        const double price = 10.0 + (random() % 10000) / 100.0;
+        const int quantity = 1 + static_cast<int>(random() % 50);
+        auto& [held, mark] = book[symbol];
+        if (random() % 3 == 0) {
+            portfolio.updateNetWorth(symbol, price);
+            if (held != 0) mark = price;
+            continue;
+        }
+        const bool buying = random() % 2 == 0;
+        if (buying) portfolio.buy(symbol, quantity, price);
+        else portfolio.sell(symbol, quantity, price);
+        held += buying ? quantity : -quantity;
+        mark = price;
+        cash += buying ? -quantity * price : quantity * price;
+    }
+
+    double longValue = 0.0, shortValue = 0.0;
+    bool positionsMatch = true;
+    for (const auto& [symbol, entry] : book) {
+        positionsMatch = positionsMatch && portfolio.getPosition(symbol) == entry.first;
+        if (entry.first > 0) longValue += entry.first * entry.second;
+        else shortValue -= entry.first * entry.second;
+    }
+    auto near = [](double a, double b) { return std::fabs(a - b) <= 1e-9 * std::max(1.0, std::fabs(b)); };
+    expect(positionsMatch, "positions follow the fills");
+    expect(near(portfolio.getLongExposure(), longValue) && near(portfolio.getShortExposure(), shortValue),
+        "incremental exposure equals the re-summed exposure");
+    expect(near(portfolio.getCash(), cash) && near(portfolio.getEquity(), cash + longValue - shortValue),
+        "cash and equity follow the fills and marks");
+}
@@ -0,0 +1,35 @@
+#include "TestSupport.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Tests;
+
+// A pipelined run logs the same bytes and records the same results as a sequential one
+BT_TEST(pipeline) {
+    const std::vector<BarView> segments{ BarView(testBars()) };
+    auto run = [&](bool pipelined, Portfolio& portfolio) {
+        std::ostringstream log;
+        portfolio.setLog(&log);
+        portfolio.setCash(100000.0);
+        MovingAverageStrategy strategy(5, 20, portfolio);
+        strategy.setLog(&log);
+        BacktestingEngine engine;
+        engine.setLog(&log);
+        if (pipelined) {
+            engine.setPipelining(100, 4);
+            engine.runPipelined(segments, strategy, portfolio);
+        }
+        else {
+            engine.runBacktest(segments, strategy, portfolio);
+        }
+        return log.str();
+    };
+
+    Portfolio sequential, pipelined;
+    const std::string expected = run(false, sequential);
+    const std::string actual = run(true, pipelined);
+    expect(expected.size() > 1000000, "the run logs");
+    expect(expected == actual, "pipelined log is byte-identical");
+    expect(sameRun(sequential, pipelined), "pipelined results match");
+}
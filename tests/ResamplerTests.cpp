@@ -0,0 +1,87 @@
+#include "TestSupport.h"
+#include "Resampler.h"
+#include <algorithm>
+#include <memory>
+
+using namespace Tests;
+
+namespace {
+
+// Serves bars in fixed-size chunks
+class ChunkedSource : public BarSource {
+public:
+    ChunkedSource(const BarColumns& bars, size_t chunkBars) : bars(bars), chunkBars(chunkBars) {}
+
+    bool nextChunk(BarColumns& chunk) override {
+        chunk.clear();
+        for (; chunk.size() < chunkBars && position < bars.size(); ++position) {
+            chunk.push_back(bars.timestamps[position], bars.at(position));
+        }
+        return !chunk.empty();
+    }
+
+private:
+    const BarColumns& bars;
+    size_t chunkBars;
+    size_t position = 0;
+};
+
+// Bucket by bucket, one bar at a time
+BarColumns reference(const BarColumns& bars, int64_t interval) {
+    BarColumns out;
+    for (size_t i = 0; i < bars.size(); ++i) {
+        const int64_t start = Resampler::bucketStart(bars.timestamps[i], interval);
+        TimeSeriesData bar = bars.at(i);
+        if (!out.empty() && out.timestamps.back() == start) {
+            out.high.back() = std::max(out.high.back(), bar.high);
+            out.low.back() = std::min(out.low.back(), bar.low);
+            out.close.back() = bar.close;
+            out.volume.back() += bar.volume;
+        }
+        else {
+            out.push_back(start, bar);
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+// Batch, bar-at-a-time and chunk-streamed resampling all give the reference buckets
+BT_TEST(resample) {
+    const BarColumns& bars = testBars();
+    expect(Resampler::parseInterval("5m") == 300 && Resampler::parseInterval("1h") == 3600
+        && Resampler::parseInterval("1d") == 86400 && Resampler::parseInterval("30s") == 30, "intervals parse");
+    expect(throws<std::invalid_argument>([]() { Resampler::parseInterval("5 parsecs"); }), "bad intervals are refused");
+
+    for (int64_t interval : { 300, 3600, 86400 }) {
+        const BarColumns expected = reference(bars, interval);
+        const std::string name = std::to_string(interval) + "s";
+        expect(sameBars(Resampler::resample(BarView(bars), interval), expected), name + " batch buckets");
+
+        // Fed one bar at a time, each bucket closes on its last one-minute bar
+        BarColumns incremental;
+        BarAggregator aggregator(interval, 60);
+        bool onTime = true;
+        for (size_t i = 0; i < bars.size(); ++i) {
+            aggregator.update(bars.timestamps[i], bars.at(i), [&](int64_t start, const TimeSeriesData& bar) {
+                incremental.push_back(start, bar);
+                onTime = onTime && (bars.timestamps[i] + 60 == start + interval || i + 1 == bars.size()
+                    || Resampler::bucketStart(bars.timestamps[i + 1], interval) != start);
+            });
+        }
+        aggregator.flush([&](int64_t start, const TimeSeriesData& bar) { incremental.push_back(start, bar); });
+        expect(sameBars(incremental, expected), name + " incremental buckets");
+        expect(onTime, name + " buckets are emitted no later than the next bucket's first bar");
+
+        // Chunk sizes that split buckets across chunk boundaries
+        for (size_t chunkBars : { size_t(1), size_t(97), size_t(5000) }) {
+            ResampledSource source(std::make_unique<ChunkedSource>(bars, chunkBars), interval);
+            BarColumns streamed, chunk;
+            while (source.nextChunk(chunk)) {
+                for (size_t i = 0; i < chunk.size(); ++i) streamed.push_back(chunk.timestamps[i], chunk.at(i));
+            }
+            expect(sameBars(streamed, expected), name + " streamed in " + std::to_string(chunkBars) + "-bar chunks");
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#include "TestSupport.h"
+#include "BatchRunner.h"
+#include "ResultCache.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Tests;
+
+namespace {
+
+std::string keyOf(const ParameterSet& parameters, const Portfolio& portfolio) {
+    return ResultCache::makeKey(1, "SPY", "moving_average",
+                                BatchRunner::resolveParameters("moving_average", parameters), portfolio);
+}
+
+} // namespace
+
+// Stored runs come back whole; other keys, and damaged entries, are misses
+BT_TEST(cache) {
+    const ResultCache cache(scratchFile("cache"), true);
+    Portfolio portfolio;
+    portfolio.setCash(100000.0);
+    const std::string key = keyOf({ { "shortWindow", 5 }, { "longWindow", 20 } }, portfolio);
+
+    RunResult stored;
+    stored.metrics.totalReturn = 0.125;
+    stored.metrics.trades.trades = 42;
+    stored.finalEquity = 112500.0;
+    stored.fills = 84;
+    const std::vector<double> curve{ 100000.0, 101000.0, 112500.0 };
+    cache.store(key, stored, SeriesView(curve.data(), curve.size()));
+
+    RunResult loaded;
+    std::vector<double> loadedCurve;
+    expect(cache.lookup(key, loaded, &loadedCurve), "a stored run is found");
+    expect(loaded.metrics.totalReturn == 0.125 && loaded.metrics.trades.trades == 42
+           && loaded.finalEquity == 112500.0 && loaded.fills == 84, "its outcome round-trips");
+    expect(loadedCurve == curve, "its equity curve round-trips");
+    expect(!cache.lookup(keyOf({ { "shortWindow", 5 }, { "longWindow", 30 } }, portfolio), loaded), "other keys miss");
+
+    // Damage the entry: a failed checksum is a miss, not an error
+    for (const auto& entry : std::filesystem::directory_iterator(scratchFile("cache"))) {
+        std::fstream file(entry.path(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(40);
+        file.put('\x7f');
+    }
+    expect(!cache.lookup(key, loaded), "a damaged entry misses");
+}
+
+// The key holds everything that changes a run, defaults included, and
+// nothing that does not
+BT_TEST(cacheKey) {
+    Portfolio base;
+    base.setCash(100000.0);
+    const ParameterSet parameters{ { "shortWindow", 5 }, { "longWindow", 20 } };
+    const std::string key = keyOf(parameters, base);
+
+    expect(key.find("engine " + std::to_string(BacktestingEngine::ResultVersion)) != std::string::npos,
+           "the engine's result version is keyed");
+    expect(keyOf({ { "longWindow", 20 }, { "shortWindow", 5 }, { "quantity", 10 } }, base) == key,
+           "an explicit default and the parameter order do not change the key");
+    expect(keyOf({ { "shortWindow", 5 }, { "longWindow", 20 }, { "quantity", 20 } }, base) != key,
+           "the quantity is keyed");
+
+    auto differs = [&](const std::string& what, auto setUp) {
+        Portfolio portfolio;
+        portfolio.setCash(100000.0);
+        setUp(portfolio);
+        expect(keyOf(parameters, portfolio) != key, what + " is keyed");
+    };
+    differs("cash", [](Portfolio& portfolio) { portfolio.setCash(50000.0); });
+    differs("the cost model", [](Portfolio& portfolio) { portfolio.setCostModel(CostModel{ 0.005, 0.0, 0.0 }); });
+    differs("equity sampling", [](Portfolio& portfolio) { portfolio.setEquitySampling(EquitySampling::EveryNth, 10); });
+    differs("margin", [](Portfolio& portfolio) { portfolio.setMarginAccount(MarginSettings()); });
+    differs("fixed point", [](Portfolio& portfolio) { portfolio.setFixedPoint(true); });
+
+    RiskEngine risk(testLimits());
+    differs("risk limits", [&risk](Portfolio& portfolio) { portfolio.setRiskEngine(&risk); });
+    Portfolio limited;
+    limited.setCash(100000.0);
+    limited.setRiskEngine(&risk);
+    const std::string riskKey = keyOf(parameters, limited);
+    risk.setPositionLimit("SPY", 50);
+    expect(keyOf(parameters, limited) != riskKey, "the symbol's own position limit is keyed");
+}
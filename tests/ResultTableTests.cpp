@@ -0,0 +1,123 @@
+#include "TestSupport.h"
+#include "ResultTable.h"
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Tests;
+
+namespace {
+
+ResultSchema testSchema() {
+    return ResultSchema({ "longWindow", "shortWindow" }, { "spy", "qqq" }, { "ma" }, { "free", "retail" });
+}
+
+// Result `id`, with only some rows having a shortWindow
+RunResult testResult(uint64_t id) {
+    RunResult result;
+    result.dataset = id % 2 ? "qqq" : "spy";
+    result.strategy = "ma";
+    result.costModel = id % 3 ? "retail" : "free";
+    result.parameters = { { "longWindow", double(id % 100) } };
+    if (id % 5) result.parameters.emplace_back("shortWindow", double(id % 7));
+    result.metrics.totalReturn = id * 0.001;
+    result.metrics.trades.trades = id;
+    result.finalEquity = 100000.0 + id;
+    result.fills = id;
+    if (id % 11 == 0) result.error = "failed";
+    return result;
+}
+
+} // namespace
+
+// Rows appended from several threads read back exactly once each
+BT_TEST(resultTable) {
+    const std::string path = scratchFile("results.btr");
+    constexpr uint64_t Threads = 4, Rows = 2500;
+    {
+        ResultTableWriter writer(path, testSchema(), 64);
+        std::vector<std::thread> threads;
+        for (uint64_t t = 0; t < Threads; ++t) {
+            threads.emplace_back([&writer, t] {
+                for (uint64_t i = 0; i < Rows; ++i) writer.append(testResult(t * Rows + i));
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        writer.close();
+    }
+
+    const ResultTableReader reader(path);
+    expect(reader.rowCount() == Threads * Rows, "every row is read back");
+    const size_t fills = reader.column("fills"), shortWindow = reader.column("param_shortWindow");
+    const size_t dataset = reader.column("dataset"), ok = reader.column("ok");
+    const size_t finalEquity = reader.column("finalEquity");
+    std::map<uint64_t, size_t> rowOf;
+    size_t failed = 0;
+    bool empty = true;
+    for (size_t row = 0; row < reader.rowCount(); ++row) {
+        // Failed runs have no values to tell them apart by
+        if (reader.raw(row, ok) == 0) {
+            ++failed;
+            empty = empty && std::isnan(reader.value(row, finalEquity)) && reader.raw(row, fills) == 0;
+        }
+        else {
+            rowOf[reader.raw(row, fills)] = row;
+        }
+    }
+    const size_t expectedFailures = (Threads * Rows + 10) / 11;
+    expect(rowOf.size() + failed == Threads * Rows && failed == expectedFailures, "each row once");
+    expect(empty, "failed runs have no values");
+
+    bool same = true;
+    for (const auto& [id, row] : rowOf) {
+        const RunResult expected = testResult(id);
+        same = same && reader.value(row, finalEquity) == expected.finalEquity
+            && reader.value(row, reader.column("totalReturn")) == expected.metrics.totalReturn
+            && reader.value(row, reader.column("param_longWindow")) == double(id % 100)
+            && (id % 5 ? reader.value(row, shortWindow) == double(id % 7) : std::isnan(reader.value(row, shortWindow)))
+            && reader.getSchema().name(dataset, static_cast<int64_t>(reader.raw(row, dataset))) == expected.dataset;
+    }
+    expect(same, "every value round-trips");
+
+    std::ostringstream csv;
+    reader.writeCSV(csv);
+    std::istringstream lines(csv.str());
+    std::string header, line;
+    std::getline(lines, header);
+    size_t count = 0;
+    while (std::getline(lines, line)) ++count;
+    expect(header.rfind("dataset,strategy,costModel,ok,param_longWindow,param_shortWindow,", 0) == 0, "CSV header");
+    expect(count == Threads * Rows, "one CSV line per row");
+
+    // A truncated file is rejected
+    const std::string data = readFile(path);
+    const std::string truncatedPath = scratchFile("truncated.btr");
+    std::ofstream(truncatedPath, std::ios::binary) << data.substr(0, data.size() - 100);
+    expect(throws<std::runtime_error>([&] { ResultTableReader truncated(truncatedPath); }), "a truncated file is rejected");
+}
+
+// Writers created one after another on the same thread each keep their own rows
+BT_TEST(resultTableWriters) {
+    for (uint64_t w = 0; w < 200; ++w) {
+        const std::string path = scratchFile("writer.btr");
+        {
+            ResultTableWriter writer(path, testSchema(), 4);
+            for (uint64_t i = 0; i < 10; ++i) writer.append(testResult(w * 10 + i));
+            writer.close();
+        }
+        const ResultTableReader reader(path);
+        bool own = reader.rowCount() == 10;
+        for (size_t row = 0; own && row < reader.rowCount(); ++row) {
+            own = reader.value(row, reader.column("finalEquity")) - 100000.0 == double(w * 10 + row % 10)
+                || reader.raw(row, reader.column("ok")) == 0;
+        }
+        if (!own) {
+            expect(false, "writer " + std::to_string(w) + " holds only its own rows");
+            break;
+        }
+    }
+}
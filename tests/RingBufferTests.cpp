@@ -0,0 +1,62 @@
+#include "TestSupport.h"
+#include "RingBuffer.h"
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace Tests;
+
+// Every value pushed is popped once, and in order from each producer
+BT_TEST(rings) {
+    constexpr uint64_t Count = 200000;
+    {
+        SpscRing<uint64_t> ring(8);
+        std::thread producer([&] {
+            Backoff backoff;
+            for (uint64_t i = 0; i < Count; ++i) {
+                while (!ring.tryPush(i)) backoff.pause();
+                backoff.reset();
+            }
+        });
+        bool ordered = true;
+        Backoff backoff;
+        for (uint64_t expected = 0; expected < Count; ++expected) {
+            uint64_t value;
+            while (!ring.tryPop(value)) backoff.pause();
+            backoff.reset();
+            ordered = ordered && value == expected;
+        }
+        producer.join();
+        uint64_t extra;
+        expect(ordered, "SPSC values arrive in order");
+        expect(!ring.tryPop(extra), "SPSC ring is empty afterwards");
+    }
+    {
+        constexpr uint64_t Producers = 4;
+        MpscRing<uint64_t> ring(16);
+        std::vector<std::thread> producers;
+        for (uint64_t p = 0; p < Producers; ++p) {
+            producers.emplace_back([&ring, p] {
+                Backoff backoff;
+                for (uint64_t i = 0; i < Count; ++i) {
+                    while (!ring.tryPush(p * Count + i)) backoff.pause();
+                    backoff.reset();
+                }
+            });
+        }
+        std::vector<uint64_t> next(Producers, 0);
+        bool ordered = true;
+        Backoff backoff;
+        for (uint64_t received = 0; received < Producers * Count; ++received) {
+            uint64_t value;
+            while (!ring.tryPop(value)) backoff.pause();
+            backoff.reset();
+            const uint64_t producer = value / Count;
+            ordered = ordered && producer < Producers && value % Count == next[producer]++;
+        }
+        for (std::thread& producer : producers) producer.join();
+        uint64_t extra;
+        expect(ordered, "MPSC values arrive once, in order per producer");
+        expect(!ring.tryPop(extra), "MPSC ring is empty afterwards");
+    }
+}
@@ -0,0 +1,88 @@
+#include "TestSupport.h"
+#include <cstdlib>
+#include <string>
+
+using namespace Tests;
+
+namespace {
+
+OrderImpact order(int64_t time, int held, int after, double price) {
+    const double grossBefore = std::abs(held) * price, grossAfter = std::abs(after) * price;
+    return OrderImpact{ time, held, after, 100000.0, grossBefore, grossAfter, held * price, after * price };
+}
+
+} // namespace
+
+// Each limit rejects the orders that add to what it caps, and only those
+BT_TEST(risk) {
+    RiskLimits limits;
+    limits.maxPosition = 100;
+    limits.maxGrossExposure = 50000.0;
+    limits.maxNetExposure = 40000.0;
+    RiskEngine risk(limits);
+    risk.setPositionLimit("QQQ", 10);
+
+    expect(risk.check("SPY", order(0, 0, 100, 100.0)) == RiskCheck::Passed, "an order at the limits passes");
+    expect(risk.check("SPY", order(0, 0, 101, 100.0)) == RiskCheck::PositionLimit, "position limit");
+    expect(risk.check("SPY", order(0, 0, -101, 100.0)) == RiskCheck::PositionLimit, "position limit on a short");
+    expect(risk.check("QQQ", order(0, 0, 11, 100.0)) == RiskCheck::PositionLimit, "per-symbol position limit");
+    expect(risk.check("SPY", order(0, 150, 120, 100.0)) == RiskCheck::Passed, "orders working a breach down pass");
+    expect(risk.check("SPY", order(0, 0, 90, 600.0)) == RiskCheck::GrossExposure, "gross exposure cap");
+    expect(risk.check("SPY", order(0, 0, 90, 450.0)) == RiskCheck::NetExposure, "net exposure cap");
+
+    // The kill switch blocks orders that add exposure until it is re-armed
+    limits = RiskLimits();
+    limits.maxDrawdown = 0.1;
+    risk.setLimits(limits);
+    risk.onEquity(100000.0, false);
+    risk.onEquity(95000.0, false);
+    expect(!risk.isHalted(), "a drawdown within the limit does not halt");
+    risk.onEquity(89000.0, false);
+    expect(risk.isHalted(), "a drawdown beyond the limit halts");
+    expect(risk.check("SPY", order(0, 0, 1, 100.0)) == RiskCheck::KillSwitch, "halted engines block new exposure");
+    expect(risk.check("SPY", order(0, 10, 0, 100.0)) == RiskCheck::Passed, "halted engines let positions close");
+    risk.resetKillSwitch();
+    expect(risk.check("SPY", order(0, 0, 1, 100.0)) == RiskCheck::Passed, "reset re-arms the engine");
+
+    // A portfolio rejects the order before filling anything
+    RiskLimits positionOnly;
+    positionOnly.maxPosition = 5;
+    RiskEngine engine(positionOnly);
+    Portfolio portfolio;
+    portfolio.setLog(nullptr);
+    portfolio.setCash(100000.0);
+    portfolio.setRiskEngine(&engine);
+    portfolio.buy("SPY", 5, 100.0);
+    expect(throws<RiskViolation>([&] { portfolio.buy("SPY", 1, 100.0); }), "a portfolio throws RiskViolation");
+    expect(portfolio.getPosition("SPY") == 5 && portfolio.getTrades().size() == 1, "a rejected order does not fill");
+    expect(engine.getAccepted() == 1 && engine.getRejected(RiskCheck::PositionLimit) == 1, "orders are counted");
+}
+
+// The order rate counts the orders of the rolling window, and a shrunk
+// limit keeps the newest order times
+BT_TEST(orderRate) {
+    RiskLimits limits;
+    limits.maxOrders = 10;
+    limits.orderWindowSeconds = 100;
+    RiskEngine risk(limits);
+    for (int64_t t = 0; t < 100; t += 10) {
+        expect(risk.check("SPY", order(t, 0, 1, 100.0)) == RiskCheck::Passed, "orders below the rate pass");
+        risk.onOrder(t);
+    }
+    expect(risk.check("SPY", order(95, 0, 1, 100.0)) == RiskCheck::OrderRate, "the eleventh order in 100 s is rejected");
+    expect(risk.check("SPY", order(100, 0, 1, 100.0)) == RiskCheck::Passed, "the window rolls past the oldest order");
+
+    // Orders at t = 70, 80 and 90 are the last three: the window is still full at t = 105
+    limits.maxOrders = 3;
+    risk.setLimits(limits);
+    expect(risk.check("SPY", order(105, 0, 1, 100.0)) == RiskCheck::OrderRate, "a shrunk limit keeps the newest orders");
+    expect(risk.check("SPY", order(170, 0, 1, 100.0)) == RiskCheck::Passed, "and rolls past the oldest of them");
+
+    // Growing the limit keeps all three, oldest first
+    limits.maxOrders = 4;
+    risk.setLimits(limits);
+    expect(risk.check("SPY", order(105, 0, 1, 100.0)) == RiskCheck::Passed, "a grown limit has room");
+    risk.onOrder(105);
+    expect(risk.check("SPY", order(169, 0, 1, 100.0)) == RiskCheck::OrderRate, "the grown ring fills");
+    expect(risk.check("SPY", order(170, 0, 1, 100.0)) == RiskCheck::Passed, "the grown ring rolls from t = 70");
+}
@@ -0,0 +1,45 @@
+#include "TestSupport.h"
+#include "RunArena.h"
+
+using namespace Tests;
+
+namespace {
+
+void runOn(std::pmr::memory_resource* resource, Portfolio& reference, bool& same) {
+    Portfolio portfolio(resource);
+    portfolio.setLog(nullptr);
+    portfolio.setCash(100000.0);
+    MovingAverageStrategy strategy(5, 20, portfolio, resource);
+    strategy.setLog(nullptr);
+    BacktestingEngine engine;
+    engine.setLog(nullptr);
+    engine.runBacktest(BarView(testBars()), strategy, portfolio);
+    same = sameRun(portfolio, reference);
+}
+
+} // namespace
+
+// Runs backed by an arena equal heap-backed runs, and a reset arena grows once to fit the run
+BT_TEST(arena) {
+    Portfolio reference;
+    reference.setLog(nullptr);
+    reference.setCash(100000.0);
+    MovingAverageStrategy strategy(5, 20, reference);
+    strategy.setLog(nullptr);
+    BacktestingEngine engine;
+    engine.setLog(nullptr);
+    engine.runBacktest(BarView(testBars()), strategy, reference);
+
+    RunArena arena(4096);
+    bool same = false;
+    runOn(arena.resource(), reference, same);
+    expect(same, "the first arena run equals the heap run");
+    arena.reset();
+    const size_t grown = arena.capacity();
+    expect(grown > 4096, "an overflowing run grows the buffer on reset");
+
+    runOn(arena.resource(), reference, same);
+    expect(same, "a run after reset equals the heap run");
+    arena.reset();
+    expect(arena.capacity() == grown, "a run that fits leaves the buffer as it is");
+}
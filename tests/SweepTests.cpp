@@ -0,0 +1,57 @@
+#include "TestSupport.h"
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Tests;
+
+// Every variant of a prefix-sharing sweep matches its own separate run
+BT_TEST(sweep) {
+    const BarView all(testBars());
+    std::vector<std::pair<size_t, size_t>> windows;
+    for (size_t longWindow : { 20, 50, 200 }) {
+        for (size_t shortWindow : { 2, 5, 10 }) windows.emplace_back(shortWindow, longWindow);
+    }
+    windows.push_back(windows.front()); // Never diverges from its twin
+
+    std::vector<StrategyFactory> variants;
+    for (const auto& [shortWindow, longWindow] : windows) {
+        variants.push_back([shortWindow = shortWindow, longWindow = longWindow](Portfolio& portfolio) {
+            auto strategy = std::make_unique<MovingAverageStrategy>(shortWindow, longWindow, portfolio);
+            strategy->setLog(nullptr);
+            return std::unique_ptr<Strategy>(std::move(strategy));
+        });
+    }
+
+    // Forks continue the sampling of the node they were forked off
+    for (size_t interval : { 1, 7 }) {
+        auto setUp = [interval](Portfolio& portfolio) {
+            configure(portfolio, false);
+            if (interval > 1) portfolio.setEquitySampling(EquitySampling::EveryNth, interval);
+        };
+        RiskEngine prototypeRisk(testLimits());
+        Portfolio prototype;
+        setUp(prototype);
+        prototype.setRiskEngine(&prototypeRisk);
+        BacktestingEngine engine;
+        engine.setLog(nullptr);
+        const std::vector<SweepRun> runs = engine.runSweep(all, prototype, variants);
+        expect(runs.size() == variants.size(), "one result per variant");
+        expect(runs.back().sharedBars == all.size(), "identical variants share every bar");
+
+        for (size_t v = 0; v < variants.size() && v < runs.size(); ++v) {
+            RiskEngine risk(testLimits());
+            Portfolio portfolio;
+            setUp(portfolio);
+            portfolio.setRiskEngine(&risk);
+            std::unique_ptr<Strategy> strategy = variants[v](portfolio);
+            engine.runBacktest(all, *strategy, portfolio);
+
+            const std::string name = std::to_string(windows[v].first) + "/" + std::to_string(windows[v].second)
+                + (interval > 1 ? " sampled" : "");
+            expect(sameRun(portfolio, *runs[v].portfolio), "variant " + name + " matches its separate run");
+            expect(risk.getAccepted() == runs[v].risk->getAccepted(), "variant " + name + " risk counters match");
+        }
+    }
+}
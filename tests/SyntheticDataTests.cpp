@@ -0,0 +1,73 @@
+#include "TestSupport.h"
+#include "DataModule.h"
+#include "SyntheticData.h"
+#include <cmath>
+
+using namespace Tests;
+
+namespace {
+
+SyntheticDataConfig smallConfig(size_t threads) {
+    SyntheticDataConfig config;
+    config.model = PriceModel::RegimeSwitching;
+    config.symbols = 2;
+    config.barsPerSymbol = 20000;
+    config.blockBars = 4096;
+    config.threads = threads;
+    return config;
+}
+
+} // namespace
+
+// The same seed gives the same bars whatever the thread count; bars are well formed
+BT_TEST(synthetic) {
+    const SyntheticDataGenerator serial(smallConfig(1)), parallel(smallConfig(4));
+    const BarColumns first = serial.generate(0);
+    expect(first.size() == 20000, "every bar is generated");
+    expect(sameBars(first, parallel.generate(0)), "thread count does not change the bars");
+    expect(!sameSeries(first.close, serial.generate(1).close), "symbols draw their own streams");
+
+    SyntheticDataConfig reseeded = smallConfig(1);
+    reseeded.seed = 7;
+    expect(!sameSeries(first.close, SyntheticDataGenerator(reseeded).generate(0).close), "the seed changes the bars");
+
+    bool wellFormed = true;
+    for (size_t i = 0; i < first.size(); ++i) {
+        wellFormed = wellFormed && first.low[i] > 0.0 && first.low[i] <= std::min(first.open[i], first.close[i])
+            && first.high[i] >= std::max(first.open[i], first.close[i]) && first.volume[i] > 0
+            && (i == 0 || first.timestamps[i] > first.timestamps[i - 1]);
+    }
+    expect(wellFormed, "bars are ordered with low <= open, close <= high");
+}
+
+// Written CSV and binary files load back through DataModule
+BT_TEST(syntheticFiles) {
+    const SyntheticDataGenerator generator(smallConfig(2));
+    const BarColumns bars = generator.generate(1);
+
+    const std::vector<std::string> csv = generator.writeCSV(scratchFile("synthetic-csv"));
+    expect(csv.size() == 2, "one CSV per symbol");
+    DataModule fromCSV;
+    expect(fromCSV.loadTimeSeriesCSV(csv[1]) && fromCSV.size() == bars.size(), "the CSV loads every bar");
+    const BarView loaded = fromCSV.view();
+    bool closeToFourDecimals = true;
+    for (size_t i = 0; i < bars.size() && i < loaded.size(); ++i) {
+        closeToFourDecimals = closeToFourDecimals && loaded.timestamps[i] == bars.timestamps[i]
+            && std::fabs(loaded.at(i).close - bars.close[i]) <= 0.00005 && loaded.at(i).volume == bars.volume[i];
+    }
+    expect(closeToFourDecimals, "CSV prices are written to four decimals");
+
+    for (BarCompression compression : { BarCompression::None, BarCompression::Delta }) {
+        const std::vector<std::string> binary = generator.writeBinary(scratchFile("synthetic-bin"), compression);
+        DataModule fromBinary;
+        expect(fromBinary.loadTimeSeriesBinary(binary[1]), "the binary file loads");
+        const BarView view = fromBinary.view();
+        bool exact = view.size() == bars.size();
+        for (size_t i = 0; exact && i < bars.size(); ++i) {
+            const TimeSeriesData bar = view.at(i);
+            exact = view.timestamps[i] == bars.timestamps[i] && bar.open == bars.open[i] && bar.high == bars.high[i]
+                && bar.low == bars.low[i] && bar.close == bars.close[i] && bar.volume == bars.volume[i];
+        }
+        expect(exact, "binary files hold the bars exactly");
+    }
+}
@@ -0,0 +1,150 @@
+#include "TestSupport.h"
+#include "SyntheticData.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace Tests {
+
+namespace {
+
+struct TestCase {
+    const char* name;
+    TestFunction run;
+};
+
+// Function-local, so registrations from any file's static initializers find it
+std::vector<TestCase>& registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+int failures = 0;
+
+// Scratch directory, removed when the tests finish
+class TempDirectory {
+public:
+    TempDirectory() {
+        path = std::filesystem::temp_directory_path()
+            / ("backtester_tests_" + std::to_string(std::random_device()()));
+        std::filesystem::create_directories(path);
+    }
+    ~TempDirectory() {
+        std::error_code error;
+        std::filesystem::remove_all(path, error);
+    }
+
+    std::string file(const std::string& name) const { return (path / name).string(); }
+
+private:
+    std::filesystem::path path;
+};
+
+} // namespace
+
+Registration::Registration(const char* name, TestFunction run) {
+    registry().push_back(TestCase{ name, run });
+}
+
+void expect(bool condition, const std::string& what) {
+    if (!condition) {
+        ++failures;
+        std::cerr << "  FAILED: " << what << std::endl;
+    }
+}
+
+std::string scratchFile(const std::string& name) {
+    static TempDirectory directory;
+    return directory.file(name);
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+const BarColumns& testBars() {
+    static const BarColumns bars = [] {
+        SyntheticDataConfig config;
+        config.barsPerSymbol = 30000;
+        config.model = PriceModel::RegimeSwitching;
+        config.threads = 1;
+        return SyntheticDataGenerator(config).generate(0);
+    }();
+    return bars;
+}
+
+const std::string& testCSV() {
+    static const std::string path = [] {
+        SyntheticDataConfig config;
+        config.barsPerSymbol = 30000;
+        config.model = PriceModel::RegimeSwitching;
+        config.threads = 1;
+        return SyntheticDataGenerator(config).writeCSV(scratchFile("test-bars")).front();
+    }();
+    return path;
+}
+
+bool sameBars(const BarColumns& a, const BarColumns& b) {
+    return sameSeries(a.timestamps, b.timestamps) && sameSeries(a.open, b.open) && sameSeries(a.high, b.high)
+        && sameSeries(a.low, b.low) && sameSeries(a.close, b.close) && sameSeries(a.volume, b.volume);
+}
+
+bool sameTrades(const TradeLedger& a, const TradeLedger& b) {
+    return a.size() == b.size() && std::memcmp(a.begin(), b.begin(), a.size() * sizeof(TradeRecord)) == 0;
+}
+
+bool sameRun(const Portfolio& a, const Portfolio& b) {
+    return sameSeries(a.getEquityCurve(), b.getEquityCurve()) && sameSeries(a.getReturns(), b.getReturns())
+        && sameTrades(a.getTrades(), b.getTrades()) && a.getCash() == b.getCash();
+}
+
+void configure(Portfolio& portfolio, bool fixedPoint) {
+    portfolio.setLog(nullptr);
+    portfolio.setCash(100000.0);
+    if (fixedPoint) portfolio.setFixedPoint(true);
+    portfolio.setMarginAccount(MarginSettings{ true, 0.5, 0.25, 2.0 });
+    portfolio.setCostModel(CostModel{ 0.005, 1.0, 1.0 });
+}
+
+RiskLimits testLimits() {
+    RiskLimits limits;
+    limits.maxOrders = 3;
+    limits.orderWindowSeconds = 600;
+    limits.maxPosition = 200;
+    return limits;
+}
+
+} // namespace Tests
+
+int main(int argc, char* argv[]) {
+    using namespace Tests;
+    const std::vector<TestCase>& tests = registry();
+    std::vector<std::string> selected(argv + 1, argv + argc);
+    int failed = 0;
+    for (const std::string& name : selected) {
+        auto known = [&name](const TestCase& test) { return name == test.name; };
+        if (std::none_of(tests.begin(), tests.end(), known)) {
+            std::cerr << "Unknown test: " << name << std::endl;
+            ++failed;
+        }
+    }
+    for (const TestCase& test : tests) {
+        if (!selected.empty() && std::find(selected.begin(), selected.end(), test.name) == selected.end()) continue;
+        const int before = failures;
+        try {
+            test.run();
+        }
+        catch (const std::exception& e) {
+            expect(false, std::string("unexpected exception: ") + e.what());
+        }
+        const bool passed = failures == before;
+        if (!passed) ++failed;
+        std::cout << (passed ? "PASS " : "FAIL ") << test.name << std::endl;
+    }
+    return failed;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "BacktestingEngine.h"
+#include <algorithm>
+#include <string>
+
+// ---------------------  Test Support  -------------------------------------------
+//
+// Shared harness of the behaviour tests. Each tests/*Tests.cpp file defines
+// its tests with BT_TEST(name); backtester_tests runs every registered test,
+// or only those named on the command line, and exits with the number that
+// failed. CMakeLists.txt registers each name with CTest.
+
+namespace Tests {
+
+using TestFunction = void (*)();
+
+// Adds a test to the registry; BT_TEST declares one per test at namespace scope
+struct Registration {
+    Registration(const char* name, TestFunction run);
+};
+
+// Record a failed check of the current test
+void expect(bool condition, const std::string& what);
+
+// Throws an exception of type E
+template <typename E, typename F>
+bool throws(F&& f) {
+    try {
+        f();
+    }
+    catch (const E&) {
+        return true;
+    }
+    return false;
+}
+
+// Path of a file in a scratch directory removed when the tests finish
+std::string scratchFile(const std::string& name);
+
+std::string readFile(const std::string& path);
+
+// A few months of one-minute bars, the same on every run
+const BarColumns& testBars();
+
+// testBars() written as a DataModule CSV (prices to four decimals)
+const std::string& testCSV();
+
+template <typename A, typename B>
+bool sameSeries(const A& a, const B& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+// Same timestamps and OHLCV columns, bit for bit
+bool sameBars(const BarColumns& a, const BarColumns& b);
+
+bool sameTrades(const TradeLedger& a, const TradeLedger& b);
+
+// Same equity curve, returns, fills and cash, bit for bit
+bool sameRun(const Portfolio& a, const Portfolio& b);
+
+// A margin account with costs, so every settings struct reaches the snapshot
+void configure(Portfolio& portfolio, bool fixedPoint);
+
+RiskLimits testLimits();
+
+} // namespace Tests
+
+#define BT_TEST(name)                                                          \
+    static void name##Test();                                                  \
+    static const ::Tests::Registration name##Registration(#name, name##Test);  \
+    static void name##Test()
@@ -0,0 +1,31 @@
+#include "TestSupport.h"
+#include <cstring>
+#include <string>
+
+using namespace Tests;
+
+// A journal attached to a run holds exactly the run's fills, across growth
+BT_TEST(journal) {
+    const std::string path = scratchFile("fills.journal");
+    Portfolio portfolio;
+    configure(portfolio, false);
+    {
+        TradeJournalWriter journal(path, 16); // Grows many times over the run
+        portfolio.getTrades().attachJournal(&journal);
+        MovingAverageStrategy strategy(5, 20, portfolio);
+        strategy.setLog(nullptr);
+        BacktestingEngine engine;
+        engine.setLog(nullptr);
+        engine.runBacktest(BarView(testBars()), strategy, portfolio);
+        portfolio.getTrades().attachJournal(nullptr);
+        expect(journal.size() == portfolio.getTrades().size(), "journal counts every fill");
+    }
+
+    const TradeLedger& ledger = portfolio.getTrades();
+    TradeJournalReader reader(path);
+    expect(ledger.size() > 100, "the run trades");
+    expect(reader.size() == ledger.size()
+           && std::memcmp(reader.begin(), ledger.begin(), ledger.size() * sizeof(TradeRecord)) == 0,
+           "journal records match the ledger");
+    expect(reader.symbol(0) == "SPY", "journal names the symbol");
+}
@@ -0,0 +1,45 @@
+#include "TestSupport.h"
+#include "TradeMatcher.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Tests;
+
+// Excursions annotated in one pass match a scan of every trip's bars
+BT_TEST(excursions) {
+    const BarColumns& bars = testBars();
+    std::mt19937 random(7);
+    for (LotMatching matching : { LotMatching::FIFO, LotMatching::LIFO }) {
+        TradeLedger ledger;
+        for (size_t i = 0; i < bars.size(); i += 1 + random() % 5) {
+            const bool buying = random() % 2 == 0;
+            ledger.record(bars.timestamps[i], "SYN", buying ? TradeSide::Buy : TradeSide::Sell,
+                          1 + static_cast<int>(random() % 10), bars.close[i], 0.0);
+        }
+        std::vector<RoundTrip> trips = RoundTripMatcher::match(ledger, matching);
+        RoundTripMatcher::annotateExcursions(trips, { BarView(bars) });
+        expect(trips.size() > 1000, "the ledger closes trips");
+
+        double worst = 0.0;
+        for (const RoundTrip& trip : trips) {
+            const auto first = std::lower_bound(bars.timestamps.begin(), bars.timestamps.end(), trip.entryTime);
+            const auto last = std::upper_bound(bars.timestamps.begin(), bars.timestamps.end(), trip.exitTime);
+            double high = -INFINITY, low = INFINITY;
+            for (auto it = first; it != last; ++it) {
+                const size_t i = static_cast<size_t>(it - bars.timestamps.begin());
+                high = std::max(high, bars.high[i]);
+                low = std::min(low, bars.low[i]);
+            }
+            const double up = (high - trip.entryPrice) * trip.quantity;
+            const double down = (trip.entryPrice - low) * trip.quantity;
+            const double mfe = std::max(0.0, trip.direction > 0 ? up : down);
+            const double mae = std::max(0.0, trip.direction > 0 ? down : up);
+            worst = std::max({ worst, std::fabs(mfe - trip.mfe), std::fabs(mae - trip.mae) });
+        }
+        expect(worst < 1e-6, std::string(matching == LotMatching::FIFO ? "FIFO" : "LIFO")
+               + " excursions match the brute-force scan");
+    }
+}